@@ -0,0 +1,217 @@
+"""Benchmark harness for the static analysis pipeline.
+
+Each corpus is analyzed in a fresh process so peak RSS is per corpus.
+The analyzer runs sequentially with the result cache and AI disabled;
+parse time, per-rule time and nodes visited come from the report's
+built-in profile.
+"""
+
+import json
+import os
+import platform
+import resource
+import sys
+import tempfile
+import time
+from concurrent.futures import ProcessPoolExecutor
+from multiprocessing import get_context
+from typing import Any, Dict, List, Optional
+
+REPO_ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+# Checked-in corpora, relative to the repository root
+CORPORA = {
+    "test_files": "test_files",
+    "test_project": "test_project",
+    "samples": "samples",
+    "synthetic": None
+}
+
+DEFAULT_BASELINE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "baseline.json")
+
+# Metrics compared against the baseline: higher is worse for all of them
+TIMING_METRICS = ("total_seconds", "parse_seconds", "rule_seconds_total", "peak_rss_mb")
+
+# Differences below these are treated as noise regardless of the ratio
+MIN_ABSOLUTE_DELTA = {"peak_rss_mb": 5.0}
+MIN_SECONDS_DELTA = 0.05
+
+
+def run_corpus(name: str, path: str) -> Dict[str, Any]:
+    """Analyze one corpus and collect its metrics.
+
+    Args:
+        name: Corpus name for the results
+        path: Directory to analyze
+
+    Returns:
+        Dictionary of metrics
+    """
+    from static_analyzer import StaticAnalyzer, AnalyzerConfig
+
+    config = AnalyzerConfig({"analysis": {"parallelism": 1, "cache_dir": None},
+                             "ai_assistant": {"enabled": False}})
+    analyzer = StaticAnalyzer(config)
+
+    start = time.perf_counter()
+    report = analyzer.analyze_directory(path, recursive=True)
+    total_seconds = time.perf_counter() - start
+
+    profile = report.metadata["profile"]
+    violations = report.summary.get("total_violations", len(report.violations))
+    rule_seconds = {rule_id: entry["seconds"]
+                    for rule_id, entry in sorted(profile["rules"].items())}
+    return {
+        "corpus": name,
+        "files": report.metadata.get("files_analyzed", 0),
+        "total_seconds": round(total_seconds, 4),
+        "parse_seconds": profile["phases"].get("parse", 0.0),
+        "rule_seconds": rule_seconds,
+        "rule_seconds_total": profile["phases"].get("rules", 0.0),
+        "nodes_visited": profile["nodes_visited"],
+        "violations": violations,
+        "violations_per_second": round(violations / total_seconds, 2) if total_seconds else 0.0,
+        "peak_rss_mb": round(_peak_rss_mb(), 2)
+    }
+
+
+def run_benchmarks(corpora: Optional[List[str]] = None,
+                   synthetic_files: int = 8,
+                   repeat: int = 1) -> Dict[str, Any]:
+    """Run the benchmark corpora, each in its own process.
+
+    Args:
+        corpora: Corpus names (default: all)
+        synthetic_files: Number of generated files in the synthetic corpus
+        repeat: Runs per corpus; the fastest run is kept
+
+    Returns:
+        Results keyed by corpus name, plus environment information
+    """
+    from .synthetic import write_corpus
+
+    results: Dict[str, Any] = {}
+    with tempfile.TemporaryDirectory(prefix="bench-") as scratch:
+        for name in corpora or list(CORPORA):
+            if name not in CORPORA:
+                raise ValueError(f"Unknown corpus: {name}")
+            if CORPORA[name] is None:
+                path = os.path.join(scratch, name)
+                write_corpus(path, file_count=synthetic_files)
+            else:
+                path = os.path.join(REPO_ROOT, CORPORA[name])
+
+            runs = []
+            for _ in range(max(repeat, 1)):
+                # A fresh interpreter per run keeps peak RSS and warm caches per corpus
+                with ProcessPoolExecutor(max_workers=1, mp_context=get_context("spawn")) as pool:
+                    runs.append(pool.submit(run_corpus, name, path).result())
+            results[name] = min(runs, key=lambda run: run["total_seconds"])
+
+    return {
+        "environment": {
+            "python": platform.python_version(),
+            "platform": platform.platform(),
+            "cpu_count": os.cpu_count()
+        },
+        "results": results
+    }
+
+
+def compare_results(current: Dict[str, Any], baseline: Dict[str, Any],
+                    tolerance: float = 0.2) -> List[Dict[str, Any]]:
+    """Compare benchmark results against a baseline.
+
+    Timing and memory metrics regress when they exceed the baseline by
+    more than ``tolerance`` and by more than a noise floor. Changed
+    violation and node counts are reported too, since they mean the
+    analysis itself changed.
+
+    Args:
+        current: Output of ``run_benchmarks``
+        baseline: Previously saved output of ``run_benchmarks``
+        tolerance: Allowed relative slowdown (0.2 = 20%)
+
+    Returns:
+        List of findings with corpus, metric, baseline, current and kind
+        ("regression", "improvement" or "changed")
+    """
+    findings = []
+    for name, result in current.get("results", {}).items():
+        base = baseline.get("results", {}).get(name)
+        if not base:
+            continue
+
+        metrics = [(metric, result.get(metric), base.get(metric)) for metric in TIMING_METRICS]
+        for rule_id, seconds in result.get("rule_seconds", {}).items():
+            metrics.append((f"rule_seconds.{rule_id}", seconds,
+                            base.get("rule_seconds", {}).get(rule_id)))
+
+        for metric, value, base_value in metrics:
+            if value is None or base_value is None:
+                continue
+            floor = MIN_ABSOLUTE_DELTA.get(metric, MIN_SECONDS_DELTA)
+            delta = value - base_value
+            if abs(delta) < floor or abs(delta) <= base_value * tolerance:
+                continue
+            findings.append({
+                "corpus": name,
+                "metric": metric,
+                "baseline": base_value,
+                "current": value,
+                "kind": "regression" if delta > 0 else "improvement"
+            })
+
+        for metric in ("violations", "nodes_visited", "files"):
+            if metric in base and result.get(metric) != base[metric]:
+                findings.append({
+                    "corpus": name,
+                    "metric": metric,
+                    "baseline": base[metric],
+                    "current": result.get(metric),
+                    "kind": "changed"
+                })
+    return findings
+
+
+def format_results(current: Dict[str, Any], findings: List[Dict[str, Any]]) -> str:
+    """Format results and baseline findings as a text table."""
+    header = (f"{'corpus':<14}{'files':>6}{'total s':>10}{'parse s':>10}{'rules s':>10}"
+              f"{'nodes':>10}{'viol':>7}{'viol/s':>10}{'RSS MB':>9}")
+    lines = [header, "-" * len(header)]
+    for name, r in current.get("results", {}).items():
+        lines.append(f"{name:<14}{r['files']:>6}{r['total_seconds']:>10.3f}"
+                     f"{r['parse_seconds']:>10.3f}{r['rule_seconds_total']:>10.3f}"
+                     f"{r['nodes_visited']:>10}{r['violations']:>7}"
+                     f"{r['violations_per_second']:>10.1f}{r['peak_rss_mb']:>9.1f}")
+        for rule_id, seconds in r["rule_seconds"].items():
+            lines.append(f"    {rule_id:<28}{seconds:>10.3f}s")
+
+    if findings:
+        lines.append("")
+        lines.append("Compared to baseline:")
+        for f in findings:
+            lines.append(f"  [{f['kind']}] {f['corpus']} {f['metric']}: "
+                         f"{f['baseline']} -> {f['current']}")
+    return "\n".join(lines)
+
+
+def load_baseline(path: str) -> Optional[Dict[str, Any]]:
+    """Load a saved baseline, or None if there isn't one."""
+    if not os.path.exists(path):
+        return None
+    with open(path, "r", encoding="utf-8") as f:
+        return json.load(f)
+
+
+def save_results(results: Dict[str, Any], path: str) -> None:
+    """Write benchmark results as JSON."""
+    with open(path, "w", encoding="utf-8") as f:
+        json.dump(results, f, indent=2, sort_keys=True)
+        f.write("\n")
+
+
+def _peak_rss_mb() -> float:
+    peak = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+    # ru_maxrss is in bytes on macOS and kilobytes elsewhere
+    return peak / (1024 * 1024) if sys.platform == "darwin" else peak / 1024
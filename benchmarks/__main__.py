@@ -0,0 +1,52 @@
+"""Command line entry point: python -m benchmarks"""
+
+import sys
+
+import click
+
+from . import (CORPORA, DEFAULT_BASELINE, run_benchmarks, compare_results,
+               format_results, load_baseline, save_results)
+
+
+@click.command()
+@click.option("--corpus", "corpora", multiple=True, type=click.Choice(list(CORPORA)),
+              help="Corpus to run (repeatable, default: all)")
+@click.option("--baseline", default=DEFAULT_BASELINE, show_default=True,
+              help="Baseline JSON to compare against")
+@click.option("--save-baseline", is_flag=True,
+              help="Write the results to the baseline file instead of comparing")
+@click.option("--output", "-o", help="Also write the results to this JSON file")
+@click.option("--tolerance", default=0.2, show_default=True,
+              help="Allowed relative slowdown before a metric counts as a regression")
+@click.option("--repeat", default=1, show_default=True,
+              help="Runs per corpus; the fastest is kept")
+@click.option("--synthetic-files", default=8, show_default=True,
+              help="Files generated for the synthetic corpus")
+@click.option("--fail-on-regression", is_flag=True,
+              help="Exit with status 1 if any metric regressed")
+def main(corpora, baseline, save_baseline, output, tolerance, repeat,
+         synthetic_files, fail_on_regression):
+    """Benchmark the analyzer on the bundled and synthetic corpora."""
+    results = run_benchmarks(list(corpora) or None, synthetic_files=synthetic_files,
+                             repeat=repeat)
+    if output:
+        save_results(results, output)
+
+    if save_baseline:
+        save_results(results, baseline)
+        click.echo(format_results(results, []))
+        click.echo(f"\nBaseline written to {baseline}")
+        return
+
+    baseline_results = load_baseline(baseline)
+    findings = compare_results(results, baseline_results, tolerance) if baseline_results else []
+    click.echo(format_results(results, findings))
+    if baseline_results is None:
+        click.echo(f"\nNo baseline at {baseline}; run 'make bench-baseline' to create one")
+
+    if fail_on_regression and any(f["kind"] == "regression" for f in findings):
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
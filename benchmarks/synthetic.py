@@ -0,0 +1,120 @@
+"""Synthetic C sources that stress the analysis pipeline."""
+
+import os
+import random
+from typing import List
+
+
+def generate_source(globals_count: int = 200,
+                    switch_depth: int = 6,
+                    pointer_functions: int = 40,
+                    seed: int = 0) -> str:
+    """Generate one large C file.
+
+    The file mixes the constructs the built-in rules look at: many file
+    scope objects (MISRA 8.7), deeply nested switches with mixed signed and
+    unsigned arithmetic (MISRA 10.1, 16.4) and pointer-heavy functions with
+    allocations and array indexing (CERT EXP34-C, ARR30-C).
+
+    Args:
+        globals_count: Number of file scope objects
+        switch_depth: Nesting depth of the switch statements
+        pointer_functions: Number of pointer-heavy functions
+        seed: Seed for the deterministic choices
+
+    Returns:
+        C source text
+    """
+    rng = random.Random(seed)
+    globals_count = max(globals_count, 1)
+    lines = [
+        "#include <stdlib.h>",
+        "#include <string.h>",
+        "",
+        "#define BUFFER_SIZE 64",
+        ""
+    ]
+
+    for i in range(globals_count):
+        kind = i % 3
+        if kind == 0:
+            lines.append(f"static int g_counter_{i} = {i};")
+        elif kind == 1:
+            lines.append(f"int g_shared_{i};")
+        else:
+            lines.append(f"unsigned char g_u8_{i} = {rng.randrange(256)}u;")
+    lines.append("")
+
+    for f in range(max(1, globals_count // 20)):
+        lines.append(f"int state_machine_{f}(int state, unsigned int input)")
+        lines.append("{")
+        lines.append("    int result = 0;")
+        lines.extend(_nested_switch(rng, switch_depth, f, indent=1))
+        lines.append("    return result;")
+        lines.append("}")
+        lines.append("")
+
+    for p in range(pointer_functions):
+        index = rng.randrange(1, 8)
+        lines.extend([
+            f"int pointer_walk_{p}(int *values, size_t count)",
+            "{",
+            "    int buffer[BUFFER_SIZE];",
+            "    int *cursor = values;",
+            "    int *scratch = (int *)malloc(count * sizeof(int));",
+            "    int total = 0;",
+            "    size_t i;",
+            f"    *scratch = {p};",
+            "    for (i = 0; i < count; i++) {",
+            f"        buffer[i + {index}] = cursor[i];",
+            "        total += *(cursor + i);",
+            f"        scratch[i] = total - g_counter_{3 * (p % ((globals_count + 2) // 3))};",
+            "    }",
+            "    memset(buffer, 0, sizeof(buffer));",
+            "    free(scratch);",
+            "    return total;",
+            "}",
+            ""
+        ])
+
+    return "\n".join(lines) + "\n"
+
+
+def _nested_switch(rng: random.Random, depth: int, salt: int, indent: int) -> List[str]:
+    pad = "    " * indent
+    lines = [f"{pad}switch (state + {depth}) {{"]
+    for case in range(3):
+        lines.append(f"{pad}case {case}:")
+        if depth > 1 and case == 0:
+            lines.extend(_nested_switch(rng, depth - 1, salt, indent + 1))
+        else:
+            lines.append(f"{pad}    result += (int)(input + {rng.randrange(100)}u) - {case};")
+        lines.append(f"{pad}    break;")
+    # Leave out the default clause on alternate levels
+    if (depth + salt) % 2 == 0:
+        lines.append(f"{pad}default:")
+        lines.append(f"{pad}    result = -1;")
+        lines.append(f"{pad}    break;")
+    lines.append(f"{pad}}}")
+    return lines
+
+
+def write_corpus(directory: str, file_count: int = 8, **kwargs) -> List[str]:
+    """Write a synthetic corpus to a directory.
+
+    Args:
+        directory: Output directory (created if needed)
+        file_count: Number of files to generate
+        **kwargs: Passed to ``generate_source``
+
+    Returns:
+        Paths of the generated files
+    """
+    os.makedirs(directory, exist_ok=True)
+    paths = []
+    for i in range(file_count):
+        path = os.path.join(directory, f"synthetic_{i}.c")
+        with open(path, "w", encoding="utf-8") as f:
+            f.write(generate_source(seed=i, **kwargs))
+        paths.append(path)
+    return paths
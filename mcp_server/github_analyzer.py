@@ -6,8 +6,6 @@ Provides tools for LLMs to analyze commits and generate reports
 import asyncio
 import json
 import os
-import tempfile
-import subprocess
 from datetime import datetime
 from typing import Dict, List, Optional, Any
 from pathlib import Path
@@ -21,8 +19,12 @@ import mcp.types as types
 # Static analyzer imports
 import sys
 sys.path.append(str(Path(__file__).parent.parent))
-from static_analyzer import StaticAnalyzer, AnalyzerConfig
+from static_analyzer import AnalyzerConfig
+from static_analyzer.daemon import get_analyzer, get_local_service
 from static_analyzer.cli import main as cli_main
+from static_analyzer.incremental import IncrementalAnalyzer
+from static_analyzer.mirrors import MirrorCache, GitError
+from static_analyzer.baseline import BaselineIndex
 
 app = Server("static-analysis-github-mcp")
 
@@ -35,6 +37,10 @@ EMAIL_CONFIG = {
     "email_password": os.environ.get("EMAIL_PASSWORD"),
     "from_email": os.environ.get("FROM_EMAIL")
 }
+INCREMENTAL_STATE_DIR = os.environ.get(
+    "INCREMENTAL_STATE_DIR",
+    os.path.join(os.path.expanduser("~"), ".cache", "static_analyzer", "incremental")
+)
 
 @app.list_tools()
 async def list_tools() -> List[Tool]:
@@ -80,6 +86,15 @@ async def list_tools() -> List[Tool]:
                     "config_file": {
                         "type": "string",
                         "description": "Path to analyzer config file (optional)"
+                    },
+                    "base_sha": {
+                        "type": "string",
+                        "description": "Commit the changes are relative to (default: parent commit)"
+                    },
+                    "incremental": {
+                        "type": "boolean",
+                        "description": "Re-analyze only TUs affected by the change and reuse earlier results for the rest",
+                        "default": True
                     }
                 },
                 "required": ["repo_url", "commit_sha", "changed_files", "commit_author_email"]
@@ -237,9 +252,16 @@ async def analyze_commit_changes(
     commit_author: str = "Unknown",
     commit_message: str = "",
     standards: List[str] = ["MISRA", "CERT"],
-    config_file: Optional[str] = None
+    config_file: Optional[str] = None,
+    base_sha: Optional[str] = None,
+    incremental: bool = True
 ) -> List[types.Content]:
-    """Analyze C/C++ code changes in a GitHub commit."""
+    """Analyze C/C++ code changes in a GitHub commit.
+    
+    In incremental mode the whole tree is reported, but only the changed
+    TUs and the TUs including a changed header are re-analyzed; results
+    for everything else come from the base commit's stored state.
+    """
     
     try:
         # Filter for C/C++ files only
@@ -257,34 +279,11 @@ async def analyze_commit_changes(
                 }, indent=2)
             )]
         
-        # Create temporary directory for analysis
-        with tempfile.TemporaryDirectory() as temp_dir:
-            repo_dir = os.path.join(temp_dir, "repo")
-            
-            # Clone repository
-            clone_cmd = [
-                "git", "clone", "--depth", "1", 
-                "--branch", "main",  # We'll checkout specific commit after
-                repo_url, repo_dir
-            ]
-            
-            # Handle GitHub token authentication
-            if GITHUB_TOKEN:
-                # Modify URL to include token
-                if "github.com" in repo_url:
-                    auth_url = repo_url.replace("https://", f"https://{GITHUB_TOKEN}@")
-                    clone_cmd[5] = auth_url
-            
-            subprocess.run(clone_cmd, check=True, capture_output=True, text=True)
-            
-            # Checkout specific commit
-            subprocess.run(
-                ["git", "checkout", commit_sha], 
-                cwd=repo_dir, 
-                check=True, 
-                capture_output=True, 
-                text=True
-            )
+        # Check out the commit from the shared mirror cache
+        with MirrorCache.shared().checkout(repo_url, commit_sha) as checkout:
+            repo_dir = checkout.path
+            if base_sha is None:
+                base_sha = checkout.parent_sha
             
             # Prepare file paths for analysis
             files_to_analyze = []
@@ -293,7 +292,8 @@ async def analyze_commit_changes(
                 if os.path.exists(full_path):
                     files_to_analyze.append(full_path)
             
-            if not files_to_analyze:
+            # Deleting a header still affects the TUs that included it
+            if not files_to_analyze and not incremental:
                 return [TextContent(
                     type="text",
                     text=json.dumps({
@@ -312,9 +312,23 @@ async def analyze_commit_changes(
                 # Override with specified standards
                 config.config["standards"] = standards
             
-            # Create analyzer and run analysis
-            analyzer = StaticAnalyzer(config)
-            report = analyzer.analyze_files(files_to_analyze)
+            # Run analysis on a warm analyzer (the daemon's when one is running)
+            if incremental:
+                # Incremental state lives in this process, so use its own warm analyzer
+                with get_local_service().get(config.config).session() as analyzer:
+                    report = IncrementalAnalyzer(analyzer, INCREMENTAL_STATE_DIR).analyze_commit(
+                        repo_dir, repo_url, commit_sha, cpp_files, base_sha
+                    )
+                incremental_info = report.metadata["incremental"]
+                analyzed_files = incremental_info["reanalyzed_files"]
+            else:
+                report = get_analyzer(config).analyze_files(files_to_analyze)
+                incremental_info = None
+                analyzed_files = [os.path.relpath(f, repo_dir) for f in files_to_analyze]
+            
+            changed_paths = set(files_to_analyze)
+            changed_violations = [v for v in report.violations
+                                  if v.location.file_path in changed_paths]
             
             # Prepare results
             results = {
@@ -327,12 +341,14 @@ async def analyze_commit_changes(
                     "repository": repo_url
                 },
                 "analysis_metadata": {
-                    "analyzed_files": [os.path.relpath(f, repo_dir) for f in files_to_analyze],
-                    "total_files": len(files_to_analyze),
+                    "analyzed_files": analyzed_files,
+                    "total_files": len(analyzed_files),
                     "standards_checked": standards,
-                    "analysis_timestamp": datetime.now().isoformat()
+                    "analysis_timestamp": datetime.now().isoformat(),
+                    "incremental": incremental_info
                 },
-                "violations": [v.to_dict() for v in report.violations],
+                "violations": [v.to_dict(encode_json=True) for v in report.violations],
+                "violations_in_changed_files": len(changed_violations),
                 "summary": report.summary if hasattr(report, 'summary') else {
                     "total_violations": len(report.violations),
                     "by_severity": _count_by_severity(report.violations),
@@ -346,12 +362,12 @@ async def analyze_commit_changes(
                 text=json.dumps(results, indent=2)
             )]
             
-    except subprocess.CalledProcessError as e:
+    except GitError as e:
         return [TextContent(
             type="text",
             text=json.dumps({
                 "status": "error",
-                "message": f"Git operation failed: {e.stderr if e.stderr else str(e)}",
+                "message": f"Git operation failed: {str(e)}",
                 "commit_sha": commit_sha
             }, indent=2)
         )]
@@ -523,25 +539,9 @@ async def clone_and_analyze_repository(
     """Clone repository and analyze specified files."""
     
     try:
-        with tempfile.TemporaryDirectory() as temp_dir:
-            repo_dir = os.path.join(temp_dir, "repo")
-            
-            # Clone repository
-            clone_cmd = ["git", "clone", "--depth", "10", repo_url, repo_dir]
-            if GITHUB_TOKEN and "github.com" in repo_url:
-                auth_url = repo_url.replace("https://", f"https://{GITHUB_TOKEN}@")
-                clone_cmd[3] = auth_url
-            
-            subprocess.run(clone_cmd, check=True, capture_output=True, text=True)
-            
-            # Checkout specific branch/commit
-            subprocess.run(
-                ["git", "checkout", branch_or_commit],
-                cwd=repo_dir,
-                check=True,
-                capture_output=True,
-                text=True
-            )
+        # Check out the branch or commit from the shared mirror cache
+        with MirrorCache.shared().checkout(repo_url, branch_or_commit) as checkout:
+            repo_dir = checkout.path
             
             # Determine files to analyze
             if files_to_analyze:
@@ -575,8 +575,7 @@ async def clone_and_analyze_repository(
                 config = AnalyzerConfig.create_default()
             
             # Run analysis
-            analyzer = StaticAnalyzer(config)
-            report = analyzer.analyze_files(existing_files)
+            report = get_analyzer(config).analyze_files(existing_files)
             
             # Prepare results
             results = {
@@ -584,7 +583,7 @@ async def clone_and_analyze_repository(
                 "repository": repo_url,
                 "branch_or_commit": branch_or_commit,
                 "analyzed_files": [os.path.relpath(f, repo_dir) for f in existing_files],
-                "violations": [v.to_dict() for v in report.violations],
+                "violations": [v.to_dict(encode_json=True) for v in report.violations],
                 "summary": {
                     "total_violations": len(report.violations),
                     "by_severity": _count_by_severity(report.violations),
@@ -620,29 +619,10 @@ async def compare_with_baseline(
         current_violations = current_results.get("violations", [])
         baseline_violations = baseline_results.get("violations", [])
         
-        # Create signature sets for comparison
-        def create_signature(violation):
-            return (
-                violation["rule_id"],
-                violation["location"]["file_path"],
-                violation["location"]["line"],
-                violation["location"]["column"]
-            )
-        
-        baseline_signatures = {create_signature(v) for v in baseline_violations}
-        
-        # Find new violations
-        new_violations = []
-        for violation in current_violations:
-            if create_signature(violation) not in baseline_signatures:
-                new_violations.append(violation)
-        
-        # Find fixed violations
-        current_signatures = {create_signature(v) for v in current_violations}
-        fixed_violations = []
-        for violation in baseline_violations:
-            if create_signature(violation) not in current_signatures:
-                fixed_violations.append(violation)
+        # Match by fingerprint so violations moved by edits above them are not new
+        comparison = BaselineIndex.from_violations(baseline_violations).compare(current_violations)
+        new_violations = [current_violations[position] for position in comparison.new]
+        fixed_violations = [baseline_violations[row] for row in comparison.fixed]
         
         comparison_results = {
             "status": "success",
@@ -655,6 +635,7 @@ async def compare_with_baseline(
                 "total_baseline": len(baseline_violations),
                 "new_violations": len(new_violations),
                 "fixed_violations": len(fixed_violations),
+                "moved_violations": comparison.moved,
                 "net_change": len(new_violations) - len(fixed_violations)
             },
             "new_violations": new_violations,
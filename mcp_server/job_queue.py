@@ -0,0 +1,272 @@
+"""
+Bounded background job queue for webhook-triggered analysis
+Deduplicates redeliveries, coalesces superseded pushes and applies backpressure
+"""
+
+import itertools
+import logging
+import threading
+import time
+from collections import OrderedDict, deque
+from typing import Any, Callable, Deque, Dict, Hashable, Optional, Tuple
+
+
+class QueueFullError(Exception):
+    """Raised when the queue has no room for another job."""
+
+
+class Job:
+    """A unit of background work and its timings."""
+
+    QUEUED = "queued"
+    RUNNING = "running"
+    DONE = "done"
+    FAILED = "failed"
+    SUPERSEDED = "superseded"
+
+    def __init__(self, job_id: str, key: Hashable, func: Callable[..., Any],
+                 kwargs: Dict[str, Any], coalesce_key: Optional[Hashable] = None):
+        self.id = job_id
+        self.key = key
+        self.coalesce_key = coalesce_key
+        self.func = func
+        self.kwargs = kwargs
+        self.status = Job.QUEUED
+        self.enqueued_at = time.time()
+        self.started_at: Optional[float] = None
+        self.finished_at: Optional[float] = None
+        self.result: Any = None
+        self.error: Optional[str] = None
+        self.superseded_by: Optional[str] = None
+
+    @property
+    def wait_seconds(self) -> Optional[float]:
+        if self.started_at is None:
+            return None
+        return self.started_at - self.enqueued_at
+
+    @property
+    def run_seconds(self) -> Optional[float]:
+        if self.started_at is None or self.finished_at is None:
+            return None
+        return self.finished_at - self.started_at
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert the job to a JSON-compatible dictionary."""
+        return {
+            "id": self.id,
+            "key": list(self.key) if isinstance(self.key, tuple) else self.key,
+            "status": self.status,
+            "enqueued_at": self.enqueued_at,
+            "started_at": self.started_at,
+            "finished_at": self.finished_at,
+            "wait_seconds": self.wait_seconds,
+            "run_seconds": self.run_seconds,
+            "result": self.result,
+            "error": self.error,
+            "superseded_by": self.superseded_by
+        }
+
+
+class JobQueue:
+    """Fixed pool of worker threads consuming a bounded FIFO of jobs.
+
+    - Jobs with the same ``key`` (e.g. repository and SHA) that are
+      queued, running or recently finished are not run again, so webhook
+      redeliveries are free.
+    - A new job with the same ``coalesce_key`` (e.g. repository and
+      branch) as a job that hasn't started yet replaces it; an optional
+      ``merge`` callback carries over the old job's arguments.
+    - ``submit`` raises QueueFullError once ``max_pending`` jobs wait, so
+      callers can answer 503 instead of piling up work.
+    """
+
+    def __init__(self, workers: int = 2, max_pending: int = 50, max_history: int = 500):
+        """Initialize the queue and start its workers.
+
+        Args:
+            workers: Number of worker threads
+            max_pending: Maximum number of jobs waiting to run
+            max_history: Finished jobs kept for status and deduplication
+        """
+        self.workers = workers
+        self.max_pending = max_pending
+        self.max_history = max_history
+
+        self._pending: Deque[Job] = deque()
+        self._jobs: "OrderedDict[str, Job]" = OrderedDict()
+        self._by_key: Dict[Hashable, Job] = {}
+        self._condition = threading.Condition()
+        self._ids = itertools.count(1)
+        self._counts = {status: 0 for status in
+                        (Job.DONE, Job.FAILED, Job.SUPERSEDED)}
+        self._rejected = 0
+        self._duplicates = 0
+        self._total_wait = 0.0
+        self._total_run = 0.0
+        self._stopping = False
+
+        self._threads = [
+            threading.Thread(target=self._work, name=f"job-worker-{i}", daemon=True)
+            for i in range(workers)
+        ]
+        for thread in self._threads:
+            thread.start()
+
+    def submit(self, key: Hashable, func: Callable[..., Any],
+               kwargs: Optional[Dict[str, Any]] = None,
+               coalesce_key: Optional[Hashable] = None,
+               merge: Optional[Callable[[Dict[str, Any], Dict[str, Any]], Dict[str, Any]]] = None
+               ) -> Tuple[Job, bool]:
+        """Queue a job unless an equivalent one already exists.
+
+        Args:
+            key: Identity used for deduplication
+            func: Callable run with ``kwargs`` on a worker thread
+            kwargs: Keyword arguments for ``func``
+            coalesce_key: Jobs sharing this key supersede each other while queued
+            merge: Combines the superseded job's kwargs with the new ones
+
+        Returns:
+            (job, created) where created is False for a duplicate
+
+        Raises:
+            QueueFullError: If ``max_pending`` jobs are already waiting
+        """
+        kwargs = dict(kwargs or {})
+        with self._condition:
+            existing = self._by_key.get(key)
+            if existing is not None and existing.status in (Job.QUEUED, Job.RUNNING, Job.DONE):
+                self._duplicates += 1
+                return existing, False
+
+            superseded = None
+            if coalesce_key is not None:
+                superseded = next((job for job in self._pending
+                                   if job.coalesce_key == coalesce_key), None)
+
+            if superseded is None and len(self._pending) >= self.max_pending:
+                self._rejected += 1
+                raise QueueFullError(f"{len(self._pending)} jobs already queued")
+
+            job = Job(f"job-{next(self._ids)}", key, func, kwargs, coalesce_key)
+            if superseded is not None:
+                if merge is not None:
+                    job.kwargs = merge(superseded.kwargs, kwargs)
+                superseded.status = Job.SUPERSEDED
+                superseded.superseded_by = job.id
+                superseded.finished_at = time.time()
+                self._counts[Job.SUPERSEDED] += 1
+                self._pending.remove(superseded)
+                # The new job now covers the old key too, so redeliveries dedupe
+                self._by_key[superseded.key] = job
+
+            self._pending.append(job)
+            self._jobs[job.id] = job
+            self._by_key[key] = job
+            self._trim_history()
+            self._condition.notify()
+            return job, True
+
+    def get_job(self, job_id: str) -> Optional[Job]:
+        """Get a job by ID, if it is still in the history."""
+        with self._condition:
+            return self._jobs.get(job_id)
+
+    def get_status(self) -> Dict[str, Any]:
+        """Get queue depth, counters and timings.
+
+        Returns:
+            Dictionary suitable for a status endpoint
+        """
+        with self._condition:
+            running = [job for job in self._jobs.values() if job.status == Job.RUNNING]
+            finished = self._counts[Job.DONE] + self._counts[Job.FAILED]
+            now = time.time()
+            return {
+                "workers": self.workers,
+                "queue_depth": len(self._pending),
+                "max_pending": self.max_pending,
+                "running": len(running),
+                "completed": self._counts[Job.DONE],
+                "failed": self._counts[Job.FAILED],
+                "superseded": self._counts[Job.SUPERSEDED],
+                "duplicates": self._duplicates,
+                "rejected": self._rejected,
+                "avg_wait_seconds": round(self._total_wait / finished, 3) if finished else None,
+                "avg_run_seconds": round(self._total_run / finished, 3) if finished else None,
+                "oldest_queued_seconds": (round(now - self._pending[0].enqueued_at, 3)
+                                          if self._pending else None),
+                "running_jobs": [job.id for job in running],
+                "queued_jobs": [job.id for job in self._pending]
+            }
+
+    def render_metrics(self, prefix: str = "webhook_queue") -> str:
+        """Render the queue status in the Prometheus text exposition format."""
+        status = self.get_status()
+        metrics = [
+            ("depth", "gauge", "Jobs waiting to run", status["queue_depth"]),
+            ("running", "gauge", "Jobs running", status["running"]),
+            ("completed_total", "counter", "Jobs completed", status["completed"]),
+            ("failed_total", "counter", "Jobs failed", status["failed"]),
+            ("superseded_total", "counter", "Jobs replaced by a newer push", status["superseded"]),
+            ("duplicates_total", "counter", "Submissions matching an existing job", status["duplicates"]),
+            ("rejected_total", "counter", "Submissions rejected by backpressure", status["rejected"]),
+            ("wait_seconds_total", "counter", "Time finished jobs spent queued", round(self._total_wait, 3)),
+            ("run_seconds_total", "counter", "Time finished jobs spent running", round(self._total_run, 3))
+        ]
+        lines = []
+        for name, metric_type, help_text, value in metrics:
+            lines.append(f"# HELP {prefix}_{name} {help_text}")
+            lines.append(f"# TYPE {prefix}_{name} {metric_type}")
+            lines.append(f"{prefix}_{name} {value}")
+        return "\n".join(lines) + "\n"
+
+    def shutdown(self, wait: bool = True) -> None:
+        """Stop the workers after the jobs already running finish."""
+        with self._condition:
+            self._stopping = True
+            self._condition.notify_all()
+        if wait:
+            for thread in self._threads:
+                thread.join()
+
+    def _work(self) -> None:
+        while True:
+            with self._condition:
+                while not self._pending and not self._stopping:
+                    self._condition.wait()
+                if self._stopping:
+                    return
+                job = self._pending.popleft()
+                job.status = Job.RUNNING
+                job.started_at = time.time()
+
+            try:
+                result = job.func(**job.kwargs)
+                error = None
+            except Exception as e:
+                logging.error(f"Job {job.id} failed: {str(e)}")
+                result, error = None, str(e)
+
+            with self._condition:
+                job.finished_at = time.time()
+                job.result = result
+                job.error = error
+                job.status = Job.FAILED if error else Job.DONE
+                self._counts[job.status] += 1
+                self._total_wait += job.wait_seconds or 0.0
+                self._total_run += job.run_seconds or 0.0
+                self._trim_history()
+
+    def _trim_history(self) -> None:
+        """Forget the oldest finished jobs beyond ``max_history``."""
+        finished_states = (Job.DONE, Job.FAILED, Job.SUPERSEDED)
+        excess = len(self._jobs) - self.max_history
+        if excess <= 0:
+            return
+        for job_id in [job_id for job_id, job in self._jobs.items()
+                       if job.status in finished_states][:excess]:
+            job = self._jobs.pop(job_id)
+            for key in [k for k, v in self._by_key.items() if v is job]:
+                del self._by_key[key]
@@ -9,7 +9,9 @@ import asyncio
 import logging
 import hmac
 import hashlib
-from typing import Dict, Any, Optional
+import sys
+import threading
+from typing import Dict, Any, List, Optional
 from datetime import datetime
 
 # Web framework imports
@@ -23,6 +25,10 @@ from github import Github
 import subprocess
 import tempfile
 
+# Background job queue
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+from job_queue import JobQueue, QueueFullError
+
 app = Flask(__name__)
 logging.basicConfig(level=logging.INFO)
 
@@ -30,6 +36,13 @@ logging.basicConfig(level=logging.INFO)
 GITHUB_TOKEN = os.environ.get("GITHUB_TOKEN")
 WEBHOOK_SECRET = os.environ.get("GITHUB_WEBHOOK_SECRET")
 MCP_SERVER_PATH = os.path.join(os.path.dirname(__file__), "github_analyzer.py")
+WEBHOOK_WORKERS = int(os.environ.get("WEBHOOK_WORKERS", "2"))
+WEBHOOK_MAX_PENDING = int(os.environ.get("WEBHOOK_MAX_PENDING", "50"))
+QUEUE_RETRY_AFTER = int(os.environ.get("WEBHOOK_RETRY_AFTER", "60"))
+C_CPP_EXTENSIONS = {'.c', '.cpp', '.cc', '.cxx', '.h', '.hpp', '.hh', '.hxx'}
+
+_job_queue: Optional[JobQueue] = None
+_job_queue_lock = threading.Lock()
 
 # LLM Configuration (for Claude/GPT integration)
 LLM_CONFIG = {
@@ -90,43 +103,36 @@ def handle_push_event(payload: Dict[str, Any]) -> tuple:
         if not (ref.endswith('/main') or ref.endswith('/master')):
             return jsonify({"message": "Not a main/master branch push"}), 200
         
-        # Process each commit
-        analysis_results = []
+        # Keep the commits that touch C/C++ files
+        commit_infos = []
         for commit in commits:
-            commit_sha = commit.get('id')
             commit_author = commit.get('author', {})
-            commit_message = commit.get('message', '')
-            
-            # Get changed files
-            added = commit.get('added', [])
-            modified = commit.get('modified', []) 
-            changed_files = added + modified
-            
-            # Filter for C/C++ files
-            c_cpp_extensions = {'.c', '.cpp', '.cc', '.cxx', '.h', '.hpp', '.hh', '.hxx'}
-            cpp_files = [f for f in changed_files if any(f.endswith(ext) for ext in c_cpp_extensions)]
-            
+            changed_files = commit.get('added', []) + commit.get('modified', [])
+            cpp_files = filter_cpp_files(changed_files)
             if not cpp_files:
                 continue
             
-            # Trigger analysis via LLM + MCP
-            analysis_result = asyncio.run(trigger_llm_analysis(
-                repo_url=repo_url,
-                repo_name=repo_name,
-                commit_sha=commit_sha,
-                commit_author=commit_author.get('name', 'Unknown'),
-                commit_author_email=commit_author.get('email', ''),
-                commit_message=commit_message,
-                changed_files=cpp_files,
-                event_type='push'
-            ))
+            commit_infos.append({
+                "commit_sha": commit.get('id'),
+                "commit_author": commit_author.get('name', 'Unknown'),
+                "commit_author_email": commit_author.get('email', ''),
+                "commit_message": commit.get('message', ''),
+                "changed_files": cpp_files
+            })
             
-            analysis_results.append(analysis_result)
+        if not commit_infos:
+            return jsonify({"message": "No C/C++ files changed in push"}), 200
         
-        return jsonify({
-            "message": f"Processed {len(analysis_results)} commits",
-            "results": analysis_results
-        }), 200
+        # A newer push to the same branch absorbs a push still waiting in the queue
+        head_sha = payload.get('after') or commit_infos[-1]["commit_sha"]
+        return enqueue_analysis(
+            key=(repo_name, head_sha),
+            coalesce_key=(repo_name, ref),
+            func=run_push_analysis,
+            kwargs={"repo_url": repo_url, "repo_name": repo_name, "commits": commit_infos},
+            merge=merge_push_jobs,
+            message=f"Queued analysis of {len(commit_infos)} commits"
+        )
         
     except Exception as e:
         logging.error(f"Push event handling failed: {str(e)}")
@@ -140,60 +146,121 @@ def handle_pull_request_event(payload: Dict[str, Any]) -> tuple:
         if action not in ['opened', 'synchronize', 'reopened']:
             return jsonify({"message": f"PR action {action} not handled"}), 200
         
+        if not GITHUB_TOKEN:
+            return jsonify({"message": "GitHub token not configured"}), 200
+        
         pull_request = payload.get('pull_request', {})
         repository = payload.get('repository', {})
         
         # Extract PR information
         pr_number = pull_request.get('number')
-        pr_title = pull_request.get('title', '')
-        pr_author = pull_request.get('user', {}).get('login', 'unknown')
-        repo_url = repository.get('clone_url', '')
         repo_name = repository.get('full_name', 'unknown/repo')
+        head_sha = pull_request.get('head', {}).get('sha')
         
-        # Get PR commits using GitHub API
-        if GITHUB_TOKEN:
-            g = Github(GITHUB_TOKEN)
-            repo = g.get_repo(repo_name)
-            pr = repo.get_pull(pr_number)
-            
-            # Get changed files
-            changed_files = [f.filename for f in pr.get_files()]
-            c_cpp_extensions = {'.c', '.cpp', '.cc', '.cxx', '.h', '.hpp', '.hh', '.hxx'}
-            cpp_files = [f for f in changed_files if any(f.endswith(ext) for ext in c_cpp_extensions)]
-            
-            if not cpp_files:
-                return jsonify({"message": "No C/C++ files changed in PR"}), 200
-            
-            # Get latest commit
-            commits = list(pr.get_commits())
-            if commits:
-                latest_commit = commits[-1]
-                commit_sha = latest_commit.sha
-                
-                # Trigger analysis
-                analysis_result = asyncio.run(trigger_llm_analysis(
-                    repo_url=repo_url,
-                    repo_name=repo_name,
-                    commit_sha=commit_sha,
-                    commit_author=pr_author,
-                    commit_author_email=pull_request.get('user', {}).get('email', ''),
-                    commit_message=pr_title,
-                    changed_files=cpp_files,
-                    event_type='pull_request',
-                    pr_number=pr_number
-                ))
-                
-                return jsonify({
-                    "message": f"Analyzed PR #{pr_number}",
-                    "result": analysis_result
-                }), 200
-        
-        return jsonify({"message": "GitHub token not configured"}), 200
+        # GitHub API calls happen on the worker; a newer push to the PR replaces a queued one
+        return enqueue_analysis(
+            key=(repo_name, head_sha or f"pr-{pr_number}"),
+            coalesce_key=(repo_name, "pull", pr_number),
+            func=run_pull_request_analysis,
+            kwargs={
+                "repo_url": repository.get('clone_url', ''),
+                "repo_name": repo_name,
+                "pr_number": pr_number,
+                "pr_title": pull_request.get('title', ''),
+                "pr_author": pull_request.get('user', {}).get('login', 'unknown'),
+                "pr_author_email": pull_request.get('user', {}).get('email', '')
+            },
+            message=f"Queued analysis of PR #{pr_number}"
+        )
         
     except Exception as e:
         logging.error(f"PR event handling failed: {str(e)}")
         return jsonify({"error": str(e)}), 500
 
+def filter_cpp_files(changed_files: List[str]) -> List[str]:
+    """Keep the C/C++ source and header files."""
+    return [f for f in changed_files if any(f.endswith(ext) for ext in C_CPP_EXTENSIONS)]
+
+def get_job_queue() -> JobQueue:
+    """Get the analysis job queue, starting its workers on first use."""
+    global _job_queue
+    with _job_queue_lock:
+        if _job_queue is None:
+            _job_queue = JobQueue(workers=WEBHOOK_WORKERS, max_pending=WEBHOOK_MAX_PENDING)
+        return _job_queue
+
+def enqueue_analysis(key, coalesce_key, func, kwargs: Dict[str, Any],
+                     message: str, merge=None) -> tuple:
+    """Queue an analysis job and build the webhook response.
+    
+    Returns 202 with the job ID, or 503 with Retry-After when the queue is
+    full so the sender retries later instead of piling up work.
+    """
+    try:
+        job, created = get_job_queue().submit(key, func, kwargs,
+                                              coalesce_key=coalesce_key, merge=merge)
+    except QueueFullError as e:
+        logging.warning(f"Analysis queue full, rejecting event: {str(e)}")
+        response = jsonify({"error": "Analysis queue is full, retry later"})
+        response.headers['Retry-After'] = str(QUEUE_RETRY_AFTER)
+        return response, 503
+        
+    return jsonify({
+        "message": message if created else "Analysis already queued for this commit",
+        "job_id": job.id,
+        "status": job.status,
+        "duplicate": not created,
+        "status_url": f"/jobs/{job.id}"
+    }), 202
+
+def merge_push_jobs(old_kwargs: Dict[str, Any], new_kwargs: Dict[str, Any]) -> Dict[str, Any]:
+    """Fold a superseded push's commits into the newer push's job."""
+    seen = {c["commit_sha"] for c in new_kwargs["commits"]}
+    carried = [c for c in old_kwargs["commits"] if c["commit_sha"] not in seen]
+    return dict(new_kwargs, commits=carried + new_kwargs["commits"])
+
+def run_push_analysis(repo_url: str, repo_name: str, commits: List[Dict[str, Any]],
+                      event_type: str = 'push') -> List[Dict[str, Any]]:
+    """Worker entry point: analyze each commit of a (coalesced) push."""
+    analysis_results = []
+    for commit in commits:
+        analysis_results.append(asyncio.run(trigger_llm_analysis(
+            repo_url=repo_url,
+            repo_name=repo_name,
+            event_type=event_type,
+            **commit
+        )))
+    return analysis_results
+
+def run_pull_request_analysis(repo_url: str, repo_name: str, pr_number: int, pr_title: str,
+                              pr_author: str, pr_author_email: str) -> Dict[str, Any]:
+    """Worker entry point: analyze the latest commit of a pull request."""
+    g = Github(GITHUB_TOKEN)
+    repo = g.get_repo(repo_name)
+    pr = repo.get_pull(pr_number)
+    
+    # Get changed files
+    cpp_files = filter_cpp_files([f.filename for f in pr.get_files()])
+    if not cpp_files:
+        return {"status": "skipped", "message": "No C/C++ files changed in PR"}
+        
+    # Get latest commit
+    commits = list(pr.get_commits())
+    if not commits:
+        return {"status": "skipped", "message": "PR has no commits"}
+        
+    return asyncio.run(trigger_llm_analysis(
+        repo_url=repo_url,
+        repo_name=repo_name,
+        commit_sha=commits[-1].sha,
+        commit_author=pr_author,
+        commit_author_email=pr_author_email,
+        commit_message=pr_title,
+        changed_files=cpp_files,
+        event_type='pull_request',
+        pr_number=pr_number
+    ))
+
 async def trigger_llm_analysis(
     repo_url: str,
     repo_name: str, 
@@ -350,9 +417,28 @@ def health_check():
     return jsonify({
         "status": "healthy",
         "timestamp": datetime.now().isoformat(),
-        "mcp_server_available": os.path.exists(MCP_SERVER_PATH)
+        "mcp_server_available": os.path.exists(MCP_SERVER_PATH),
+        "queue_depth": get_job_queue().get_status()["queue_depth"]
     })
 
+@app.route('/queue', methods=['GET'])
+def queue_status():
+    """Queue depth, worker activity and job timings."""
+    return jsonify(get_job_queue().get_status())
+
+@app.route('/metrics', methods=['GET'])
+def queue_metrics():
+    """Queue metrics in the Prometheus text format."""
+    return get_job_queue().render_metrics(), 200, {'Content-Type': 'text/plain; version=0.0.4'}
+
+@app.route('/jobs/<job_id>', methods=['GET'])
+def job_status(job_id: str):
+    """Status and result of one analysis job."""
+    job = get_job_queue().get_job(job_id)
+    if job is None:
+        return jsonify({"error": "Unknown job"}), 404
+    return jsonify(job.to_dict())
+
 @app.route('/trigger-analysis', methods=['POST'])
 def manual_trigger():
     """Manual trigger endpoint for testing."""
@@ -364,18 +450,25 @@ def manual_trigger():
         if not all(field in data for field in required_fields):
             return jsonify({"error": "Missing required fields"}), 400
         
-        result = asyncio.run(trigger_llm_analysis(
-            repo_url=data['repo_url'],
-            repo_name=data.get('repo_name', 'manual/test'),
-            commit_sha=data['commit_sha'],
-            commit_author=data.get('author', 'Manual Trigger'),
-            commit_author_email=data['author_email'],
-            commit_message=data.get('message', 'Manual analysis trigger'),
-            changed_files=data['changed_files'],
-            event_type='manual'
-        ))
-        
-        return jsonify(result), 200
+        repo_name = data.get('repo_name', 'manual/test')
+        return enqueue_analysis(
+            key=(repo_name, data['commit_sha']),
+            coalesce_key=None,
+            func=run_push_analysis,
+            kwargs={
+                "repo_url": data['repo_url'],
+                "repo_name": repo_name,
+                "event_type": 'manual',
+                "commits": [{
+                    "commit_sha": data['commit_sha'],
+                    "commit_author": data.get('author', 'Manual Trigger'),
+                    "commit_author_email": data['author_email'],
+                    "commit_message": data.get('message', 'Manual analysis trigger'),
+                    "changed_files": data['changed_files']
+                }]
+            },
+            message="Queued manual analysis"
+        )
         
     except Exception as e:
         return jsonify({"error": str(e)}), 500
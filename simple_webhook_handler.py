@@ -12,6 +12,7 @@ import hashlib
 import subprocess
 import tempfile
 import shutil
+from contextlib import contextmanager
 from pathlib import Path
 from flask import Flask, request, jsonify
 import smtplib
@@ -44,6 +45,32 @@ def verify_signature(payload_body, signature_header):
     
     return hmac.compare_digest(expected_signature, signature_header)
 
+@contextmanager
+def checkout_repository(repo_url, commit_sha):
+    """Check out a commit from the shared mirror cache.
+    
+    Falls back to a fresh clone when the static analyzer package can't be
+    imported. Yields the checkout path, or None if it failed.
+    """
+    try:
+        sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+        from static_analyzer.mirrors import MirrorCache, GitError
+    except ImportError:
+        with tempfile.TemporaryDirectory() as temp_dir:
+            yield temp_dir if clone_repository(repo_url, commit_sha, temp_dir) else None
+        return
+    
+    entered = False
+    try:
+        with MirrorCache.shared().checkout(repo_url, commit_sha) as checkout:
+            entered = True
+            yield checkout.path
+    except GitError as e:
+        if entered:
+            raise
+        print(f"Git operation failed: {e}")
+        yield None
+
 def clone_repository(repo_url, commit_sha, temp_dir):
     """Clone repository and checkout specific commit"""
     try:
@@ -84,9 +111,9 @@ def analyze_repository(repo_path):
         try:
             # Import here to avoid import issues
             sys.path.insert(0, '/Users/prasadkachawar/Desktop/Static_code_analsys')
-            from static_analyzer import StaticAnalyzer
+            from static_analyzer.daemon import get_analyzer
             
-            analyzer = StaticAnalyzer()
+            analyzer = get_analyzer()
             report = analyzer.analyze_files(c_cpp_files)
             
             for violation in report.violations:
@@ -351,10 +378,9 @@ def handle_push_event(payload):
     
     print(f"Analyzing commit {commit_sha[:8]} in {repo_name}")
     
-    # Create temporary directory for analysis
-    with tempfile.TemporaryDirectory() as temp_dir:
-        # Clone repository
-        if not clone_repository(repo_url, commit_sha, temp_dir):
+    # Check out the commit for analysis
+    with checkout_repository(repo_url, commit_sha) as temp_dir:
+        if temp_dir is None:
             return jsonify({'error': 'Failed to clone repository'}), 500
         
         # Run analysis
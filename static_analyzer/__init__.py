@@ -35,14 +35,26 @@ __email__ = "dev@staticanalyzer.com"
 __license__ = "MIT"
 
 import os
+import copy
 import fnmatch
+import gc
+import time
+from concurrent.futures import ProcessPoolExecutor, as_completed
+from concurrent.futures import TimeoutError as FutureTimeoutError
 from pathlib import Path
-from typing import List, Optional, Dict, Any
-from .ast import ASTParser
-from .rules import RuleEngine
+from typing import List, Optional, Dict, Any, Tuple, Iterator, Iterable, Set
+from .ast import ASTParser, CompileCommandsDatabase, SourceBufferCache, WalkScope
+from .rules import RuleEngine, LexicalPrefilter
 from .models import AnalysisReport, Violation, Standard, Severity, Confidence, RuleMetadata, SourceLocation, Deviation
 from .config import AnalyzerConfig, DeviationManager, create_default_config_file
 from .ai_assistant import create_ai_assistant
+from .cache import ResultCache
+from .profiling import AnalysisProfiler, get_metrics
+from .program import ProgramSummary, TranslationUnitSummary, save_summary
+from .reports import ReportWriter, SpillReportWriter
+from .memory import MemoryCeiling, ViolationLimiter, current_rss_bytes
+from .shard import (ShardSpec, check_shard_coverage, load_file_timings, load_shard_reports,
+                    merge_shard_metadata)
 
 
 class StaticAnalyzer:
@@ -61,9 +73,36 @@ class StaticAnalyzer:
         self.deviation_manager = DeviationManager(deviations_file)
         
         # Initialize components
-        self.ast_parser = ASTParser(self.config.get_include_paths())
-        self.rule_engine = RuleEngine()
+        compile_commands = None
+        if self.config.get_compile_commands():
+            compile_commands = CompileCommandsDatabase(self.config.get_compile_commands())
+        
+        self.ast_parser = ASTParser(
+            self.config.get_include_paths(),
+            precompiled_headers=self.config.get_precompiled_headers(),
+            pch_dir=self.config.get_pch_dir(),
+            compile_commands=compile_commands,
+            tu_cache_size=self.config.get_tu_cache_size()
+        )
+        walk_scope = self.config.get_walk_scope()
+        if walk_scope not in WalkScope.CHOICES:
+            print(f"Warning: Unknown walk_scope '{walk_scope}', walking everything")
+            walk_scope = WalkScope.ALL
+        self.rule_engine = RuleEngine(
+            use_native=self.config.is_native_backend_enabled(),
+            walk_scope=walk_scope,
+            exclude_patterns=self.config.get_exclude_paths()
+        )
         self.rule_engine.register_builtin_rules()
+        self.prefilter = LexicalPrefilter() if self.config.is_lexical_prefilter_enabled() else None
+        
+        # Source snippets are served from one bounded cache per process
+        SourceBufferCache.shared().max_bytes = self.config.get_source_cache_bytes()
+        
+        # Result cache is created on first use so config overrides made after
+        # construction (e.g. by the CLI) are honoured
+        self._result_cache: Optional[ResultCache] = None
+        self._cache_fingerprints: Dict[Tuple[str, ...], str] = {}
         
         # Initialize AI assistant if enabled
         self.ai_assistant = None
@@ -72,75 +111,419 @@ class StaticAnalyzer:
     
     def analyze_files(self, 
                      file_paths: List[str],
-                     enabled_rules: Optional[List[str]] = None) -> AnalysisReport:
+                     enabled_rules: Optional[List[str]] = None,
+                     report_writer: Optional[ReportWriter] = None) -> AnalysisReport:
         """Analyze a list of source files.
         
         Args:
             file_paths: List of C/C++ source files to analyze
             enabled_rules: Optional list of rule IDs to run
+            report_writer: Stream violations to this writer as each file
+                finishes instead of keeping them in the report. The writer
+                is closed when analysis ends.
             
         Returns:
-            AnalysisReport containing all violations found
+            AnalysisReport containing all violations found, or only the
+            summary and metadata when streaming to a writer. With a
+            configured shard, only that shard's files are analyzed.
+        """
+        enabled_rules = self.resolve_enabled_rules(enabled_rules)
+        
+        # Filter files based on include/exclude patterns
+        filtered_files = self._filter_files(file_paths)
+        
+        shard = self.get_shard()
+        if shard is not None:
+            timings_path = self.config.get_shard_timings()
+            timings = load_file_timings(timings_path) if timings_path else None
+            filtered_files = shard.select(filtered_files, timings)
+        
+        return self.build_report(
+            self.iter_file_results(filtered_files, enabled_rules,
+                                   whole_program=self.config.is_whole_program_enabled()),
+            enabled_rules,
+            files_analyzed=len(filtered_files),
+            total_files_provided=len(file_paths),
+            report_writer=report_writer,
+            shard=shard
+        )
+    
+    def get_shard(self) -> Optional[ShardSpec]:
+        """Get the configured shard, or None when every file is analyzed.
+        
+        Raises:
+            ValueError: If the configured shard is not of the form ``i/N``
+        """
+        shard = self.config.get_shard()
+        return ShardSpec.parse(shard) if shard else None
+    
+    def resolve_enabled_rules(self, enabled_rules: Optional[List[str]] = None) -> List[str]:
+        """Get the rule IDs to run, without disabled rules.
+        
+        Args:
+            enabled_rules: Requested rule IDs, rule pack names or standards
+                (default: configured rules)
+            
+        Returns:
+            List of rule IDs
         """
         if enabled_rules is None:
             enabled_rules = self.config.get_enabled_rules()
         
-        # Filter out disabled rules
-        disabled_rules = set(self.config.get_disabled_rules())
-        enabled_rules = [rule_id for rule_id in enabled_rules 
-                        if rule_id not in disabled_rules]
+        # Pack names and standards stand for every rule they contain
+        registry = self.rule_engine.registry
+        enabled_rules = registry.expand_rule_ids(enabled_rules)
+        
+        # Filter out disabled rules and rules of standards that are not enabled
+        disabled_rules = set(registry.expand_rule_ids(self.config.get_disabled_rules()))
+        standards = {standard.value for standard in self.config.get_enabled_standards()}
+        return [rule_id for rule_id in enabled_rules 
+                if rule_id not in disabled_rules
+                and (not standards or registry.get_rule_standard(rule_id) in standards | {None})]
+    
+    def iter_file_results(self,
+                          file_paths: List[str],
+                          enabled_rules: List[str],
+                          ordered: bool = True,
+                          whole_program: bool = False,
+                          deadline: Optional[float] = None) -> Iterator[Tuple[str, List[Violation], Dict[str, Any]]]:
+        """Analyze files, yielding raw results as each file finishes.
+        
+        Results come before de-duplication and deviations. Closing the
+        iterator early cancels files that have not started.
+        
+        Args:
+            file_paths: Files to analyze
+            enabled_rules: List of rule IDs to run
+            ordered: Yield in input order; otherwise parallel runs yield in
+                completion order
+            whole_program: Summarize each unit for whole-program rules
+                instead of running them per unit (see build_report)
+            deadline: time.monotonic() at which to stop. Parallel runs stop
+                waiting then and abandon files still running; sequential
+                runs start no file after it.
+            
+        Yields:
+            (file_path, violations, stats) tuples. stats["includes"] lists
+            the files the translation unit included; in whole-program runs
+            stats["summary"] holds its TranslationUnitSummary.
+        """
+        parallelism = min(self.config.get_parallelism(), len(file_paths))
+        if parallelism > 1:
+            file_results = self._analyze_files_parallel(
+                file_paths, enabled_rules, parallelism, ordered, whole_program, deadline
+            )
+        else:
+            file_results = self._analyze_files_sequential(file_paths, enabled_rules, whole_program,
+                                                          deadline)
+        
+        result_cache = self.get_result_cache()
+        for file_path, file_violations, file_stats in file_results:
+            if result_cache and file_stats.get("cache"):
+                result_cache.merge_stats(file_stats["cache"])
+            yield file_path, file_violations, file_stats
+    
+    def iter_violations(self,
+                        file_paths: List[str],
+                        enabled_rules: Optional[List[str]] = None,
+                        deadline: Optional[float] = None) -> Iterator[Tuple[str, List[Violation]]]:
+        """Analyze files, yielding each file's reportable violations as it finishes.
+        
+        Files come in completion order so callers can show progress;
+        stopping early cancels the files not yet started. Violations are
+        de-duplicated against earlier files, filtered by deviations and
+        AI-enhanced when enabled. Whole-program rules run per file here,
+        since there is no link step to wait for.
+        
+        Args:
+            file_paths: Files to analyze
+            enabled_rules: Optional list of rule IDs to run
+            deadline: time.monotonic() at which to stop (see
+                iter_file_results); files not yielded by then are skipped
+            
+        Yields:
+            (file_path, violations) tuples
+        """
+        enabled_rules = self.resolve_enabled_rules(enabled_rules)
+        seen: Set[Tuple[Any, ...]] = set()
+        file_results = self.iter_file_results(self._filter_files(file_paths), enabled_rules,
+                                              ordered=False, deadline=deadline)
+        for file_path, file_violations, _ in file_results:
+            violations = self.filter_new_violations(file_violations, seen)
+            if self.ai_assistant and violations:
+                violations = self.ai_assistant.enhance_violations(violations)
+            yield file_path, violations
+    
+    def filter_new_violations(self,
+                              violations: List[Violation],
+                              seen: Set[Tuple[Any, ...]],
+                              apply_deviations: bool = True) -> List[Violation]:
+        """De-duplicate one file's raw violations and apply deviations.
+        
+        Args:
+            violations: Raw violations of one file
+            seen: Keys of violations already reported in this run; updated
+            apply_deviations: False to keep deviated violations (shards
+                leave them to merge_shard_reports)
+            
+        Returns:
+            Violations to report for the file
+        """
+        # Header violations are found once per including TU; keep the first
+        unique_violations = []
+        for violation in violations:
+            key = self._violation_key(violation)
+            if key not in seen:
+                seen.add(key)
+                unique_violations.append(violation)
+        if not apply_deviations:
+            return unique_violations
+        return self._apply_deviations(unique_violations)
+    
+    def build_report(self,
+                     file_results: Iterable[Tuple[str, List[Violation], Dict[str, Any]]],
+                     enabled_rules: List[str],
+                     files_analyzed: int,
+                     total_files_provided: Optional[int] = None,
+                     report_writer: Optional[ReportWriter] = None,
+                     shard: Optional[ShardSpec] = None) -> AnalysisReport:
+        """Turn raw per-file results into a report.
         
+        Args:
+            file_results: (file_path, violations, stats) tuples in report order
+            enabled_rules: Rule IDs that were run
+            files_analyzed: Number of files the results cover
+            total_files_provided: Number of files originally requested
+            report_writer: Optional writer to stream violations to
+            shard: Shard the results belong to; its per-file timings are
+                recorded for merge_shard_reports, which also links
+                whole-program summaries and applies deviations in place of
+                this report
+            
+        Returns:
+            AnalysisReport with de-duplicated violations. Outside a shard
+            they are deviation-filtered and at most max_violations_per_rule
+            of each rule. When the results carry whole-program summaries,
+            the linked whole-program violations follow the per-file ones.
+        """
         report = AnalysisReport([], {}, {})
+        profiler = AnalysisProfiler()
+        run_start = time.perf_counter()
         
-        # Filter files based on include/exclude patterns
-        filtered_files = self._filter_files(file_paths)
+        seen: Set[Tuple[Any, ...]] = set()
+        summaries: List[TranslationUnitSummary] = []
+        summary_dir = self.config.get_summary_dir()
+        # Shards keep every violation: merge_shard_reports caps rules after deviations
+        limiter = ViolationLimiter(self.config.get_max_violations_per_rule() if shard is None else 0)
+        ceiling = MemoryCeiling(self.config.get_memory_ceiling_bytes())
+        # Past the memory ceiling, violations are written to a temporary file
+        # and the report reads them back from it
+        spill: Optional[SpillReportWriter] = None
         
-        for file_path in filtered_files:
-            try:
-                file_violations = self._analyze_single_file(file_path, enabled_rules)
-                
-                # Apply deviations
-                filtered_violations = self._apply_deviations(file_violations)
-                
+        def write_violations(writer: ReportWriter, violations: List[Violation]) -> None:
+            if self.ai_assistant:
+                with profiler.phase("ai"):
+                    violations = self.ai_assistant.enhance_violations(violations)
+            with profiler.phase("report"):
+                writer.write_violations(violations)
+        
+        def add_violations(violations: List[Violation]) -> None:
+            nonlocal spill
+            with profiler.phase("deviations"):
+                filtered_violations = limiter.admit(
+                    self.filter_new_violations(violations, seen, apply_deviations=shard is None)
+                )
+            
+            if report_writer or spill:
+                write_violations(report_writer or spill, filtered_violations)
+            else:
                 report.violations.extend(filtered_violations)
-                
-            except Exception as e:
-                print(f"Error analyzing {file_path}: {str(e)}")
-                continue
+                if ceiling.exceeded():
+                    spill = SpillReportWriter()
+                    print(f"Warning: Memory use passed {ceiling.max_bytes // (1024 * 1024)} MB, "
+                          f"moving the violations to {spill.path}")
+                    write_violations(spill, report.violations)
+                    report.violations = []
+        
+        for file_path, file_violations, file_stats in file_results:
+            if file_stats.get("profile"):
+                profiler.add_file(file_path, file_stats["profile"])
+            summary = file_stats.get("summary")
+            if summary is not None:
+                summaries.append(summary)
+                if summary_dir:
+                    save_summary(summary, summary_dir)
+            
+            add_violations(file_violations)
+        
+        if summaries and shard is None:
+            with profiler.phase("link"):
+                program_violations = self.link_summaries(summaries, enabled_rules)
+            add_violations(program_violations)
         
         # Enhance with AI if enabled
-        if self.ai_assistant:
-            report.violations = self.ai_assistant.enhance_violations(report.violations)
+        if self.ai_assistant and not report_writer and not spill:
+            with profiler.phase("ai"):
+                report.violations = self.ai_assistant.enhance_violations(report.violations)
+        
+        profiler.add_phase("total", time.perf_counter() - run_start)
+        profile = profiler.to_dict()
+        get_metrics().record(profile)
         
         # Generate report metadata
+        result_cache = self.get_result_cache()
         report.metadata = {
             "analyzer_version": "1.0.0",
             "config": {
                 "enabled_rules": enabled_rules,
                 "standards": [s.value for s in self.config.get_enabled_standards()],
-                "ai_enabled": self.config.is_ai_enabled()
+                "ai_enabled": self.config.is_ai_enabled(),
+                "parallelism": max(min(self.config.get_parallelism(), files_analyzed), 1)
             },
-            "files_analyzed": len(filtered_files),
-            "total_files_provided": len(file_paths),
-            "deviations_applied": len(self.deviation_manager.deviations)
+            "files_analyzed": files_analyzed,
+            "total_files_provided": (total_files_provided
+                                     if total_files_provided is not None else files_analyzed),
+            "deviations_applied": len(self.deviation_manager.deviations) if shard is None else 0,
+            "profile": profile
         }
+        if result_cache:
+            report.metadata["cache"] = result_cache.get_stats()
+        if limiter.total_dropped:
+            report.metadata["dropped_violations"] = limiter.to_dict()
+            print(f"Warning: {limiter.total_dropped} violations over max_violations_per_rule "
+                  f"({limiter.max_per_rule}) were counted but not reported")
+        if self.config.is_memory_bounded() or ceiling.max_bytes:
+            report.metadata["memory"] = {
+                "bounded": self.config.is_memory_bounded(),
+                "ceiling_mb": ceiling.max_bytes // (1024 * 1024),
+                "peak_rss_mb": max(ceiling.peak_bytes, current_rss_bytes() or 0) // (1024 * 1024),
+                "spilled_violations": len(spill.offsets) if spill else 0
+            }
+            if spill:
+                report.metadata["memory"]["spilled_to"] = spill.path
+        response_cache = getattr(self.ai_assistant, "response_cache", None)
+        if response_cache:
+            report.metadata["ai_cache"] = response_cache.get_stats()
+        if self.ast_parser.compile_commands:
+            report.metadata["compile_commands"] = self.ast_parser.compile_commands.path
+        
+        if summaries:
+            report.metadata["whole_program"] = {"translation_units": len(summaries),
+                                                "linked": shard is None}
+            if summary_dir:
+                report.metadata["whole_program"]["summary_dir"] = summary_dir
+        if shard is not None:
+            report.metadata["shard"] = {
+                "index": shard.index,
+                "count": shard.count,
+                "file_seconds": profiler.file_seconds()
+            }
+        
+        if report_writer:
+            report.metadata["streamed_to"] = report_writer.format_name
+            rules = {rule.get_metadata().id: rule.get_metadata()
+                     for rule in self.rule_engine.registry.get_enabled_rules(enabled_rules)}
+            report.summary = report_writer.close(report.metadata, rules)
+        elif spill:
+            report.violations = spill.finish(report.metadata)
+        
+        return report
+    
+    def merge_shard_reports(self,
+                            report_paths: List[str],
+                            summaries: Optional[Iterable[TranslationUnitSummary]] = None,
+                            enabled_rules: Optional[List[str]] = None) -> AnalysisReport:
+        """Combine the reports of a sharded run into one.
+        
+        Violations are taken in shard order. Header violations several
+        shards found are kept once. Shards report violations before
+        deviations, which are applied once, here.
         
+        Args:
+            report_paths: Shard reports (JSON, NDJSON or store format)
+            summaries: Whole-program summaries written by the shards, to be
+                linked over the whole program
+            enabled_rules: Rule IDs to link (default: configured rules)
+            
+        Returns:
+            AnalysisReport over every shard
+        """
+        reports = load_shard_reports(report_paths)
+        for issue in check_shard_coverage(reports):
+            print(f"Warning: {issue}")
+        
+        seen: Set[Tuple[Any, ...]] = set()
+        limiter = ViolationLimiter(self.config.get_max_violations_per_rule())
+        violations: List[Violation] = []
+        for _, store in reports:
+            violations.extend(limiter.admit(self.filter_new_violations(list(store), seen)))
+        
+        metadata = merge_shard_metadata(reports)
+        if summaries is not None:
+            summaries = list(summaries)
+            violations.extend(limiter.admit(self.filter_new_violations(
+                self.link_summaries(summaries, enabled_rules), seen
+            )))
+            metadata["whole_program"] = {"translation_units": len(summaries), "linked": True}
+        metadata["deviations_applied"] = len(self.deviation_manager.deviations)
+        if limiter.total_dropped:
+            metadata["dropped_violations"] = limiter.to_dict()
+        
+        report = AnalysisReport(violations, {}, metadata)
+        report.generate_summary()
         return report
     
+    def link_summaries(self,
+                       summaries: Iterable[TranslationUnitSummary],
+                       enabled_rules: Optional[List[str]] = None) -> List[Violation]:
+        """Run the link step of whole-program rules over TU summaries.
+        
+        Args:
+            summaries: Summaries of every translation unit of the program,
+                from this run or loaded from summary directories
+            enabled_rules: Optional list of rule IDs to run
+            
+        Returns:
+            Raw violations, before de-duplication and deviations
+        """
+        enabled_rules = self.resolve_enabled_rules(enabled_rules)
+        return self.rule_engine.check_program(ProgramSummary.link(summaries), enabled_rules)
+    
     def analyze_directory(self, 
                          directory_path: str,
                          recursive: bool = True,
-                         file_extensions: Optional[List[str]] = None) -> AnalysisReport:
+                         file_extensions: Optional[List[str]] = None,
+                         enabled_rules: Optional[List[str]] = None,
+                         report_writer: Optional[ReportWriter] = None) -> AnalysisReport:
         """Analyze all C/C++ files in a directory.
         
         Args:
             directory_path: Directory to analyze
             recursive: Whether to analyze subdirectories
             file_extensions: File extensions to include
+            enabled_rules: Optional list of rule IDs to run
+            report_writer: Optional writer to stream violations to
             
         Returns:
             AnalysisReport containing all violations found
         """
+        source_files = self.find_source_files(directory_path, recursive, file_extensions)
+        return self.analyze_files(source_files, enabled_rules, report_writer)
+    
+    def find_source_files(self,
+                          directory_path: str,
+                          recursive: bool = True,
+                          file_extensions: Optional[List[str]] = None) -> List[str]:
+        """Find the C/C++ files in a directory.
+        
+        Args:
+            directory_path: Directory to search
+            recursive: Whether to search subdirectories
+            file_extensions: File extensions to include
+            
+        Returns:
+            Sorted list of file paths
+        """
         if file_extensions is None:
             file_extensions = ['.c', '.cpp', '.cc', '.cxx', '.h', '.hpp', '.hh', '.hxx']
         
@@ -162,7 +545,186 @@ class StaticAnalyzer:
                 files = list(directory.glob(pattern))
                 source_files.extend([str(f) for f in files])
         
-        return self.analyze_files(source_files)
+        # Sort so the report order does not depend on filesystem order
+        return sorted(set(source_files))
+    
+    def analyze_compile_commands(self,
+                                 compile_commands_path: Optional[str] = None,
+                                 source_path: Optional[str] = None,
+                                 enabled_rules: Optional[List[str]] = None,
+                                 report_writer: Optional[ReportWriter] = None) -> AnalysisReport:
+        """Analyze the translation units listed in a compilation database.
+        
+        Each TU is parsed with its recorded flags. Headers are not parsed on
+        their own; their violations are reported through the TUs that
+        include them.
+        
+        Args:
+            compile_commands_path: compile_commands.json or its directory
+                (default: the configured database)
+            source_path: Only analyze TUs under this file or directory
+            enabled_rules: Optional list of rule IDs to run
+            report_writer: Optional writer to stream violations to
+            
+        Returns:
+            AnalysisReport containing all violations found
+        """
+        if compile_commands_path:
+            self.set_compile_commands(compile_commands_path)
+        
+        if self.ast_parser.compile_commands is None:
+            raise ValueError("No compilation database configured")
+        
+        return self.analyze_files(self.collect_source_files(source_path), enabled_rules, report_writer)
+    
+    def collect_source_files(self,
+                             path: Optional[str] = None,
+                             recursive: bool = True) -> List[str]:
+        """Collect the files an analysis of a path covers.
+        
+        With a compilation database these are its TUs under the path (all
+        of them without a path). Otherwise they are the C/C++ files in a
+        directory, or the path itself if it is a file. Exclude patterns
+        apply either way.
+        
+        Args:
+            path: File or directory (optional with a compilation database)
+            recursive: Whether to search subdirectories (without a database)
+            
+        Returns:
+            Sorted list of file paths
+        """
+        compile_commands = self.ast_parser.compile_commands
+        if compile_commands is not None:
+            source_files = compile_commands.get_source_files()
+            if path:
+                root = os.path.abspath(path)
+                source_files = [f for f in source_files
+                                if f == root or f.startswith(root.rstrip(os.sep) + os.sep)]
+        elif path is None:
+            raise ValueError("No path given and no compilation database configured")
+        elif os.path.isfile(path):
+            source_files = [path]
+        else:
+            source_files = self.find_source_files(path, recursive)
+        
+        return self._filter_files(source_files)
+    
+    def set_compile_commands(self, compile_commands_path: str) -> None:
+        """Parse files with the flags from a compilation database.
+        
+        Args:
+            compile_commands_path: compile_commands.json or its directory
+        """
+        self.ast_parser.compile_commands = CompileCommandsDatabase(compile_commands_path)
+        self.config.config["analysis"]["compile_commands"] = compile_commands_path
+        self._cache_fingerprints.clear()
+    
+    def _analyze_files_sequential(self,
+                                  file_paths: List[str],
+                                  enabled_rules: List[str],
+                                  whole_program: bool = False,
+                                  deadline: Optional[float] = None) -> Iterator[Tuple[str, List[Violation], Dict[str, Any]]]:
+        """Analyze files one after another in this process.
+        
+        Args:
+            file_paths: Files to analyze
+            enabled_rules: List of rule IDs to run
+            whole_program: Summarize each unit for whole-program rules
+            deadline: time.monotonic() after which no file is started
+            
+        Yields:
+            (file_path, violations, stats) tuples in input order, as each
+            file finishes. Stats carry the included files and the file's
+            profile; this process's cache counters are already current.
+        """
+        for file_path in file_paths:
+            if deadline is not None and time.monotonic() >= deadline:
+                return
+            file_profile: Dict[str, Any] = {}
+            summary = TranslationUnitSummary(file_path) if whole_program else None
+            try:
+                file_violations, included_files = self._analyze_file(
+                    file_path, enabled_rules, file_profile, summary
+                )
+            except Exception as e:
+                print(f"Error analyzing {file_path}: {str(e)}")
+                continue
+            file_stats = {"includes": included_files, "profile": file_profile}
+            if summary is not None:
+                file_stats["summary"] = summary
+            yield file_path, file_violations, file_stats
+    
+    def _analyze_files_parallel(self,
+                                file_paths: List[str],
+                                enabled_rules: List[str],
+                                parallelism: int,
+                                ordered: bool = True,
+                                whole_program: bool = False,
+                                deadline: Optional[float] = None) -> Iterator[Tuple[str, List[Violation], Dict[str, Any]]]:
+        """Analyze files across a pool of worker processes.
+        
+        Each worker builds its own analyzer (and so its own clang Index).
+        By default results are collected in input order, so the report is
+        identical to a sequential run regardless of which worker finishes
+        first.
+        
+        Args:
+            file_paths: Files to analyze
+            enabled_rules: List of rule IDs to run
+            parallelism: Number of worker processes
+            ordered: Yield in input order rather than completion order
+            whole_program: Summarize each unit for whole-program rules
+            deadline: time.monotonic() at which to stop waiting; files
+                still running are abandoned to their workers
+            
+        Yields:
+            (file_path, violations, stats) tuples, where stats carries the
+            worker's counters for that file
+        """
+        worker_config = copy.deepcopy(self.config.config)
+        # AI enrichment and deviations are applied once, in this process
+        worker_config.setdefault("ai_assistant", {})["enabled"] = False
+        worker_config.setdefault("analysis", {})["parallelism"] = 1
+        
+        # Build the PCH once here so workers load it instead of each compiling it
+        pch_path = self.ast_parser.get_precompiled_header()
+        if pch_path:
+            worker_config["analysis"]["pch_dir"] = self.ast_parser.pch_dir
+        
+        executor = ProcessPoolExecutor(max_workers=parallelism,
+                                       initializer=_init_worker,
+                                       initargs=(worker_config,))
+        timed_out = False
+        try:
+            futures = [
+                executor.submit(_analyze_file_in_worker, file_path, enabled_rules, whole_program)
+                for file_path in file_paths
+            ]
+            timeout = None if deadline is None else max(deadline - time.monotonic(), 0)
+            if ordered:
+                finished = zip(file_paths, futures)
+            else:
+                future_paths = dict(zip(futures, file_paths))
+                finished = ((future_paths[future], future)
+                            for future in as_completed(futures, timeout=timeout))
+            for file_path, future in finished:
+                if ordered and deadline is not None:
+                    timeout = max(deadline - time.monotonic(), 0)
+                try:
+                    file_violations, file_stats = future.result(timeout=timeout if ordered else None)
+                except FutureTimeoutError:
+                    raise
+                except Exception as e:
+                    print(f"Error analyzing {file_path}: {str(e)}")
+                    continue
+                yield file_path, file_violations, file_stats
+        except FutureTimeoutError:
+            timed_out = True
+        finally:
+            # A consumer that stops early only waits for files already running;
+            # past the deadline it doesn't wait for those either
+            executor.shutdown(wait=not timed_out, cancel_futures=True)
     
     def _analyze_single_file(self, 
                            file_path: str, 
@@ -176,18 +738,141 @@ class StaticAnalyzer:
         Returns:
             List of violations found in the file
         """
+        return self._analyze_file(file_path, enabled_rules)[0]
+    
+    def _analyze_file(self,
+                      file_path: str,
+                      enabled_rules: List[str],
+                      profile: Optional[Dict[str, Any]] = None,
+                      summary: Optional[TranslationUnitSummary] = None) -> Tuple[List[Violation], List[str]]:
+        """Analyze a single source file and report what it included.
+        
+        Args:
+            file_path: Path to source file
+            enabled_rules: List of rule IDs to run
+            profile: If given, receives the file's timings (see
+                AnalysisProfiler)
+            summary: For a whole-program run, filled with the unit's
+                summary; whole-program rules then report nothing here
+            
+        Returns:
+            Violations found in the file and the files its TU included
+        """
+        profile = profile if profile is not None else {}
+        start = time.perf_counter()
+        try:
+            return self._analyze_file_uncached(file_path, enabled_rules, profile, summary)
+        finally:
+            profile["seconds"] = time.perf_counter() - start
+    
+    def _analyze_file_uncached(self,
+                               file_path: str,
+                               enabled_rules: List[str],
+                               profile: Dict[str, Any],
+                               summary: Optional[TranslationUnitSummary] = None) -> Tuple[List[Violation], List[str]]:
+        """Body of _analyze_file, without the overall timing."""
+        result_cache = self.get_result_cache()
+        fingerprint = None
+        args = self.ast_parser.get_arguments(file_path)
+        if result_cache:
+            fingerprint = self._get_cache_fingerprint(enabled_rules, args, summary is not None)
+            cached = result_cache.lookup_with_summary(file_path, fingerprint)
+            if cached is not None:
+                profile["cached"] = True
+                if summary is not None and cached[2] is not None:
+                    summary.load(cached[2])
+                return cached[0], cached[1]
+        
+        # Drop rules the source text rules out, and the parse if none are left
+        rules_to_run = enabled_rules
+        if self.prefilter is not None:
+            prefilter_start = time.perf_counter()
+            runnable, skipped, scanned = self.prefilter.select(
+                file_path, self.rule_engine.registry.get_enabled_rules(enabled_rules),
+                args, self.ast_parser.precompiled_headers
+            )
+            profile["prefilter_seconds"] = time.perf_counter() - prefilter_start
+            if skipped:
+                profile["prefiltered_rules"] = [rule.metadata.id for rule in skipped]
+                if not runnable:
+                    profile["prefiltered"] = True
+                    if summary is not None:
+                        summary.includes = scanned[1:]
+                    return [], scanned[1:]
+                rules_to_run = [rule.metadata.id for rule in runnable]
+        
         # Parse the file
+        parse_start = time.perf_counter()
         translation_unit = self.ast_parser.parse_file(file_path)
+        profile["parse_seconds"] = time.perf_counter() - parse_start
         if translation_unit is None:
             print(f"Warning: Failed to parse {file_path}")
-            return []
+            return [], []
         
         # Run static analysis
         violations = self.rule_engine.analyze_translation_unit(
-            translation_unit, enabled_rules
+            translation_unit, rules_to_run, profile, summary
         )
+        included_files = ASTParser.get_included_files(translation_unit)
+        if summary is not None:
+            summary.includes = included_files
+        
+        # Only the TU cache may keep the unit; memory-bounded runs free it now
+        translation_unit = None
+        if self.config.is_memory_bounded():
+            gc.collect()
+        
+        if result_cache:
+            result_cache.store(
+                file_path,
+                fingerprint,
+                included_files + self.ast_parser.get_precompiled_dependencies(),
+                violations,
+                summary.to_dict() if summary is not None else None
+            )
         
-        return violations
+        return violations, included_files
+    
+    def get_result_cache(self) -> Optional[ResultCache]:
+        """Get the result cache, if one is configured.
+        
+        Returns:
+            ResultCache instance or None when caching is disabled
+        """
+        cache_dir = self.config.get_cache_dir()
+        if not cache_dir:
+            return None
+        if self._result_cache is None or str(self._result_cache.cache_dir) != str(Path(cache_dir)):
+            self._result_cache = ResultCache(cache_dir)
+        return self._result_cache
+    
+    def clear_result_cache(self) -> None:
+        """Remove all entries from the configured result cache."""
+        result_cache = self.get_result_cache()
+        if result_cache:
+            result_cache.clear()
+    
+    def _get_cache_fingerprint(self, enabled_rules: List[str], args: List[str],
+                               whole_program: bool = False) -> str:
+        """Get the cache fingerprint for a rule set and parse arguments."""
+        key = tuple(enabled_rules) + ("\0", str(whole_program)) + tuple(args)
+        if key not in self._cache_fingerprints:
+            self._cache_fingerprints[key] = ResultCache.compute_fingerprint(
+                enabled_rules,
+                self.ast_parser.include_paths,
+                __version__,
+                extra={"args": args, "walk_scope": self.rule_engine.walk_scope,
+                       "exclude_paths": self.rule_engine.exclude_patterns,
+                       "whole_program": whole_program}
+            )
+        return self._cache_fingerprints[key]
+    
+    @staticmethod
+    def _violation_key(violation: Violation) -> Tuple[Any, ...]:
+        """Identity of a violation for de-duplication across TUs."""
+        location = violation.location
+        return (violation.rule_id, location.file_path, location.line,
+                location.column, violation.message)
     
     def _filter_files(self, file_paths: List[str]) -> List[str]:
         """Filter files based on include/exclude patterns.
@@ -242,6 +927,10 @@ class StaticAnalyzer:
         
         return filtered_violations
     
+    def close(self) -> None:
+        """Release parsed units and remove the temporary PCH directory."""
+        self.ast_parser.close()
+    
     def get_available_rules(self) -> List[Dict[str, Any]]:
         """Get information about all available rules.
         
@@ -259,7 +948,7 @@ class StaticAnalyzer:
         issues = []
         
         # Check enabled rules exist
-        enabled_rules = self.config.get_enabled_rules()
+        enabled_rules = self.rule_engine.registry.expand_rule_ids(self.config.get_enabled_rules())
         available_rules = set(self.rule_engine.registry.list_rule_ids())
         
         for rule_id in enabled_rules:
@@ -271,6 +960,14 @@ class StaticAnalyzer:
             if not os.path.exists(include_path):
                 issues.append(f"Include path not found: {include_path}")
         
+        if self.config.get_walk_scope() not in WalkScope.CHOICES:
+            issues.append(f"Unknown walk_scope: {self.config.get_walk_scope()}")
+        
+        try:
+            self.get_shard()
+        except ValueError as e:
+            issues.append(str(e))
+        
         # Check AI configuration if enabled
         if self.config.is_ai_enabled():
             ai_config = self.config.get_ai_config()
@@ -281,6 +978,56 @@ class StaticAnalyzer:
         return issues
 
 
+# Per-process analyzer used by parallel analysis workers
+_worker_analyzer: Optional[StaticAnalyzer] = None
+
+
+def _init_worker(config_dict: Dict[str, Any]) -> None:
+    """Build the analyzer for a worker process.
+    
+    Args:
+        config_dict: Raw configuration dictionary from the parent analyzer
+    """
+    global _worker_analyzer
+    _worker_analyzer = StaticAnalyzer(AnalyzerConfig(config_dict))
+
+
+def _analyze_file_in_worker(file_path: str,
+                            enabled_rules: List[str],
+                            whole_program: bool = False) -> Tuple[List[Violation], Dict[str, Any]]:
+    """Analyze one file in a worker process.
+    
+    Args:
+        file_path: Path to source file
+        enabled_rules: List of rule IDs to run
+        whole_program: Summarize the unit for whole-program rules
+        
+    Returns:
+        Violations found in the file and the worker's counters for it
+    """
+    stats: Dict[str, Any] = {}
+    result_cache = _worker_analyzer.get_result_cache()
+    if result_cache:
+        hits, misses = result_cache.hits, result_cache.misses
+    
+    file_profile: Dict[str, Any] = {}
+    summary = TranslationUnitSummary(file_path) if whole_program else None
+    violations, included_files = _worker_analyzer._analyze_file(
+        file_path, enabled_rules, file_profile, summary
+    )
+    stats["includes"] = included_files
+    stats["profile"] = file_profile
+    if summary is not None:
+        stats["summary"] = summary
+    
+    if result_cache:
+        stats["cache"] = {
+            "hits": result_cache.hits - hits,
+            "misses": result_cache.misses - misses
+        }
+    return violations, stats
+
+
 def create_analyzer_from_config_file(config_file: str, 
                                    deviations_file: Optional[str] = None) -> StaticAnalyzer:
     """Create analyzer from configuration file.
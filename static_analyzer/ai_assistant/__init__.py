@@ -1,12 +1,35 @@
 """AI Assistant for providing explanations and suggestions."""
 
+import asyncio
+import dataclasses
+import json
 import os
-from typing import Optional, Dict, Any, List
+import random
+from concurrent.futures import ThreadPoolExecutor
+from typing import Optional, Dict, Any, List, Tuple
 from ..models import Violation
+from ..cache import ResponseCache
 
 
 class AIAssistant:
-    """AI assistant for generating explanations and fix suggestions."""
+    """AI assistant for generating explanations and fix suggestions.
+    
+    Each distinct violation gets one structured request that returns the
+    explanation, risk summary and fix together. Violations of the same rule
+    on the same (whitespace-normalized) code share a request, and requests
+    run concurrently up to the configured limit with rate-limit-aware
+    retries.
+    """
+    
+    # Status codes worth retrying: rate limits and transient server errors
+    RETRYABLE_STATUS = {408, 409, 429, 500, 502, 503, 504}
+    RETRYABLE_ERRORS = {"APIConnectionError", "APITimeoutError", "RateLimitError",
+                        "InternalServerError"}
+    
+    RESPONSE_FIELDS = ("explanation", "risk_summary", "suggested_fix")
+    
+    # Bump when _build_prompt changes so cached responses aren't reused
+    PROMPT_VERSION = 1
     
     def __init__(self, config: Dict[str, Any]):
         """Initialize AI assistant.
@@ -16,9 +39,23 @@ class AIAssistant:
         """
         self.config = config
         self.enabled = config.get("enabled", False)
+        self.concurrency = max(1, int(config.get("concurrency", 8)))
+        self.max_retries = max(0, int(config.get("max_retries", 5)))
+        self.retry_base_delay = float(config.get("retry_base_delay", 1.0))
+        self.response_cache: Optional[ResponseCache] = None
+        self._cache_writes = 0
         
         if self.enabled:
             self._initialize_client()
+        if self.enabled and config.get("response_cache", True):
+            cache_dir = config.get("response_cache_dir") or os.path.join(
+                os.path.expanduser("~"), ".cache", "static_analyzer", "ai_responses"
+            )
+            self.response_cache = ResponseCache(
+                cache_dir,
+                ttl_seconds=float(config.get("response_cache_ttl_days", 30)) * 86400,
+                max_entries=int(config.get("response_cache_max_entries", 10000))
+            )
     
     def _initialize_client(self) -> None:
         """Initialize OpenAI client if enabled."""
@@ -36,8 +73,9 @@ class AIAssistant:
                 self.enabled = False
                 return
             
-            self.client = openai.OpenAI(api_key=api_key)
-            
+            self._openai = openai
+            self._api_key = api_key
+        
         except ImportError:
             print("Warning: openai package not installed. AI assistant disabled.")
             self.enabled = False
@@ -45,127 +83,114 @@ class AIAssistant:
             print(f"Warning: Failed to initialize AI client: {str(e)}. AI assistant disabled.")
             self.enabled = False
     
+    def _create_client(self):
+        """Create an async client for one batch.
+        
+        The client's connection pool belongs to the event loop it is used
+        on, and every batch runs on its own loop, so clients aren't shared
+        between batches.
+        """
+        # Retries are handled here so they can honor Retry-After across the batch
+        return self._openai.AsyncOpenAI(api_key=self._api_key, max_retries=0)
+    
     def enhance_violations(self, violations: List[Violation]) -> List[Violation]:
         """Enhance violations with AI-generated explanations.
         
         Args:
             violations: List of violations to enhance
-            
+        
         Returns:
             List of enhanced violations
         """
-        if not self.enabled:
+        if not self.enabled or not violations:
             return violations
         
-        enhanced_violations = []
-        
-        for violation in violations:
-            try:
-                enhanced = self._enhance_single_violation(violation)
-                enhanced_violations.append(enhanced)
-            except Exception as e:
-                print(f"Warning: Failed to enhance violation {violation.rule_id}: {str(e)}")
-                enhanced_violations.append(violation)
+        try:
+            asyncio.get_running_loop()
+        except RuntimeError:
+            return asyncio.run(self.enhance_violations_async(violations))
         
-        return enhanced_violations
+        # Called from inside an event loop (e.g. the MCP server): use a private one
+        with ThreadPoolExecutor(max_workers=1) as executor:
+            return executor.submit(asyncio.run, self.enhance_violations_async(violations)).result()
     
-    def _enhance_single_violation(self, violation: Violation) -> Violation:
-        """Enhance a single violation with AI explanations.
+    async def enhance_violations_async(self, violations: List[Violation]) -> List[Violation]:
+        """Enhance violations concurrently, one request per distinct violation.
         
         Args:
-            violation: Violation to enhance
-            
+            violations: List of violations to enhance
+        
         Returns:
-            Enhanced violation
+            List of enhanced violations, in the input order
         """
-        if not self.enabled:
-            return violation
+        if not self.enabled or not violations:
+            return violations
         
-        # Generate AI explanation
-        explanation = self._generate_explanation(violation)
-        risk_summary = self._generate_risk_summary(violation)
-        suggested_fix = self._generate_fix_suggestion(violation)
+        groups: Dict[Tuple[str, str], List[int]] = {}
+        for index, violation in enumerate(violations):
+            groups.setdefault(self._group_key(violation), []).append(index)
         
-        # Create enhanced violation (since Violation is frozen, create new one)
-        enhanced_violation = Violation(
-            rule_id=violation.rule_id,
-            standard=violation.standard,
-            location=violation.location,
-            message=violation.message,
-            severity=violation.severity,
-            confidence=violation.confidence,
-            source_context=violation.source_context,
-            metadata=violation.metadata,
-            ai_explanation=explanation,
-            ai_risk_summary=risk_summary,
-            ai_suggested_fix=suggested_fix
-        )
+        semaphore = asyncio.Semaphore(self.concurrency)
+        keys = list(groups)
+        async with self._create_client() as client:
+            responses = await asyncio.gather(*[
+                self._enhance_group(client, violations[groups[key][0]], key, semaphore)
+                for key in keys
+            ])
+        if self.response_cache and self._cache_writes:
+            self.response_cache.prune()
+            self._cache_writes = 0
         
-        return enhanced_violation
+        enhanced_violations = list(violations)
+        for key, fields in zip(keys, responses):
+            if fields is None:
+                continue
+            for index in groups[key]:
+                enhanced_violations[index] = dataclasses.replace(
+                    violations[index],
+                    ai_explanation=fields.get("explanation"),
+                    ai_risk_summary=fields.get("risk_summary"),
+                    ai_suggested_fix=fields.get("suggested_fix")
+                )
+        return enhanced_violations
     
-    def _generate_explanation(self, violation: Violation) -> Optional[str]:
-        """Generate human-readable explanation for a violation.
+    async def _enhance_group(self, client, violation: Violation, group_key: Tuple[str, str],
+                             semaphore: asyncio.Semaphore) -> Optional[Dict[str, Optional[str]]]:
+        """Get the AI fields for a group's representative violation.
         
-        Args:
-            violation: Violation to explain
-            
-        Returns:
-            AI-generated explanation
+        The response cache is checked first; only structured replies are
+        stored, since a free-text reply may be truncated.
         """
-        prompt = self._build_explanation_prompt(violation)
-        return self._call_ai(prompt, "explanation")
-    
-    def _generate_risk_summary(self, violation: Violation) -> Optional[str]:
-        """Generate risk summary for a violation.
+        cache_key = None
+        if self.response_cache:
+            cache_key = ResponseCache.compute_key(
+                group_key[0], self.config.get("model", "gpt-4"), self.PROMPT_VERSION, group_key[1]
+            )
+            cached = self.response_cache.get(cache_key)
+            if cached is not None:
+                return cached
         
-        Args:
-            violation: Violation to analyze
-            
-        Returns:
-            AI-generated risk summary
-        """
-        prompt = self._build_risk_prompt(violation)
-        return self._call_ai(prompt, "risk_summary")
-    
-    def _generate_fix_suggestion(self, violation: Violation) -> Optional[str]:
-        """Generate fix suggestion for a violation.
+        async with semaphore:
+            content = await self._call_ai(client, self._build_prompt(violation), violation.rule_id)
+        if content is None:
+            return None
         
-        Args:
-            violation: Violation to fix
-            
-        Returns:
-            AI-generated fix suggestion
-        """
-        prompt = self._build_fix_prompt(violation)
-        return self._call_ai(prompt, "fix_suggestion")
+        fields = self._parse_response(content)
+        if cache_key and (fields["risk_summary"] is not None or fields["suggested_fix"] is not None):
+            self.response_cache.put(cache_key, fields)
+            self._cache_writes += 1
+        return fields
     
-    def _build_explanation_prompt(self, violation: Violation) -> str:
-        """Build prompt for explanation generation."""
-        return f"""
-You are a senior embedded systems engineer explaining static analysis violations to developers.
-
-VIOLATION DETAILS:
-- Rule: {violation.rule_id}
-- Standard: {violation.standard.value}
-- Location: {violation.location}
-- Message: {violation.message}
-- Severity: {violation.severity.value}
-
-SOURCE CODE:
-{violation.source_context or "Source context not available"}
-
-TASK: Provide a clear, concise explanation of why this violation matters for embedded C/C++ development. Focus on:
-1. What the rule is trying to prevent
-2. Why it's important for embedded systems
-3. Potential consequences if ignored
-
-Keep the explanation under 150 words and suitable for intermediate developers.
-"""
+    @staticmethod
+    def _group_key(violation: Violation) -> Tuple[str, str]:
+        """Violations with the same rule and code get the same answer."""
+        snippet = violation.source_context or violation.message
+        return violation.rule_id, " ".join(snippet.split())
     
-    def _build_risk_prompt(self, violation: Violation) -> str:
-        """Build prompt for risk analysis."""
+    def _build_prompt(self, violation: Violation) -> str:
+        """Build one prompt asking for explanation, risk and fix together."""
         return f"""
-You are a safety-critical systems expert analyzing code risks.
+You are a senior embedded systems engineer explaining static analysis violations to developers.
 
 VIOLATION DETAILS:
 - Rule: {violation.rule_id}
@@ -177,70 +202,99 @@ VIOLATION DETAILS:
 SOURCE CODE:
 {violation.source_context or "Source context not available"}
 
-TASK: Provide a risk assessment focusing on:
-1. Potential runtime failures
-2. Security implications
-3. Safety concerns for automotive/embedded systems
-4. Impact on system reliability
+TASK: Reply with a JSON object with exactly these string fields:
+- "explanation": why this violation matters for embedded C/C++ development: what the rule
+  prevents, why it is important for embedded systems and the consequences if ignored
+  (under 150 words, suitable for intermediate developers)
+- "risk_summary": potential runtime failures, security implications, safety concerns for
+  automotive/embedded systems and impact on reliability (under 100 words)
+- "suggested_fix": a corrected code snippet, a brief explanation of the change and any
+  additional considerations; prefer minimal, safe changes (under 200 words)
 
-Provide a concise risk summary under 100 words.
+Reply with the JSON object only.
 """
-    
-    def _build_fix_prompt(self, violation: Violation) -> str:
-        """Build prompt for fix suggestions."""
-        return f"""
-You are an expert C/C++ developer providing code fix suggestions.
 
-VIOLATION DETAILS:
-- Rule: {violation.rule_id}
-- Standard: {violation.standard.value}
-- Location: {violation.location}
-- Message: {violation.message}
-
-SOURCE CODE:
-{violation.source_context or "Source context not available"}
-
-TASK: Suggest specific code changes to fix this violation. Provide:
-1. Corrected code snippet
-2. Brief explanation of the change
-3. Any additional considerations
-
-Focus on minimal, safe changes that address the violation while maintaining functionality.
-Keep suggestions under 200 words.
-"""
+    def _parse_response(self, content: str) -> Dict[str, Optional[str]]:
+        """Extract the AI fields from a structured reply.
+        
+        Args:
+            content: Model reply, ideally a JSON object
+        
+        Returns:
+            Mapping of field name to text; an unparseable reply becomes
+            the explanation
+        """
+        text = content.strip()
+        if text.startswith("```"):
+            text = text.strip("`")
+            if text.lower().startswith("json"):
+                text = text[4:]
+        start, end = text.find("{"), text.rfind("}")
+        try:
+            data = json.loads(text[start:end + 1]) if start != -1 else None
+        except ValueError:
+            data = None
+        
+        if not isinstance(data, dict):
+            return {"explanation": content.strip(), "risk_summary": None, "suggested_fix": None}
+        return {field: (str(data[field]) if data.get(field) is not None else None)
+                for field in self.RESPONSE_FIELDS}
     
-    def _call_ai(self, prompt: str, request_type: str) -> Optional[str]:
-        """Make AI API call.
+    async def _call_ai(self, client, prompt: str, request_type: str) -> Optional[str]:
+        """Make AI API call, retrying rate limits and transient failures.
         
         Args:
+            client: The batch's async OpenAI client
             prompt: Prompt text
             request_type: Type of request for logging
-            
+        
         Returns:
             AI response text
         """
         if not self.enabled:
             return None
         
-        try:
-            response = self.client.chat.completions.create(
-                model=self.config.get("model", "gpt-4"),
-                messages=[
-                    {
-                        "role": "system", 
-                        "content": "You are an expert in embedded systems and static code analysis."
-                    },
-                    {"role": "user", "content": prompt}
-                ],
-                max_tokens=self.config.get("max_tokens", 500),
-                temperature=self.config.get("temperature", 0.1)
-            )
-            
-            return response.choices[0].message.content
+        for attempt in range(self.max_retries + 1):
+            try:
+                response = await client.chat.completions.create(
+                    model=self.config.get("model", "gpt-4"),
+                    messages=[
+                        {
+                            "role": "system",
+                            "content": "You are an expert in embedded systems and static code analysis."
+                        },
+                        {"role": "user", "content": prompt}
+                    ],
+                    max_tokens=self.config.get("max_tokens", 1000),
+                    temperature=self.config.get("temperature", 0.1)
+                )
+                
+                return response.choices[0].message.content
             
-        except Exception as e:
-            print(f"Warning: AI call failed for {request_type}: {str(e)}")
-            return None
+            except Exception as e:
+                if attempt < self.max_retries and self._is_retryable(e):
+                    await asyncio.sleep(self._retry_delay(e, attempt))
+                    continue
+                print(f"Warning: AI call failed for {request_type}: {str(e)}")
+                return None
+        return None
+    
+    def _is_retryable(self, error: Exception) -> bool:
+        status = getattr(error, "status_code", None)
+        return status in self.RETRYABLE_STATUS or type(error).__name__ in self.RETRYABLE_ERRORS
+    
+    def _retry_delay(self, error: Exception, attempt: int) -> float:
+        """Seconds to wait before retrying: Retry-After if sent, else jittered backoff."""
+        response = getattr(error, "response", None)
+        headers = getattr(response, "headers", None) or {}
+        retry_after = headers.get("retry-after")
+        if retry_after:
+            try:
+                return max(0.0, float(retry_after))
+            except ValueError:
+                pass
+        delay = self.retry_base_delay * (2 ** attempt)
+        return delay / 2 + random.uniform(0, delay / 2)
 
 
 class MockAIAssistant:
@@ -1,10 +1,21 @@
 """AST utilities for parsing C/C++ source code using libclang."""
 
-from typing import Optional, List, Iterator, Tuple, Any
+from typing import Optional, List, Iterator, Tuple, Any, Dict, Set, NamedTuple, Callable
 import os
+import fnmatch
+import json
+import hashlib
+import shutil
+import tempfile
+import threading
+import weakref
+from bisect import bisect_right
+from collections import OrderedDict
 from pathlib import Path
 from clang.cindex import (
     Index, 
+    CompilationDatabase,
+    CompilationDatabaseError,
     TranslationUnit, 
     Cursor, 
     CursorKind, 
@@ -15,17 +26,168 @@ from clang.cindex import (
 from ..models import SourceLocation
 
 
+CPP_EXTENSIONS = ('.cpp', '.cc', '.cxx', '.hpp', '.hh', '.hxx')
+
+# Cursor kinds that open a function body
+FUNCTION_KINDS = frozenset([
+    CursorKind.FUNCTION_DECL,
+    CursorKind.CXX_METHOD,
+    CursorKind.CONSTRUCTOR,
+    CursorKind.DESTRUCTOR,
+    CursorKind.CONVERSION_FUNCTION,
+    CursorKind.FUNCTION_TEMPLATE
+])
+
+
+class CompileCommandsDatabase:
+    """Per-file compiler arguments from a compile_commands.json."""
+    
+    # Driver options that don't affect parsing, with and without a value
+    _SKIPPED_OPTIONS_WITH_VALUE = {'-o', '-MF', '-MT', '-MQ', '-MJ', '--serialize-diagnostics'}
+    _SKIPPED_OPTIONS = {'-c', '-S', '-E', '-M', '-MM', '-MD', '-MMD', '-MP', '-MG'}
+    
+    def __init__(self, path: str):
+        """Load a compilation database.
+        
+        Args:
+            path: compile_commands.json file or the directory containing it
+            
+        Raises:
+            FileNotFoundError: If no database can be loaded from path
+        """
+        directory = path if os.path.isdir(path) else os.path.dirname(os.path.abspath(path))
+        self.path = os.path.join(os.path.abspath(directory), 'compile_commands.json')
+        
+        try:
+            self._database = CompilationDatabase.fromDirectory(directory)
+        except CompilationDatabaseError:
+            raise FileNotFoundError(f"Compilation database not found: {path}")
+        
+        # First command wins for files compiled more than once
+        self._arguments: Dict[str, List[str]] = {}
+        for command in self._database.getAllCompileCommands() or []:
+            file_path = os.path.normpath(os.path.join(command.directory, command.filename))
+            if file_path not in self._arguments:
+                self._arguments[file_path] = self.sanitize_arguments(
+                    list(command.arguments), file_path, command.directory
+                )
+    
+    def get_source_files(self) -> List[str]:
+        """Get every translation unit in the database.
+        
+        Returns:
+            Sorted list of absolute source file paths
+        """
+        return sorted(self._arguments)
+    
+    def get_arguments(self, file_path: str) -> Optional[List[str]]:
+        """Get the parse arguments recorded for a file.
+        
+        Args:
+            file_path: Source file path
+            
+        Returns:
+            Argument list, or None if the file isn't in the database
+        """
+        return self._arguments.get(os.path.normpath(os.path.abspath(file_path)))
+    
+    @classmethod
+    def sanitize_arguments(cls,
+                           arguments: List[str],
+                           file_path: str,
+                           directory: str) -> List[str]:
+        """Turn a recorded compiler command line into libclang parse arguments.
+        
+        Drops the compiler itself, the source file and output/dependency
+        options, and pins relative paths to the command's directory.
+        
+        Args:
+            arguments: Full command line including the compiler
+            file_path: Absolute path of the compiled source file
+            directory: Working directory of the command
+            
+        Returns:
+            Arguments suitable for Index.parse
+        """
+        result = ['-working-directory', directory]
+        skip_next = False
+        
+        for arg in arguments[1:]:
+            if skip_next:
+                skip_next = False
+                continue
+            if arg in cls._SKIPPED_OPTIONS_WITH_VALUE:
+                skip_next = True
+                continue
+            if arg in cls._SKIPPED_OPTIONS or arg.startswith('-o'):
+                continue
+            if (not arg.startswith('-') and
+                    os.path.normpath(os.path.join(directory, arg)) == file_path):
+                continue
+            result.append(arg)
+        
+        return result
+
+
 class ASTParser:
     """Clang AST parser for C/C++ source files."""
     
-    def __init__(self, include_paths: Optional[List[str]] = None):
+    # Arguments used for files not covered by a compilation database
+    DEFAULT_ARGS = [
+        '-std=c99',
+        '-Wall',
+        '-Wextra',
+        '-fno-builtin',
+        '-nostdlib'
+    ]
+    DEFAULT_CPP_ARGS = [
+        '-std=c++17',
+        '-Wall',
+        '-Wextra',
+        '-fno-builtin',
+        '-nostdlib'
+    ]
+    
+    # Cached units keep a precompiled preamble so reparses skip the headers
+    CACHED_PARSE_OPTIONS = (TranslationUnit.PARSE_DETAILED_PROCESSING_RECORD
+                            | TranslationUnit.PARSE_PRECOMPILED_PREAMBLE)
+    
+    def __init__(self,
+                 include_paths: Optional[List[str]] = None,
+                 precompiled_headers: Optional[List[str]] = None,
+                 pch_dir: Optional[str] = None,
+                 compile_commands: Optional[CompileCommandsDatabase] = None,
+                 tu_cache_size: int = 0):
         """Initialize the AST parser.
         
         Args:
             include_paths: Additional include directories for compilation
+            precompiled_headers: Headers shared by most translation units. When
+                set they are compiled once into a PCH that each parse reuses.
+            pch_dir: Directory for generated PCH files (default: a temporary
+                directory owned by this parser and removed by close())
+            compile_commands: Compilation database supplying each file's real
+                flags in place of the defaults
+            tu_cache_size: Number of recently parsed translation units kept
+                in memory and reparsed when their files change (0 disables).
+                Worth enabling only in long-lived processes.
         """
         self.index = Index.create()
         self.include_paths = include_paths or []
+        self.compile_commands = compile_commands
+        self.precompiled_headers = [os.path.abspath(h) for h in (precompiled_headers or [])]
+        self.pch_dir = pch_dir
+        # Removes the temporary PCH directory on close() or, failing that, at exit
+        self._pch_dir_cleanup: Optional[weakref.finalize] = None
+        # PCH path and the files it was built from, keyed by argument signature
+        self._pch_entries: Dict[str, Tuple[str, Dict[str, int]]] = {}
+        self._pch_failed: Set[str] = set()
+        # Translation unit and the (mtime_ns, size) of every file it was
+        # parsed from, keyed by file path and arguments, oldest first
+        self.tu_cache_size = tu_cache_size
+        self._tu_cache: "OrderedDict[Tuple[str, ...], Tuple[TranslationUnit, Dict[str, Tuple[int, int]]]]" = OrderedDict()
+        self.tu_cache_hits = 0
+        self.tu_cache_reparses = 0
         
     def parse_file(self, file_path: str, 
                    additional_args: Optional[List[str]] = None) -> Optional[TranslationUnit]:
@@ -41,73 +203,551 @@ class ASTParser:
         if not os.path.exists(file_path):
             raise FileNotFoundError(f"Source file not found: {file_path}")
             
+        args = self.get_arguments(file_path, additional_args)
+        if self.tu_cache_size > 0:
+            return self._parse_cached(file_path, args)
+        return self._parse_uncached(file_path, args)
+    
+    def _parse_uncached(self, file_path: str, args: List[str],
+                        options: int = TranslationUnit.PARSE_DETAILED_PROCESSING_RECORD
+                        ) -> Optional[TranslationUnit]:
+        """Parse a file, against the PCH when one is configured."""
+        pch_path = self.get_precompiled_header(args, file_path.endswith(CPP_EXTENSIONS))
+        if pch_path:
+            translation_unit = self._parse_with_pch(file_path, args, pch_path, options)
+            if translation_unit is not None:
+                return translation_unit
+            
+        return self._parse(file_path, args, options)
+    
+    def _parse_cached(self, file_path: str, args: List[str]) -> Optional[TranslationUnit]:
+        """Parse a file through the translation unit cache.
+        
+        An unchanged file returns its cached unit as is. When the file or
+        anything it includes changed, the cached unit is reparsed in place,
+        which reuses its precompiled preamble instead of re-reading every
+        header.
+        """
+        key = (os.path.abspath(file_path),) + tuple(args)
+        entry = self._tu_cache.get(key)
+        if entry is not None:
+            translation_unit, stamps = entry
+            self._tu_cache.move_to_end(key)
+            if self._stamps_current(stamps):
+                self.tu_cache_hits += 1
+                return translation_unit
+            try:
+                translation_unit.reparse(options=self.CACHED_PARSE_OPTIONS)
+                self.tu_cache_reparses += 1
+                self._report_parse_errors(translation_unit, file_path)
+                self._tu_cache[key] = (translation_unit, self._file_stamps(key[0], translation_unit))
+                return translation_unit
+            except Exception:
+                # Fall back to a fresh parse below
+                del self._tu_cache[key]
+        
+        translation_unit = self._parse_uncached(file_path, args, self.CACHED_PARSE_OPTIONS)
+        if translation_unit is None:
+            return None
+        
+        self._tu_cache[key] = (translation_unit, self._file_stamps(key[0], translation_unit))
+        while len(self._tu_cache) > self.tu_cache_size:
+            self._tu_cache.popitem(last=False)
+        return translation_unit
+    
+    def clear_tu_cache(self) -> None:
+        """Drop every cached translation unit."""
+        self._tu_cache.clear()
+    
+    def close(self) -> None:
+        """Drop cached units and remove the temporary PCH directory, if any.
+        
+        A pch_dir passed in by the caller is left alone.
+        """
+        self._tu_cache.clear()
+        self._pch_entries.clear()
+        if self._pch_dir_cleanup is not None:
+            self._pch_dir_cleanup()
+            self._pch_dir_cleanup = None
+            self.pch_dir = None
+    
+    def get_tu_cache_stats(self) -> Dict[str, int]:
+        """Get translation unit cache size and counters."""
+        return {
+            "entries": len(self._tu_cache),
+            "max_entries": self.tu_cache_size,
+            "hits": self.tu_cache_hits,
+            "reparses": self.tu_cache_reparses
+        }
+    
+    def _file_stamps(self, file_path: str,
+                     translation_unit: TranslationUnit) -> Dict[str, Tuple[int, int]]:
+        """Record the modification time and size of a unit's files."""
+        stamps = {}
+        for dependency in [file_path] + self.get_included_files(translation_unit):
+            try:
+                stat = os.stat(dependency)
+            except OSError:
+                continue
+            stamps[dependency] = (stat.st_mtime_ns, stat.st_size)
+        return stamps
+    
+    @staticmethod
+    def _stamps_current(stamps: Dict[str, Tuple[int, int]]) -> bool:
+        """Check that no file recorded by _file_stamps has changed."""
+        for dependency, (mtime_ns, size) in stamps.items():
+            try:
+                stat = os.stat(dependency)
+            except OSError:
+                return False
+            if stat.st_mtime_ns != mtime_ns or stat.st_size != size:
+                return False
+        return True
+    
+    def get_precompiled_header(self,
+                               args: Optional[List[str]] = None,
+                               cpp: bool = False) -> Optional[str]:
+        """Get (building if needed) the PCH for the configured common headers.
+        
+        A PCH is only valid for the flags it was compiled with, so one is
+        kept per argument signature. It is rebuilt when any file it was
+        built from changes on disk.
+        
+        Args:
+            args: Full clang arguments the PCH must match (default: the
+                arguments parse_file would use for a C file)
+            cpp: Whether the PCH is for C++ translation units
+            
+        Returns:
+            Path to the PCH file, or None if no headers are configured or the
+            PCH could not be built
+        """
+        if not self.precompiled_headers:
+            return None
+        
+        if args is None:
+            args = self._build_args(self.DEFAULT_ARGS)
+        cpp = cpp or self._is_cpp(args)
+        
+        signature = hashlib.sha256(
+            "\0".join([str(cpp)] + args + self.precompiled_headers).encode('utf-8')
+        ).hexdigest()[:16]
+        
+        if signature in self._pch_failed:
+            return None
+        
+        entry = self._pch_entries.get(signature) or self._load_precompiled_header(signature)
+        if entry and self._pch_is_current(entry[1]):
+            self._pch_entries[signature] = entry
+            return entry[0]
+        
+        built = self._build_precompiled_header(signature, args, cpp)
+        if built is None:
+            self._pch_failed.add(signature)
+            return None
+        
+        self._pch_entries[signature] = built
+        return built[0]
+    
+    def get_precompiled_dependencies(self) -> List[str]:
+        """Get every file compiled into the PCHs built by this parser.
+        
+        Translation units parsed against a PCH do not report these files in
+        their own inclusion list, so callers tracking dependencies should
+        add them.
+        
+        Returns:
+            Sorted list of file paths
+        """
+        dependencies = set()
+        for _, entry_files in self._pch_entries.values():
+            dependencies.update(entry_files)
+        return sorted(dependencies)
+    
+    def get_arguments(self,
+                      file_path: str,
+                      additional_args: Optional[List[str]] = None) -> List[str]:
+        """Get the clang arguments a file will be parsed with.
+        
+        Args:
+            file_path: Path to the source file
+            additional_args: Additional clang arguments
+            
+        Returns:
+            Full argument list
+        """
+        base_args = None
+        if self.compile_commands:
+            base_args = self.compile_commands.get_arguments(file_path)
+        if base_args is None:
+            if file_path.endswith(CPP_EXTENSIONS):
+                base_args = self.DEFAULT_CPP_ARGS
+            else:
+                base_args = self.DEFAULT_ARGS
+        
+        return self._build_args(base_args, additional_args)
+    
+    def _build_args(self,
+                    base_args: List[str],
+                    additional_args: Optional[List[str]] = None) -> List[str]:
+        """Build the clang argument list for a parse."""
         args = []
         
         # Add include paths
         for include_path in self.include_paths:
             args.extend(['-I', include_path])
             
-        # Add standard arguments for embedded C
-        args.extend([
-            '-std=c99',
-            '-Wall',
-            '-Wextra',
-            '-fno-builtin',
-            '-nostdlib'
-        ])
+        # Add the file's compile flags, or the embedded C/C++ defaults
+        args.extend(base_args)
         
         # Add any additional arguments
         if additional_args:
             args.extend(additional_args)
-            
+        
+        return args
+    
+    def _parse(self, file_path: str, args: List[str],
+               options: int = TranslationUnit.PARSE_DETAILED_PROCESSING_RECORD
+               ) -> Optional[TranslationUnit]:
+        """Parse a file with the given arguments and report severe errors."""
         try:
             translation_unit = self.index.parse(
                 file_path,
                 args=args,
-                options=TranslationUnit.PARSE_DETAILED_PROCESSING_RECORD
+                options=options
             )
             
             # Check for parsing errors
             if translation_unit is None:
                 return None
                 
-            diagnostics = list(translation_unit.diagnostics)
-            severe_errors = [d for d in diagnostics if d.severity >= 3]  # Error or Fatal
-            
-            if severe_errors:
-                print(f"Warning: {len(severe_errors)} parsing errors in {file_path}")
-                for diag in severe_errors[:5]:  # Show first 5 errors
-                    print(f"  {diag.location.file}:{diag.location.line}: {diag.spelling}")
-                    
+            self._report_parse_errors(translation_unit, file_path)
             return translation_unit
             
         except Exception as e:
             print(f"Failed to parse {file_path}: {str(e)}")
             return None
+    
+    def _parse_with_pch(self,
+                        file_path: str,
+                        args: List[str],
+                        pch_path: str,
+                        options: int = TranslationUnit.PARSE_DETAILED_PROCESSING_RECORD
+                        ) -> Optional[TranslationUnit]:
+        """Parse a file against a PCH.
+        
+        Returns:
+            TranslationUnit, or None if clang rejected the PCH and the caller
+            should parse without it
+        """
+        try:
+            translation_unit = self.index.parse(
+                file_path,
+                args=args + ['-include-pch', pch_path],
+                options=options
+            )
+        except Exception:
+            return None
+        
+        if translation_unit is None:
+            return None
+        
+        # A stale or incompatible PCH shows up as a fatal diagnostic
+        if any(d.severity >= 4 for d in translation_unit.diagnostics):
+            return None
+        
+        self._report_parse_errors(translation_unit, file_path)
+        return translation_unit
+    
+    @staticmethod
+    def _report_parse_errors(translation_unit: TranslationUnit, file_path: str) -> None:
+        """Print the first few severe diagnostics of a parse."""
+        diagnostics = list(translation_unit.diagnostics)
+        severe_errors = [d for d in diagnostics if d.severity >= 3]  # Error or Fatal
+        
+        if severe_errors:
+            print(f"Warning: {len(severe_errors)} parsing errors in {file_path}")
+            for diag in severe_errors[:5]:  # Show first 5 errors
+                print(f"  {diag.location.file}:{diag.location.line}: {diag.spelling}")
+    
+    def _build_precompiled_header(self,
+                                  signature: str,
+                                  args: List[str],
+                                  cpp: bool) -> Optional[Tuple[str, Dict[str, int]]]:
+        """Compile the common headers into a PCH.
+        
+        Returns:
+            (pch_path, {dependency: mtime_ns}) or None on failure
+        """
+        if self.pch_dir is None:
+            self.pch_dir = tempfile.mkdtemp(prefix="static_analyzer_pch_")
+            self._pch_dir_cleanup = weakref.finalize(self, shutil.rmtree, self.pch_dir, True)
+        os.makedirs(self.pch_dir, exist_ok=True)
+        
+        prefix_path = os.path.join(self.pch_dir, f"common_{signature}.h")
+        pch_path = os.path.join(self.pch_dir, f"common_{signature}.pch")
+        
+        with open(prefix_path, 'w', encoding='utf-8') as f:
+            for header in self.precompiled_headers:
+                f.write(f'#include "{header}"\n')
+        
+        language = 'c++-header' if cpp else 'c-header'
+        try:
+            translation_unit = self.index.parse(
+                prefix_path,
+                args=args + ['-x', language],
+                options=TranslationUnit.PARSE_INCOMPLETE
+            )
+            severe_errors = [d for d in translation_unit.diagnostics if d.severity >= 3]
+            if severe_errors:
+                print(f"Warning: Not using precompiled headers, "
+                      f"{len(severe_errors)} errors while compiling them")
+                return None
+            
+            # Write-then-rename so parallel workers never load a partial PCH
+            tmp_path = f"{pch_path}.{os.getpid()}.tmp"
+            translation_unit.save(tmp_path)
+            os.replace(tmp_path, pch_path)
+        except Exception as e:
+            print(f"Warning: Failed to build precompiled header: {str(e)}")
+            return None
+        
+        dependencies = {}
+        for dependency in self.precompiled_headers + self.get_included_files(translation_unit):
+            try:
+                dependencies[dependency] = os.stat(dependency).st_mtime_ns
+            except OSError:
+                continue
+        
+        # Record what the PCH was built from so other processes can reuse it
+        sidecar_path = os.path.join(self.pch_dir, f"common_{signature}.json")
+        tmp_path = f"{sidecar_path}.{os.getpid()}.tmp"
+        try:
+            with open(tmp_path, 'w', encoding='utf-8') as f:
+                json.dump({"pch": pch_path, "dependencies": dependencies}, f)
+            os.replace(tmp_path, sidecar_path)
+        except OSError:
+            pass
+        
+        return pch_path, dependencies
+    
+    def _load_precompiled_header(self, signature: str) -> Optional[Tuple[str, Dict[str, int]]]:
+        """Load a PCH built earlier, possibly by another process.
+        
+        Returns:
+            (pch_path, {dependency: mtime_ns}) or None if there is none
+        """
+        if self.pch_dir is None:
+            return None
+        
+        sidecar_path = os.path.join(self.pch_dir, f"common_{signature}.json")
+        try:
+            with open(sidecar_path, 'r', encoding='utf-8') as f:
+                sidecar = json.load(f)
+        except (OSError, ValueError):
+            return None
+        
+        if not os.path.exists(sidecar.get("pch", "")):
+            return None
+        return sidecar["pch"], sidecar.get("dependencies", {})
+    
+    @staticmethod
+    def _pch_is_current(dependencies: Dict[str, int]) -> bool:
+        """Check that no file compiled into a PCH has changed."""
+        for dependency, mtime_ns in dependencies.items():
+            try:
+                if os.stat(dependency).st_mtime_ns != mtime_ns:
+                    return False
+            except OSError:
+                return False
+        return True
+    
+    @staticmethod
+    def _is_cpp(args: List[str]) -> bool:
+        """Check whether arguments select a C++ dialect."""
+        for index, arg in enumerate(args):
+            if arg.startswith(('-std=c++', '-std=gnu++')):
+                return True
+            if arg == '-x' and index + 1 < len(args) and args[index + 1].startswith('c++'):
+                return True
+        return False
+    
+    @staticmethod
+    def get_included_files(translation_unit: TranslationUnit) -> List[str]:
+        """Get every file transitively included by a translation unit.
+        
+        Args:
+            translation_unit: Parsed translation unit
+            
+        Returns:
+            Sorted list of included file paths
+        """
+        included = set()
+        for inclusion in translation_unit.get_includes():
+            if inclusion.include:
+                included.add(inclusion.include.name)
+        return sorted(included)
+
+
+# Decides whether to skip a node (and its subtree) given the node and its depth
+PruneCallback = Callable[[Cursor, int], bool]
+
+
+class WalkScope:
+    """Which top-level declarations of a translation unit the rules visit.
+    
+    - ``all``: everything, including system headers
+    - ``project``: the main file and included headers, except system
+      headers and headers matching the configured exclude paths
+    - ``main_file``: only declarations written in the analyzed file
+    """
+    
+    ALL = "all"
+    PROJECT = "project"
+    MAIN_FILE = "main_file"
+    
+    CHOICES = (ALL, PROJECT, MAIN_FILE)
+    
+    def __init__(self,
+                 scope: str,
+                 main_file: str,
+                 exclude_patterns: Optional[List[str]] = None):
+        """Initialize the scope for one translation unit.
+        
+        Args:
+            scope: One of CHOICES
+            main_file: The translation unit's source file
+            exclude_patterns: fnmatch patterns of headers to skip
+        """
+        if scope not in self.CHOICES:
+            raise ValueError(f"Unknown walk scope: {scope}")
+        self.scope = scope
+        self.main_file = os.path.normpath(os.path.abspath(main_file))
+        self.exclude_patterns = exclude_patterns or []
+        # Decision per file name, since every declaration of a header agrees
+        self._skipped_files: Dict[str, bool] = {}
+        self.pruned = 0
+    
+    @classmethod
+    def prune_callback(cls,
+                       translation_unit: TranslationUnit,
+                       scope: str,
+                       exclude_patterns: Optional[List[str]] = None) -> Optional[PruneCallback]:
+        """Get the prune callback for walking a translation unit, or None for ``all``."""
+        if scope == cls.ALL:
+            return None
+        return cls(scope, translation_unit.spelling, exclude_patterns)
+    
+    def __call__(self, cursor: Cursor, depth: int) -> bool:
+        """Prune a top-level declaration located outside the scope.
+        
+        Only the translation unit's direct children are tested; nodes
+        below them share their declaration's file.
+        """
+        if depth != 1:
+            return False
+        location = cursor.location
+        file_obj = location.file
+        if file_obj is None:
+            return False
+        
+        name = file_obj.name
+        skipped = self._skipped_files.get(name)
+        if skipped is None:
+            skipped = self._skipped_files[name] = self._is_outside(name, location)
+        if skipped:
+            self.pruned += 1
+        return skipped
+    
+    def _is_outside(self, file_name: str, location: ClangSourceLocation) -> bool:
+        path = os.path.normpath(os.path.abspath(file_name))
+        if path == self.main_file:
+            return False
+        if self.scope == self.MAIN_FILE:
+            return True
+        if location.is_in_system_header:
+            return True
+        return any(fnmatch.fnmatch(path, pattern) or fnmatch.fnmatch(file_name, pattern)
+                   for pattern in self.exclude_patterns)
 
 
 class ASTTraverser:
     """Utility class for traversing Clang AST nodes."""
     
     @staticmethod
-    def walk_ast(cursor: Cursor, max_depth: Optional[int] = None) -> Iterator[Cursor]:
-        """Recursively walk through AST nodes.
+    def walk_ast(cursor: Cursor,
+                 max_depth: Optional[int] = None,
+                 prune: Optional[PruneCallback] = None) -> Iterator[Cursor]:
+        """Walk AST nodes in pre-order.
+        
+        Uses an explicit stack, so deeply nested code does not hit the
+        recursion limit.
         
         Args:
             cursor: Starting cursor
             max_depth: Maximum traversal depth
+            prune: Called with each node below the start and its depth
+                (1 for the start's children); returning True skips the
+                node and its whole subtree
             
         Yields:
             AST cursor nodes
         """
-        yield cursor
-        
-        if max_depth is not None and max_depth <= 0:
+        if max_depth is None and prune is None:
+            stack = [cursor]
+            while stack:
+                node = stack.pop()
+                yield node
+                children = list(node.get_children())
+                children.reverse()
+                stack.extend(children)
             return
+        
+        depth_stack: List[Tuple[Cursor, int]] = [(cursor, 0)]
+        while depth_stack:
+            node, depth = depth_stack.pop()
+            yield node
+            if max_depth is not None and depth >= max_depth:
+                continue
+            children = ASTTraverser._children(node, depth + 1, prune)
+            for child in reversed(children):
+                depth_stack.append((child, depth + 1))
+    
+    @staticmethod
+    def walk_with_enclosing_function(cursor: Cursor,
+                                     prune: Optional[PruneCallback] = None
+                                     ) -> Iterator[Tuple[Cursor, Optional[Cursor]]]:
+        """Walk AST nodes in pre-order along with their enclosing function.
+        
+        The enclosing function comes from the walk itself, so no
+        semantic_parent lookups are needed.
+        
+        Args:
+            cursor: Starting cursor
+            prune: Called with each node below the start and its depth;
+                returning True skips the node and its subtree (see walk_ast)
+            
+        Yields:
+            (node, enclosing function cursor or None) pairs
+        """
+        stack: List[Tuple[Cursor, Optional[Cursor], int]] = [(cursor, None, 0)]
+        while stack:
+            node, function, depth = stack.pop()
+            yield node, function
             
-        for child in cursor.get_children():
-            next_depth = max_depth - 1 if max_depth is not None else None
-            yield from ASTTraverser.walk_ast(child, next_depth)
+            if node.kind in FUNCTION_KINDS:
+                function = node
+            children = ASTTraverser._children(node, depth + 1, prune)
+            for child in reversed(children):
+                stack.append((child, function, depth + 1))
+    
+    @staticmethod
+    def _children(node: Cursor, depth: int, prune: Optional[PruneCallback]) -> List[Cursor]:
+        """Get a node's children at ``depth``, without the pruned ones."""
+        children = list(node.get_children())
+        if prune is None:
+            return children
+        return [child for child in children if not prune(child, depth)]
     
     @staticmethod
     def find_nodes_by_kind(cursor: Cursor, kind: CursorKind) -> Iterator[Cursor]:
@@ -150,6 +790,123 @@ class ASTTraverser:
         return None
 
 
+class SymbolReference(NamedTuple):
+    """A reference to a declaration and the function it occurs in."""
+    cursor: Cursor
+    function: Optional[Cursor]
+
+
+class SymbolIndex:
+    """Per-translation-unit index from declaration USR to its references.
+    
+    Built in one pass and shared by every rule that analyzes the unit. The
+    rule engine fills it during its own walk; otherwise the first call to
+    for_translation_unit builds it.
+    """
+    
+    REFERENCE_KINDS = frozenset([
+        CursorKind.DECL_REF_EXPR,
+        CursorKind.MEMBER_REF_EXPR
+    ])
+    
+    # Indexes attached to live translation units
+    _indexes: 'weakref.WeakKeyDictionary[Any, SymbolIndex]' = weakref.WeakKeyDictionary()
+    
+    def __init__(self):
+        """Initialize an empty index."""
+        self._references: Dict[str, List[SymbolReference]] = {}
+    
+    @classmethod
+    def build(cls, translation_unit: TranslationUnit) -> 'SymbolIndex':
+        """Build an index with a single walk of a translation unit.
+        
+        Args:
+            translation_unit: Translation unit to index
+            
+        Returns:
+            SymbolIndex for the unit
+        """
+        index = cls()
+        for cursor, function in ASTTraverser.walk_with_enclosing_function(translation_unit.cursor):
+            index.record(cursor, function)
+        return index
+    
+    @classmethod
+    def for_translation_unit(cls, translation_unit: TranslationUnit) -> 'SymbolIndex':
+        """Get the shared index for a translation unit, building it if needed.
+        
+        Args:
+            translation_unit: Translation unit being analyzed
+            
+        Returns:
+            SymbolIndex for the unit
+        """
+        index = cls._indexes.get(translation_unit)
+        if index is None:
+            index = cls.build(translation_unit)
+            cls._indexes[translation_unit] = index
+        return index
+    
+    @classmethod
+    def attach(cls, translation_unit: TranslationUnit, index: 'SymbolIndex') -> None:
+        """Share an index built elsewhere for a translation unit."""
+        cls._indexes[translation_unit] = index
+    
+    @classmethod
+    def release(cls, translation_unit: TranslationUnit) -> None:
+        """Drop the index for a translation unit.
+        
+        Indexed cursors keep their translation unit alive, so callers must
+        release the index once analysis of the unit is finished.
+        """
+        cls._indexes.pop(translation_unit, None)
+    
+    def record(self, cursor: Cursor, function: Optional[Cursor]) -> None:
+        """Record a node if it references a declaration.
+        
+        Args:
+            cursor: AST node
+            function: Function the node occurs in, if any
+        """
+        if cursor.kind not in self.REFERENCE_KINDS:
+            return
+        
+        referenced = cursor.referenced
+        if referenced is None:
+            return
+        usr = referenced.get_usr()
+        if not usr:
+            return
+        
+        self._references.setdefault(usr, []).append(SymbolReference(cursor, function))
+    
+    def get_references(self, usr: str) -> List[SymbolReference]:
+        """Get every reference to a declaration.
+        
+        Args:
+            usr: Unified Symbol Resolution string of the declaration
+            
+        Returns:
+            References in traversal order
+        """
+        return self._references.get(usr, [])
+    
+    def get_referencing_functions(self, usr: str) -> List[str]:
+        """Get the names of functions that reference a declaration.
+        
+        Args:
+            usr: Unified Symbol Resolution string of the declaration
+            
+        Returns:
+            Sorted function names
+        """
+        return sorted({
+            reference.function.spelling
+            for reference in self.get_references(usr)
+            if reference.function is not None
+        })
+
+
 class SourceLocationExtractor:
     """Extract and convert source location information."""
     
@@ -210,32 +967,212 @@ class SourceLocationExtractor:
             extent = cursor.extent
             if not extent.start.file:
                 return None
-                
-            file_path = extent.start.file.name
-            if not os.path.exists(file_path):
-                return None
-                
-            with open(file_path, 'r', encoding='utf-8') as f:
-                lines = f.readlines()
-                
-            start_line = extent.start.line - 1  # Convert to 0-based
-            end_line = extent.end.line - 1
-            start_col = extent.start.column - 1
-            end_col = extent.end.column - 1
             
-            if start_line == end_line:
-                return lines[start_line][start_col:end_col]
-            else:
-                result = lines[start_line][start_col:]
-                for line_idx in range(start_line + 1, end_line):
-                    result += lines[line_idx]
-                result += lines[end_line][:end_col]
-                return result
+            return SourceBufferCache.shared().get_text(
+                extent.start.file.name,
+                extent.start.line,
+                extent.start.column,
+                extent.end.line,
+                extent.end.column
+            )
                 
         except Exception:
             return None
 
 
+class SourceBuffer(NamedTuple):
+    """Contents of one source file with the offset of each line."""
+    text: str
+    line_offsets: List[int]
+    size: int
+    mtime_ns: int
+
+
+class SourceBufferCache:
+    """LRU cache of source file contents for snippet extraction.
+    
+    Each file is read once and indexed by line start offset, so getting a
+    snippet is a slice instead of a full read. Entries are revalidated
+    against the file's size and modification time, and the least recently
+    used files are evicted once the total size passes ``max_bytes``.
+    
+    The cache is shared by threads (web requests, daemon handlers), so
+    the LRU is guarded by a lock; files are read outside it.
+    """
+    
+    DEFAULT_MAX_BYTES = 64 * 1024 * 1024
+    
+    _shared: Optional["SourceBufferCache"] = None
+    _shared_lock = threading.Lock()
+    
+    def __init__(self, max_bytes: int = DEFAULT_MAX_BYTES):
+        """Initialize the cache.
+        
+        Args:
+            max_bytes: Upper bound on the total size of cached files
+        """
+        self.max_bytes = max_bytes
+        self.hits = 0
+        self.misses = 0
+        self._buffers: "OrderedDict[str, SourceBuffer]" = OrderedDict()
+        self._total_bytes = 0
+        self._lock = threading.Lock()
+    
+    @classmethod
+    def shared(cls) -> "SourceBufferCache":
+        """Get the process-wide cache used by rules and report renderers."""
+        with cls._shared_lock:
+            if cls._shared is None:
+                cls._shared = cls()
+            return cls._shared
+    
+    def get_text(self, file_path: str, start_line: int, start_column: int,
+                 end_line: int, end_column: int) -> Optional[str]:
+        """Get the text between two 1-based positions.
+        
+        Args:
+            file_path: Source file path
+            start_line: First line
+            start_column: Column of the first character
+            end_line: Last line
+            end_column: Column just past the last character
+            
+        Returns:
+            Source text, or None if the file or range isn't available
+        """
+        buffer = self._get_buffer(file_path)
+        if buffer is None:
+            return None
+        
+        line_count = len(buffer.line_offsets)
+        if not (1 <= start_line <= end_line <= line_count):
+            return None
+        
+        start = buffer.line_offsets[start_line - 1] + max(start_column - 1, 0)
+        end_line_end = self._line_end(buffer, end_line)
+        end = min(buffer.line_offsets[end_line - 1] + max(end_column - 1, 0), end_line_end)
+        start = min(start, self._line_end(buffer, start_line))
+        return buffer.text[start:end]
+    
+    def get_lines(self, file_path: str, start_line: int, end_line: int) -> List[str]:
+        """Get whole lines, without line terminators.
+        
+        Args:
+            file_path: Source file path
+            start_line: First line (1-based, clamped to the file)
+            end_line: Last line (inclusive, clamped to the file)
+            
+        Returns:
+            List of lines, empty if the file can't be read
+        """
+        buffer = self._get_buffer(file_path)
+        if buffer is None:
+            return []
+        
+        first = max(start_line, 1)
+        last = min(end_line, len(buffer.line_offsets))
+        lines = []
+        for line in range(first, last + 1):
+            start = buffer.line_offsets[line - 1]
+            lines.append(buffer.text[start:self._line_end(buffer, line)].rstrip("\r\n"))
+        return lines
+    
+    def get_line(self, file_path: str, line: int) -> Optional[str]:
+        """Get a single line, without its line terminator."""
+        lines = self.get_lines(file_path, line, line)
+        return lines[0] if lines else None
+    
+    def line_for_offset(self, file_path: str, offset: int) -> Optional[int]:
+        """Get the 1-based line containing a character offset."""
+        buffer = self._get_buffer(file_path)
+        if buffer is None or not 0 <= offset <= len(buffer.text):
+            return None
+        return bisect_right(buffer.line_offsets, offset)
+    
+    def invalidate(self, file_path: str) -> None:
+        """Drop a file from the cache."""
+        with self._lock:
+            self._invalidate_locked(os.path.abspath(file_path))
+    
+    def clear(self) -> None:
+        """Drop all cached files."""
+        with self._lock:
+            self._buffers.clear()
+            self._total_bytes = 0
+    
+    def get_stats(self) -> Dict[str, Any]:
+        """Get cache statistics for report metadata."""
+        with self._lock:
+            return {
+                "files": len(self._buffers),
+                "bytes": self._total_bytes,
+                "max_bytes": self.max_bytes,
+                "hits": self.hits,
+                "misses": self.misses
+            }
+    
+    def _get_buffer(self, file_path: str) -> Optional[SourceBuffer]:
+        """Get the buffer for a file, loading it on a miss or when stale."""
+        key = os.path.abspath(file_path)
+        try:
+            stat = os.stat(key)
+        except OSError:
+            self.invalidate(key)
+            return None
+        
+        with self._lock:
+            buffer = self._buffers.get(key)
+            if buffer is not None:
+                if buffer.size == stat.st_size and buffer.mtime_ns == stat.st_mtime_ns:
+                    self._buffers.move_to_end(key)
+                    self.hits += 1
+                    return buffer
+                self._invalidate_locked(key)
+            self.misses += 1
+        
+        try:
+            with open(key, 'r', encoding='utf-8') as f:
+                text = f.read()
+        except (OSError, UnicodeDecodeError):
+            return None
+        
+        line_offsets = [0]
+        position = text.find("\n")
+        while position != -1:
+            line_offsets.append(position + 1)
+            position = text.find("\n", position + 1)
+        if line_offsets[-1] == len(text) and len(line_offsets) > 1:
+            line_offsets.pop()  # No empty line after a trailing newline
+        
+        buffer = SourceBuffer(text, line_offsets, stat.st_size, stat.st_mtime_ns)
+        if buffer.size <= self.max_bytes:
+            with self._lock:
+                # Another thread may have loaded the file meanwhile
+                self._invalidate_locked(key)
+                self._buffers[key] = buffer
+                self._total_bytes += buffer.size
+                self._evict()
+        return buffer
+    
+    def _invalidate_locked(self, key: str) -> None:
+        buffer = self._buffers.pop(key, None)
+        if buffer is not None:
+            self._total_bytes -= buffer.size
+    
+    def _evict(self) -> None:
+        """Evict least recently used files until under the size bound."""
+        while self._total_bytes > self.max_bytes and self._buffers:
+            _, buffer = self._buffers.popitem(last=False)
+            self._total_bytes -= buffer.size
+    
+    @staticmethod
+    def _line_end(buffer: SourceBuffer, line: int) -> int:
+        """Get the offset just past a line, including its terminator."""
+        if line < len(buffer.line_offsets):
+            return buffer.line_offsets[line]
+        return len(buffer.text)
+
+
 class TypeAnalyzer:
     """Analyze type information from AST."""
     
@@ -0,0 +1,398 @@
+"""Persistent caches for analysis results and AI responses."""
+
+import hashlib
+import json
+import os
+import shutil
+import tempfile
+import time
+from pathlib import Path
+from typing import Dict, List, Optional, Any, Tuple
+from ..models import Violation
+
+# Bumped when cached entries gain fields or their contents change meaning,
+# so older entries are not reused
+ENTRY_FORMAT = 3
+
+
+class ResultCache:
+    """On-disk cache of raw rule results, one entry per source file.
+
+    An entry is keyed by the configuration fingerprint, the file path and
+    the file's content hash. It records the hashes of every file the
+    translation unit included, so an entry only hits when the source and
+    all of its transitive includes are unchanged. Cached violations are
+    stored before deviations are applied.
+    """
+
+    def __init__(self, cache_dir: str):
+        """Initialize the result cache.
+
+        Args:
+            cache_dir: Directory holding cache entries
+        """
+        self.cache_dir = Path(cache_dir)
+        self.hits = 0
+        self.misses = 0
+        self._hash_memo: Dict[str, Tuple[int, int, str]] = {}
+
+    @staticmethod
+    def compute_fingerprint(enabled_rules: List[str],
+                            include_paths: List[str],
+                            analyzer_version: str,
+                            extra: Optional[Dict[str, Any]] = None) -> str:
+        """Compute the configuration part of the cache key.
+
+        Args:
+            enabled_rules: Rule IDs being run
+            include_paths: Include directories passed to the parser
+            analyzer_version: Analyzer version string
+            extra: Any other settings that change rule output
+
+        Returns:
+            Hex digest identifying the configuration
+        """
+        payload = {
+            "rules": sorted(enabled_rules),
+            "include_paths": list(include_paths),
+            "version": analyzer_version,
+            "format": ENTRY_FORMAT,
+            "extra": extra or {}
+        }
+        encoded = json.dumps(payload, sort_keys=True).encode("utf-8")
+        return hashlib.sha256(encoded).hexdigest()
+
+    def lookup(self, file_path: str, fingerprint: str) -> Optional[List[Violation]]:
+        """Look up cached violations for a file.
+
+        Args:
+            file_path: Source file path
+            fingerprint: Configuration fingerprint
+
+        Returns:
+            Cached violations, or None on a miss
+        """
+        cached = self.lookup_with_includes(file_path, fingerprint)
+        return cached[0] if cached is not None else None
+
+    def lookup_with_includes(self, file_path: str,
+                             fingerprint: str) -> Optional[Tuple[List[Violation], List[str]]]:
+        """Look up cached violations and the files the entry depends on.
+
+        Args:
+            file_path: Source file path
+            fingerprint: Configuration fingerprint
+
+        Returns:
+            (violations, include_files) tuple, or None on a miss
+        """
+        cached = self.lookup_with_summary(file_path, fingerprint)
+        return cached[:2] if cached is not None else None
+
+    def lookup_with_summary(self, file_path: str, fingerprint: str
+                            ) -> Optional[Tuple[List[Violation], List[str], Optional[Dict[str, Any]]]]:
+        """Look up a cached entry together with its whole-program summary.
+
+        Args:
+            file_path: Source file path
+            fingerprint: Configuration fingerprint
+
+        Returns:
+            (violations, include_files, summary) tuple, where summary is the
+            serialized TranslationUnitSummary stored with the entry (or
+            None), or None on a miss
+        """
+        entry = self._read_entry(file_path, fingerprint)
+        if entry is None or not self._includes_unchanged(entry.get("includes", {})):
+            self.misses += 1
+            return None
+
+        try:
+            violations = [Violation.from_dict(v) for v in entry.get("violations", [])]
+        except Exception:
+            self.misses += 1
+            return None
+
+        self.hits += 1
+        return violations, sorted(entry.get("includes", {})), entry.get("summary")
+
+    def store(self,
+              file_path: str,
+              fingerprint: str,
+              include_files: List[str],
+              violations: List[Violation],
+              summary: Optional[Dict[str, Any]] = None) -> None:
+        """Store violations for a file.
+
+        Args:
+            file_path: Source file path
+            fingerprint: Configuration fingerprint
+            include_files: Files included by the translation unit
+            violations: Raw rule violations for the file
+            summary: Serialized whole-program summary of the unit, if any
+        """
+        key = self._entry_key(file_path, fingerprint)
+        if key is None:
+            return
+
+        includes = {}
+        for include_file in include_files:
+            include_hash = self.hash_file(include_file)
+            if include_hash is None:
+                return  # Can't validate this entry later, so don't write it
+            includes[include_file] = include_hash
+
+        entry = {
+            "file_path": file_path,
+            "includes": includes,
+            "violations": [v.to_dict(encode_json=True) for v in violations]
+        }
+        if summary is not None:
+            entry["summary"] = summary
+
+        entry_path = self._entry_path(key)
+        try:
+            entry_path.parent.mkdir(parents=True, exist_ok=True)
+            # Write-then-rename so concurrent workers never see partial entries
+            fd, tmp_path = tempfile.mkstemp(dir=entry_path.parent, suffix=".tmp")
+            with os.fdopen(fd, "w", encoding="utf-8") as f:
+                json.dump(entry, f)
+            os.replace(tmp_path, entry_path)
+        except OSError as e:
+            print(f"Warning: Could not write cache entry for {file_path}: {str(e)}")
+
+    def clear(self) -> None:
+        """Remove all cache entries."""
+        if self.cache_dir.exists():
+            shutil.rmtree(self.cache_dir)
+        self._hash_memo.clear()
+
+    def get_stats(self) -> Dict[str, Any]:
+        """Get cache statistics for report metadata.
+
+        Returns:
+            Dictionary with hit and miss counts
+        """
+        total = self.hits + self.misses
+        return {
+            "directory": str(self.cache_dir),
+            "hits": self.hits,
+            "misses": self.misses,
+            "hit_ratio": round(self.hits / total, 3) if total else 0.0
+        }
+
+    def merge_stats(self, stats: Dict[str, Any]) -> None:
+        """Add hit and miss counts gathered by another process.
+
+        Args:
+            stats: Dictionary with "hits" and "misses" counts
+        """
+        self.hits += stats.get("hits", 0)
+        self.misses += stats.get("misses", 0)
+
+    def hash_file(self, file_path: str) -> Optional[str]:
+        """Hash file contents, memoized on size and modification time.
+
+        Args:
+            file_path: File to hash
+
+        Returns:
+            Hex digest, or None if the file can't be read
+        """
+        try:
+            stat = os.stat(file_path)
+        except OSError:
+            return None
+
+        memo = self._hash_memo.get(file_path)
+        if memo and memo[0] == stat.st_size and memo[1] == stat.st_mtime_ns:
+            return memo[2]
+
+        digest = hashlib.sha256()
+        try:
+            with open(file_path, "rb") as f:
+                for chunk in iter(lambda: f.read(1 << 16), b""):
+                    digest.update(chunk)
+        except OSError:
+            return None
+
+        file_hash = digest.hexdigest()
+        self._hash_memo[file_path] = (stat.st_size, stat.st_mtime_ns, file_hash)
+        return file_hash
+
+    def _entry_key(self, file_path: str, fingerprint: str) -> Optional[str]:
+        """Build the entry key for a file, or None if it can't be read."""
+        content_hash = self.hash_file(file_path)
+        if content_hash is None:
+            return None
+        key_source = f"{fingerprint}\0{os.path.abspath(file_path)}\0{content_hash}"
+        return hashlib.sha256(key_source.encode("utf-8")).hexdigest()
+
+    def _entry_path(self, key: str) -> Path:
+        """Get the on-disk location of an entry."""
+        return self.cache_dir / key[:2] / f"{key}.json"
+
+    def _read_entry(self, file_path: str, fingerprint: str) -> Optional[Dict[str, Any]]:
+        """Read the entry for a file if one exists."""
+        key = self._entry_key(file_path, fingerprint)
+        if key is None:
+            return None
+
+        entry_path = self._entry_path(key)
+        if not entry_path.exists():
+            return None
+
+        try:
+            with open(entry_path, "r", encoding="utf-8") as f:
+                return json.load(f)
+        except (OSError, ValueError):
+            return None
+
+    def _includes_unchanged(self, includes: Dict[str, str]) -> bool:
+        """Check that every recorded include still has the same contents."""
+        for include_file, include_hash in includes.items():
+            if self.hash_file(include_file) != include_hash:
+                return False
+        return True
+
+
+class ResponseCache:
+    """On-disk cache of AI-generated violation explanations.
+
+    Entries are keyed by rule ID, model, prompt template version and the
+    hash of the whitespace-normalized source context, so re-analyzing
+    unchanged code doesn't pay for the same completion twice. Entries
+    expire after ``ttl_seconds``; ``prune`` drops expired entries and the
+    least recently used ones beyond ``max_entries``.
+    """
+
+    def __init__(self, cache_dir: str, ttl_seconds: float = 30 * 86400,
+                 max_entries: int = 10000):
+        """Initialize the response cache.
+
+        Args:
+            cache_dir: Directory holding cache entries
+            ttl_seconds: Age after which an entry is ignored (0 = never)
+            max_entries: Entries kept by ``prune`` (0 = unbounded)
+        """
+        self.cache_dir = Path(cache_dir)
+        self.ttl_seconds = ttl_seconds
+        self.max_entries = max_entries
+        self.hits = 0
+        self.misses = 0
+
+    @staticmethod
+    def compute_key(rule_id: str, model: str, prompt_version: int, context: str) -> str:
+        """Build the key for a response.
+
+        Args:
+            rule_id: Rule the violation belongs to
+            model: Model that generates the response
+            prompt_version: Version of the prompt template
+            context: Source context (whitespace is normalized here)
+
+        Returns:
+            Hex digest identifying the response
+        """
+        context_hash = hashlib.sha256(" ".join(context.split()).encode("utf-8")).hexdigest()
+        key_source = f"{rule_id}\0{model}\0{prompt_version}\0{context_hash}"
+        return hashlib.sha256(key_source.encode("utf-8")).hexdigest()
+
+    def get(self, key: str) -> Optional[Dict[str, Optional[str]]]:
+        """Look up a response.
+
+        Args:
+            key: Key from ``compute_key``
+
+        Returns:
+            Cached response fields, or None on a miss
+        """
+        entry_path = self._entry_path(key)
+        try:
+            with open(entry_path, "r", encoding="utf-8") as f:
+                entry = json.load(f)
+        except (OSError, ValueError):
+            self.misses += 1
+            return None
+
+        if self.ttl_seconds and time.time() - entry.get("created", 0) > self.ttl_seconds:
+            self.misses += 1
+            return None
+
+        try:
+            # mtime tracks last use for pruning
+            os.utime(entry_path)
+        except OSError:
+            pass
+        self.hits += 1
+        return entry.get("fields")
+
+    def put(self, key: str, fields: Dict[str, Optional[str]]) -> None:
+        """Store a response.
+
+        Args:
+            key: Key from ``compute_key``
+            fields: Response fields to cache
+        """
+        entry_path = self._entry_path(key)
+        try:
+            entry_path.parent.mkdir(parents=True, exist_ok=True)
+            fd, tmp_path = tempfile.mkstemp(dir=entry_path.parent, suffix=".tmp")
+            with os.fdopen(fd, "w", encoding="utf-8") as f:
+                json.dump({"created": time.time(), "fields": fields}, f)
+            os.replace(tmp_path, entry_path)
+        except OSError as e:
+            print(f"Warning: Could not write AI response cache entry: {str(e)}")
+
+    def prune(self) -> None:
+        """Remove expired entries and the least recently used beyond the limit."""
+        if not self.cache_dir.exists():
+            return
+
+        entries = []
+        now = time.time()
+        for entry_path in self.cache_dir.glob("*/*.json"):
+            try:
+                stat = entry_path.stat()
+            except OSError:
+                continue
+            # mtime is never older than creation, so this only drops expired entries
+            if self.ttl_seconds and now - stat.st_mtime > self.ttl_seconds:
+                self._remove(entry_path)
+                continue
+            entries.append((stat.st_mtime, entry_path))
+
+        if self.max_entries and len(entries) > self.max_entries:
+            entries.sort()
+            for _, entry_path in entries[:len(entries) - self.max_entries]:
+                self._remove(entry_path)
+
+    def clear(self) -> None:
+        """Remove all cache entries."""
+        if self.cache_dir.exists():
+            shutil.rmtree(self.cache_dir)
+
+    def get_stats(self) -> Dict[str, Any]:
+        """Get cache statistics for report metadata.
+
+        Returns:
+            Dictionary with hit and miss counts
+        """
+        total = self.hits + self.misses
+        return {
+            "directory": str(self.cache_dir),
+            "hits": self.hits,
+            "misses": self.misses,
+            "hit_ratio": round(self.hits / total, 3) if total else 0.0
+        }
+
+    def _entry_path(self, key: str) -> Path:
+        """Get the on-disk location of an entry."""
+        return self.cache_dir / key[:2] / f"{key}.json"
+
+    @staticmethod
+    def _remove(entry_path: Path) -> None:
+        try:
+            entry_path.unlink()
+        except OSError:
+            pass
@@ -2,12 +2,23 @@
 
 import sys
 import os
+import json
+import time
 import click
 from pathlib import Path
 from typing import Optional, List
 from . import StaticAnalyzer, create_analyzer_from_config_file, create_default_analyzer
 from .config import AnalyzerConfig, DeviationManager, create_default_config_file
-from .models import Standard
+from .models import AnalysisReport, Standard
+from .ast import SourceBufferCache
+from .reports import STREAMING_FORMATS, create_report_writer
+from .baseline import DEFAULT_LINE_TOLERANCE, compare_with_baseline
+from .profiling import format_profile
+from .program import load_summaries
+from .shard import ShardSpec
+from .watch import WatchSession, WatchUpdate
+from .daemon import (AnalysisService, DaemonClient, DaemonError, DEFAULT_INSTANCES,
+                     DEFAULT_TU_CACHE_SIZE, get_socket_path, serve)
 
 
 @click.group()
@@ -18,8 +29,11 @@ def cli() -> None:
 
 
 @cli.command()
-@click.option("--path", "-p", required=True, 
+@click.option("--path", "-p",
               help="Path to source file or directory to analyze")
+@click.option("--compile-commands",
+              help="compile_commands.json (or its directory) listing the TUs "
+                   "to analyze and their flags")
 @click.option("--config", "-c", 
               help="Path to configuration YAML file")
 @click.option("--deviations", "-d", 
@@ -34,9 +48,10 @@ def cli() -> None:
 @click.option("--exclude-rules", 
               help="Comma-separated list of rule IDs to exclude")
 @click.option("--format", "-f", 
-              type=click.Choice(['json', 'yaml', 'text']),
+              type=click.Choice(['json', 'yaml', 'text', 'ndjson', 'sarif', 'store']),
               default='json',
-              help="Output format")
+              help="Output format (ndjson and sarif are written as files finish; "
+                   "store is the compact binary format, usable as a --baseline)")
 @click.option("--ai-explain", is_flag=True,
               help="Enable AI explanations (requires API key)")
 @click.option("--fail-on-violations", is_flag=True,
@@ -49,9 +64,36 @@ def cli() -> None:
               help="Recursively analyze directories")
 @click.option("--include-paths", "-I", multiple=True,
               help="Additional include directories")
+@click.option("--jobs", "-j", type=int,
+              help="Number of worker processes (0 = one per CPU)")
+@click.option("--cache-dir",
+              help="Directory for the per-file result cache")
+@click.option("--clear-cache", is_flag=True,
+              help="Clear the result cache before analyzing")
+@click.option("--profile", is_flag=True,
+              help="Print phase timings and the slowest files and rules to stderr")
+@click.option("--profile-top", type=int, default=10, show_default=True,
+              help="Number of files and rules listed by --profile")
+@click.option("--whole-program", is_flag=True,
+              help="Decide cross-TU rules (MISRA 8.7) over all analyzed files")
+@click.option("--summary-dir",
+              help="Write per-TU whole-program summaries here (see 'link')")
+@click.option("--shard",
+              help="Analyze only shard i of N (e.g. 2/4); combine shard reports with 'merge'")
+@click.option("--shard-timings",
+              help="Earlier merged report whose per-file timings balance the shards")
+@click.option("--memory-bounded", is_flag=True,
+              help="Free each translation unit as soon as its rules finish")
+@click.option("--memory-ceiling-mb", type=int,
+              help="Move violations to a temporary file once the process passes this size")
+@click.option("--watch", is_flag=True,
+              help="Keep running and re-analyze the files each save affects")
+@click.option("--daemon", "use_daemon", is_flag=True,
+              help="Run in the analysis daemon if one is running (see 'daemon serve')")
 @click.option("--verbose", "-v", is_flag=True,
               help="Enable verbose output")
-def analyze(path: str,
+def analyze(path: Optional[str],
+           compile_commands: Optional[str],
            config: Optional[str],
            deviations: Optional[str],
            output: Optional[str],
@@ -65,53 +107,151 @@ def analyze(path: str,
            baseline: Optional[str],
            recursive: bool,
            include_paths: tuple,
+           jobs: Optional[int],
+           cache_dir: Optional[str],
+           clear_cache: bool,
+           profile: bool,
+           profile_top: int,
+           whole_program: bool,
+           summary_dir: Optional[str],
+           shard: Optional[str],
+           shard_timings: Optional[str],
+           memory_bounded: bool,
+           memory_ceiling_mb: Optional[int],
+           watch: bool,
+           use_daemon: bool,
            verbose: bool) -> None:
     """Analyze C/C++ source code for MISRA and CERT violations."""
     
     try:
+        if not path and not compile_commands:
+            click.echo("Error: --path or --compile-commands is required", err=True)
+            sys.exit(1)
+        
         # Load or create analyzer configuration
         if config:
-            analyzer = create_analyzer_from_config_file(config, deviations)
+            analyzer_config = AnalyzerConfig.from_file(config)
         else:
-            analyzer = create_default_analyzer()
+            analyzer_config = AnalyzerConfig.create_default()
             
             # Override config with command line options
             if standard:
-                analyzer.config.config["standards"] = list(standard)
+                analyzer_config.config["standards"] = list(standard)
             if ai_explain:
-                analyzer.config.config["ai_assistant"]["enabled"] = True
+                analyzer_config.config["ai_assistant"]["enabled"] = True
             if include_paths:
-                analyzer.config.config["analysis"]["include_paths"] = list(include_paths)
+                analyzer_config.config["analysis"]["include_paths"] = list(include_paths)
         
-        # Validate configuration
-        if verbose:
-            config_issues = analyzer.validate_config()
-            if config_issues:
-                click.echo("Configuration issues:", err=True)
-                for issue in config_issues:
-                    click.echo(f"  - {issue}", err=True)
+        # Worker count is an execution choice, so it applies on top of any config file
+        if jobs is not None:
+            analyzer_config.config["analysis"]["parallelism"] = jobs
+        if cache_dir:
+            analyzer_config.config["analysis"]["cache_dir"] = cache_dir
+        if whole_program or summary_dir:
+            analyzer_config.config["analysis"]["whole_program"] = True
+        if summary_dir:
+            analyzer_config.config["analysis"]["summary_dir"] = summary_dir
+        if shard:
+            ShardSpec.parse(shard)
+            analyzer_config.config["analysis"]["shard"] = shard
+        if shard_timings:
+            analyzer_config.config["analysis"]["shard_timings"] = shard_timings
+        if memory_bounded:
+            analyzer_config.config["analysis"]["memory_bounded"] = True
+        if memory_ceiling_mb is not None:
+            analyzer_config.config["analysis"]["memory_ceiling_mb"] = memory_ceiling_mb
         
         # Determine which rules to run
         enabled_rules = None
         if rules:
             enabled_rules = [rule.strip() for rule in rules.split(',')]
         
+        streaming = format in STREAMING_FORMATS
+        if streaming and fail_on_new:
+            click.echo(f"Error: --fail-on-new is not supported with --format {format}", err=True)
+            sys.exit(1)
+        if watch:
+            if streaming or shard:
+                click.echo("Error: --watch is not supported with streaming formats or --shard", err=True)
+                sys.exit(1)
+            # Units are reparsed from the in-process translation unit cache
+            analyzer_config.config["analysis"]["parallelism"] = 1
+            use_daemon = False
+        if (streaming or watch) and exclude_rules:
+            # Streamed violations can't be filtered afterwards, so don't run these rules
+            disabled_rules = analyzer_config.config.setdefault("rules", {}).setdefault("disabled", [])
+            disabled_rules.extend(rule.strip() for rule in exclude_rules.split(','))
+        
+        # A running daemon has already paid the libclang and rule setup cost.
+        # Streaming output and cache clearing need a local analyzer.
+        analyzer = None
+        if use_daemon and not streaming and not clear_cache:
+            client = DaemonClient()
+            if client.is_available():
+                analyzer = client.remote_analyzer(analyzer_config, deviations)
+                if verbose:
+                    click.echo(f"Using analysis daemon at {client.socket_path}")
+            elif verbose:
+                click.echo("No analysis daemon running, analyzing locally", err=True)
+        
+        if analyzer is None:
+            analyzer = StaticAnalyzer(analyzer_config, deviations)
+            if clear_cache:
+                analyzer.clear_result_cache()
+                if verbose:
+                    click.echo("Result cache cleared")
+            
+            # Validate configuration
+            if verbose:
+                config_issues = analyzer.validate_config()
+                if config_issues:
+                    click.echo("Configuration issues:", err=True)
+                    for issue in config_issues:
+                        click.echo(f"  - {issue}", err=True)
+        
         # Determine files to analyze
-        source_path = Path(path)
-        if not source_path.exists():
+        source_path = Path(path) if path else None
+        if source_path and not source_path.exists():
             click.echo(f"Error: Path not found: {path}", err=True)
             sys.exit(1)
         
         # Run analysis
         if verbose:
-            click.echo(f"Analyzing: {path}")
+            click.echo(f"Analyzing: {path or compile_commands}")
             if enabled_rules:
                 click.echo(f"Rules: {', '.join(enabled_rules)}")
         
-        if source_path.is_file():
+        if watch:
+            _run_watch(analyzer, compile_commands, path, source_path, recursive,
+                       enabled_rules, output, format, verbose)
+            return
+        
+        if streaming:
+            report = _run_streaming_analysis(
+                analyzer, format, output, compile_commands, path, source_path,
+                recursive, enabled_rules
+            )
+            violation_count = report.summary["total_violations"]
+            if verbose and output:
+                click.echo(f"Report written to: {output}")
+            if profile:
+                click.echo(format_profile(report.metadata["profile"], profile_top), err=True)
+            if fail_on_violations and violation_count > 0:
+                sys.exit(1)
+            if verbose:
+                click.echo(f"Analysis complete. {violation_count} violations found.")
+            return
+        
+        if compile_commands:
+            report = analyzer.analyze_compile_commands(
+                compile_commands, path, enabled_rules
+            )
+        elif source_path.is_file():
             report = analyzer.analyze_files([str(source_path)], enabled_rules)
         else:
-            report = analyzer.analyze_directory(str(source_path), recursive, enabled_rules)
+            report = analyzer.analyze_directory(
+                str(source_path), recursive, enabled_rules=enabled_rules
+            )
         
         # Filter out excluded rules
         if exclude_rules:
@@ -121,7 +261,9 @@ def analyze(path: str,
         
         # Handle baseline comparison
         if fail_on_new and baseline:
-            new_violations = _compare_with_baseline(report, baseline)
+            new_violations = _compare_with_baseline(
+                report, baseline, analyzer_config.get_baseline_line_tolerance(), verbose
+            )
             if verbose:
                 click.echo(f"New violations: {len(new_violations)}")
             
@@ -130,6 +272,8 @@ def analyze(path: str,
         
         # Generate and output report
         _output_report(report, output, format, verbose)
+        if profile:
+            click.echo(format_profile(report.metadata["profile"], profile_top), err=True)
         
         # Exit with appropriate code
         violation_count = len(report.violations)
@@ -224,13 +368,266 @@ def validate_config(config: Optional[str]) -> None:
         sys.exit(1)
 
 
+@cli.command()
+@click.argument("summaries", nargs=-1, required=True)
+@click.option("--config", "-c",
+              help="Path to configuration YAML file")
+@click.option("--deviations", "-d",
+              help="Path to deviations YAML file")
+@click.option("--rules", "-r",
+              help="Comma-separated list of specific rule IDs to run")
+@click.option("--output", "-o",
+              help="Output file path (default: stdout)")
+@click.option("--format", "-f",
+              type=click.Choice(['json', 'yaml', 'text']),
+              default='json',
+              help="Output format")
+@click.option("--fail-on-violations", is_flag=True,
+              help="Exit with non-zero code if violations found")
+@click.option("--verbose", "-v", is_flag=True,
+              help="Enable verbose output")
+def link(summaries: tuple,
+         config: Optional[str],
+         deviations: Optional[str],
+         rules: Optional[str],
+         output: Optional[str],
+         format: str,
+         fail_on_violations: bool,
+         verbose: bool) -> None:
+    """Evaluate whole-program rules over per-TU summaries.
+    
+    SUMMARIES are summary files or directories written by
+    'analyze --summary-dir', e.g. one per CI shard.
+    """
+    try:
+        analyzer_config = AnalyzerConfig.from_file(config) if config else AnalyzerConfig.create_default()
+        analyzer = StaticAnalyzer(analyzer_config, deviations)
+        
+        enabled_rules = None
+        if rules:
+            enabled_rules = [rule.strip() for rule in rules.split(',')]
+        
+        unit_summaries = load_summaries(summaries)
+        if verbose:
+            click.echo(f"Linking {len(unit_summaries)} translation unit summaries")
+        
+        violations = analyzer.filter_new_violations(
+            analyzer.link_summaries(unit_summaries, enabled_rules), set()
+        )
+        report = AnalysisReport(violations, {}, {
+            "analyzer_version": "1.0.0",
+            "whole_program": {"translation_units": len(unit_summaries)},
+            "deviations_applied": len(analyzer.deviation_manager.deviations)
+        })
+        report.generate_summary()
+        _output_report(report, output, format, verbose)
+        
+        if fail_on_violations and violations:
+            sys.exit(1)
+    
+    except Exception as e:
+        click.echo(f"Error: {str(e)}", err=True)
+        if verbose:
+            import traceback
+            traceback.print_exc()
+        sys.exit(1)
+
+
+@cli.command()
+@click.argument("reports", nargs=-1, required=True)
+@click.option("--config", "-c",
+              help="Path to configuration YAML file")
+@click.option("--deviations", "-d",
+              help="Path to deviations YAML file, applied once to the merged report")
+@click.option("--summaries", multiple=True,
+              help="Whole-program summary directory written by the shards (repeatable)")
+@click.option("--output", "-o",
+              help="Output file path (default: stdout)")
+@click.option("--format", "-f",
+              type=click.Choice(['json', 'yaml', 'text']),
+              default='json',
+              help="Output format")
+@click.option("--baseline",
+              help="Path to baseline file; only violations not in it are reported")
+@click.option("--fail-on-violations", is_flag=True,
+              help="Exit with non-zero code if violations found")
+@click.option("--fail-on-new", is_flag=True,
+              help="Exit with non-zero code only on new violations (requires baseline)")
+@click.option("--verbose", "-v", is_flag=True,
+              help="Enable verbose output")
+def merge(reports: tuple,
+          config: Optional[str],
+          deviations: Optional[str],
+          summaries: tuple,
+          output: Optional[str],
+          format: str,
+          baseline: Optional[str],
+          fail_on_violations: bool,
+          fail_on_new: bool,
+          verbose: bool) -> None:
+    """Combine the reports of an 'analyze --shard' run into one.
+    
+    REPORTS are the shard reports, in any format --baseline accepts.
+    """
+    if fail_on_new and not baseline:
+        raise click.UsageError("--fail-on-new requires --baseline")
+    
+    try:
+        analyzer_config = AnalyzerConfig.from_file(config) if config else AnalyzerConfig.create_default()
+        analyzer = StaticAnalyzer(analyzer_config, deviations)
+        
+        unit_summaries = load_summaries(summaries) if summaries else None
+        report = analyzer.merge_shard_reports(list(reports), unit_summaries)
+        if verbose:
+            click.echo(f"Merged {len(reports)} shard reports: "
+                       f"{report.metadata['files_analyzed']} files, "
+                       f"{len(report.violations)} violations")
+        
+        if baseline:
+            report.violations = _compare_with_baseline(
+                report, baseline, analyzer_config.get_baseline_line_tolerance(), verbose
+            )
+            report.generate_summary()
+            if verbose:
+                click.echo(f"New violations: {len(report.violations)}")
+        
+        _output_report(report, output, format, verbose)
+        
+        if (fail_on_violations or fail_on_new) and report.violations:
+            sys.exit(1)
+    
+    except Exception as e:
+        click.echo(f"Error: {str(e)}", err=True)
+        if verbose:
+            import traceback
+            traceback.print_exc()
+        sys.exit(1)
+
+
+@cli.group()
+def daemon() -> None:
+    """Run or control the resident analysis daemon."""
+    pass
+
+
+@daemon.command("serve")
+@click.option("--socket", "socket_path",
+              help=f"Unix socket to listen on (default: ${{STATIC_ANALYZER_DAEMON}} or {get_socket_path()})")
+@click.option("--max-analyzers", type=int, default=4, show_default=True,
+              help="Distinct configurations kept warm")
+@click.option("--tu-cache-size", type=int, default=DEFAULT_TU_CACHE_SIZE, show_default=True,
+              help="Translation units kept for reparsing per analyzer")
+@click.option("--instances", type=int, default=DEFAULT_INSTANCES, show_default=True,
+              help="Analyses of one configuration that run at once, each with its own analyzer")
+def daemon_serve(socket_path: Optional[str], max_analyzers: int, tu_cache_size: int,
+                 instances: int) -> None:
+    """Serve analysis requests from warm analyzers until stopped."""
+    try:
+        click.echo(f"Analysis daemon listening on {get_socket_path(socket_path)}", err=True)
+        serve(socket_path, AnalysisService(max_analyzers, tu_cache_size, instances))
+    except KeyboardInterrupt:
+        pass
+    except DaemonError as e:
+        click.echo(f"Error: {str(e)}", err=True)
+        sys.exit(1)
+
+
+@daemon.command("status")
+@click.option("--socket", "socket_path", help="Daemon socket")
+def daemon_status(socket_path: Optional[str]) -> None:
+    """Show the daemon's warm analyzers and cache counters."""
+    try:
+        click.echo(json.dumps(DaemonClient(socket_path).status(), indent=2))
+    except DaemonError as e:
+        click.echo(f"Error: {str(e)}", err=True)
+        sys.exit(1)
+
+
+@daemon.command("stop")
+@click.option("--socket", "socket_path", help="Daemon socket")
+def daemon_stop(socket_path: Optional[str]) -> None:
+    """Stop a running daemon."""
+    try:
+        DaemonClient(socket_path).shutdown()
+        click.echo("Analysis daemon stopped")
+    except DaemonError as e:
+        click.echo(f"Error: {str(e)}", err=True)
+        sys.exit(1)
+
+
+def _run_streaming_analysis(analyzer, format: str, output_path: Optional[str],
+                            compile_commands: Optional[str], path: Optional[str],
+                            source_path: Optional[Path], recursive: bool,
+                            enabled_rules: Optional[List[str]]):
+    """Run analysis writing violations to the output as files finish."""
+    if STREAMING_FORMATS[format].binary:
+        stream = open(output_path, 'wb') if output_path else sys.stdout.buffer
+    else:
+        stream = open(output_path, 'w', encoding='utf-8') if output_path else sys.stdout
+    try:
+        writer = create_report_writer(format, stream)
+        if compile_commands:
+            return analyzer.analyze_compile_commands(
+                compile_commands, path, enabled_rules, report_writer=writer
+            )
+        if source_path.is_file():
+            return analyzer.analyze_files(
+                [str(source_path)], enabled_rules, report_writer=writer
+            )
+        return analyzer.analyze_directory(
+            str(source_path), recursive, enabled_rules=enabled_rules,
+            report_writer=writer
+        )
+    finally:
+        if output_path:
+            stream.close()
+
+
+def _run_watch(analyzer: StaticAnalyzer,
+               compile_commands: Optional[str],
+               path: Optional[str],
+               source_path: Optional[Path],
+               recursive: bool,
+               enabled_rules: Optional[List[str]],
+               output: Optional[str],
+               format: str,
+               verbose: bool) -> None:
+    """Analyze, then re-analyze on every change until interrupted."""
+    if compile_commands:
+        analyzer.set_compile_commands(compile_commands)
+        
+        def find_sources() -> List[str]:
+            return analyzer.collect_source_files(path)
+    elif source_path.is_file():
+        def find_sources() -> List[str]:
+            return [str(source_path)] if source_path.exists() else []
+    else:
+        def find_sources() -> List[str]:
+            return analyzer.collect_source_files(str(source_path), recursive)
+    
+    def on_update(update: WatchUpdate) -> None:
+        _output_report(update.report, output, format, verbose)
+        stamp = time.strftime("%H:%M:%S")
+        click.echo(f"[{stamp}] {len(update.reanalyzed)} files analyzed in {update.seconds:.2f}s, "
+                   f"{len(update.report.violations)} violations; watching for changes (Ctrl-C to stop)",
+                   err=True)
+        if verbose and update.changed:
+            click.echo(f"  Changed: {', '.join(update.changed)}", err=True)
+    
+    session = WatchSession(analyzer, find_sources, enabled_rules)
+    try:
+        session.run(on_update)
+    except KeyboardInterrupt:
+        pass
+
+
 def _output_report(report, output_path: Optional[str], format: str, verbose: bool) -> None:
     """Output the analysis report."""
     if format == 'json':
         content = report.to_json()
     elif format == 'yaml':
         import yaml
-        content = yaml.dump(report.to_dict(), default_flow_style=False, indent=2)
+        content = yaml.dump(report.to_dict(encode_json=True), default_flow_style=False, indent=2)
     else:  # text format
         content = _format_text_report(report)
     
@@ -252,6 +649,8 @@ def _format_text_report(report) -> str:
     lines.append("")
     
     if report.violations:
+        source_buffers = SourceBufferCache.shared()
+        
         # Group by file
         violations_by_file = {}
         for violation in report.violations:
@@ -269,6 +668,10 @@ def _format_text_report(report) -> str:
                            f"[{violation.severity.value}] {violation.rule_id}")
                 lines.append(f"    {violation.message}")
                 
+                code = source_buffers.get_line(file_path, violation.location.line)
+                if code and code.strip():
+                    lines.append(f"    | {code.strip()}")
+                
                 if violation.ai_explanation:
                     lines.append(f"    💡 {violation.ai_explanation}")
                 
@@ -277,38 +680,20 @@ def _format_text_report(report) -> str:
     return "\n".join(lines)
 
 
-def _compare_with_baseline(report, baseline_path: str) -> List:
-    """Compare report with baseline to find new violations."""
+def _compare_with_baseline(report, baseline_path: str, line_tolerance: int = DEFAULT_LINE_TOLERANCE,
+                           verbose: bool = False) -> List:
+    """Compare report with baseline to find new violations.
+    
+    The baseline may be a JSON or NDJSON report or a saved store. Its
+    fingerprint index is kept in a sidecar file, so repeated comparisons
+    against the same baseline do not decode it again.
+    """
     try:
-        import json
-        with open(baseline_path, 'r', encoding='utf-8') as f:
-            baseline_data = json.load(f)
-        
-        baseline_violations = set()
-        for violation_data in baseline_data.get('violations', []):
-            # Create signature for comparison
-            signature = (
-                violation_data['rule_id'],
-                violation_data['location']['file_path'],
-                violation_data['location']['line'],
-                violation_data['location']['column']
-            )
-            baseline_violations.add(signature)
-        
-        # Find new violations
-        new_violations = []
-        for violation in report.violations:
-            signature = (
-                violation.rule_id,
-                violation.location.file_path,
-                violation.location.line,
-                violation.location.column
-            )
-            if signature not in baseline_violations:
-                new_violations.append(violation)
-        
+        new_violations, comparison = compare_with_baseline(report.violations, baseline_path, line_tolerance)
+        if verbose:
+            click.echo(f"Baseline: {len(comparison.fixed)} fixed, "
+                       f"{comparison.moved} matched across moved lines")
         return new_violations
-        
     except Exception as e:
         click.echo(f"Warning: Could not compare with baseline: {str(e)}", err=True)
         return report.violations
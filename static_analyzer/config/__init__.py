@@ -1,7 +1,13 @@
 """Configuration management for static analyzer."""
 
+import os
+import re
+import fnmatch
 import yaml
-from typing import Dict, List, Optional, Any
+from bisect import bisect_right
+from collections import deque
+from datetime import date, datetime
+from typing import Dict, List, Optional, Any, Tuple
 from pathlib import Path
 from ..models import Deviation, Standard
 
@@ -41,14 +47,38 @@ class AnalyzerConfig:
                 "include_paths": [],
                 "exclude_paths": [],
                 "max_violations_per_rule": 1000,
-                "confidence_threshold": "low"
+                "confidence_threshold": "low",
+                "parallelism": 1,
+                "cache_dir": None,
+                "precompiled_headers": [],
+                "pch_dir": None,
+                "compile_commands": None,
+                "source_cache_mb": 64,
+                "tu_cache_size": 0,
+                "lexical_prefilter": True,
+                "native_backend": False,
+                "walk_scope": "project",
+                "whole_program": False,
+                "summary_dir": None,
+                "shard": None,
+                "shard_timings": None,
+                "baseline_line_tolerance": 200,
+                "memory_bounded": False,
+                "memory_ceiling_mb": 0
             },
             "ai_assistant": {
                 "enabled": False,
                 "model": "gpt-4",
                 "api_key_env": "OPENAI_API_KEY",
-                "max_tokens": 500,
-                "temperature": 0.1
+                "max_tokens": 1000,
+                "temperature": 0.1,
+                "concurrency": 8,
+                "max_retries": 5,
+                "retry_base_delay": 1.0,
+                "response_cache": True,
+                "response_cache_dir": None,
+                "response_cache_ttl_days": 30,
+                "response_cache_max_entries": 10000
             }
         }
         
@@ -139,6 +169,164 @@ class AnalyzerConfig:
         """
         return self.config.get("analysis", {}).get("exclude_paths", [])
     
+    def get_parallelism(self) -> int:
+        """Get number of worker processes for file analysis.
+        
+        Returns:
+            Worker count; 0 means one worker per CPU
+        """
+        parallelism = int(self.config.get("analysis", {}).get("parallelism", 1))
+        if parallelism <= 0:
+            return os.cpu_count() or 1
+        return parallelism
+    
+    def get_precompiled_headers(self) -> List[str]:
+        """Get headers to compile once into a shared PCH.
+        
+        Returns:
+            List of header paths
+        """
+        return self.config.get("analysis", {}).get("precompiled_headers", [])
+    
+    def get_pch_dir(self) -> Optional[str]:
+        """Get the directory for generated PCH files.
+        
+        Returns:
+            Directory path (default: "pch" under the result cache
+            directory), or None for a temporary directory
+        """
+        pch_dir = self.config.get("analysis", {}).get("pch_dir")
+        if pch_dir is None and self.get_cache_dir():
+            pch_dir = os.path.join(self.get_cache_dir(), "pch")
+        return pch_dir
+    
+    def get_compile_commands(self) -> Optional[str]:
+        """Get the compilation database location.
+        
+        Returns:
+            Path to compile_commands.json (or its directory), or None
+        """
+        return self.config.get("analysis", {}).get("compile_commands")
+    
+    def get_cache_dir(self) -> Optional[str]:
+        """Get the result cache directory.
+        
+        Returns:
+            Cache directory path, or None if caching is disabled
+        """
+        return self.config.get("analysis", {}).get("cache_dir")
+    
+    def get_source_cache_bytes(self) -> int:
+        """Get the memory bound for cached source file contents.
+        
+        Returns:
+            Maximum number of bytes of source text kept in memory
+        """
+        megabytes = self.config.get("analysis", {}).get("source_cache_mb", 64)
+        return int(megabytes * 1024 * 1024)
+    
+    def get_tu_cache_size(self) -> int:
+        """Get the number of parsed translation units kept for reparsing.
+        
+        Returns:
+            Maximum number of cached translation units (0 disables the cache)
+        """
+        if self.is_memory_bounded():
+            return 0
+        return max(int(self.config.get("analysis", {}).get("tu_cache_size", 0)), 0)
+    
+    def is_lexical_prefilter_enabled(self) -> bool:
+        """Check if rules are skipped on files whose source cannot match them.
+        
+        Returns:
+            True if the lexical pre-filter is enabled
+        """
+        return bool(self.config.get("analysis", {}).get("lexical_prefilter", True))
+    
+    def is_native_backend_enabled(self) -> bool:
+        """Check if the compiled AST walk is used when it is built.
+        
+        Off by default: opt in after checking the built extension against
+        the Python walk on your own code.
+        
+        Returns:
+            True if the native backend may be used
+        """
+        return bool(self.config.get("analysis", {}).get("native_backend", False))
+    
+    def get_walk_scope(self) -> str:
+        """Get which top-level declarations rules visit.
+        
+        Returns:
+            "all", "project" (skip system and excluded headers) or "main_file"
+        """
+        return self.config.get("analysis", {}).get("walk_scope", "project")
+    
+    def is_whole_program_enabled(self) -> bool:
+        """Check if cross-TU rules are decided over all analyzed files.
+        
+        Returns:
+            True if whole-program rules report from linked TU summaries
+        """
+        return bool(self.config.get("analysis", {}).get("whole_program", False))
+    
+    def get_summary_dir(self) -> Optional[str]:
+        """Get the directory per-TU whole-program summaries are written to.
+        
+        Returns:
+            Directory path or None
+        """
+        return self.config.get("analysis", {}).get("summary_dir")
+    
+    def get_shard(self) -> Optional[str]:
+        """Get the shard of the files this run analyzes.
+        
+        Returns:
+            "i/N" (the i-th of N shards, from 1) or None for all files
+        """
+        shard = self.config.get("analysis", {}).get("shard")
+        return str(shard) if shard else None
+    
+    def get_shard_timings(self) -> Optional[str]:
+        """Get the earlier report whose per-file timings balance the shards.
+        
+        Returns:
+            Path or None
+        """
+        return self.config.get("analysis", {}).get("shard_timings")
+    
+    def get_max_violations_per_rule(self) -> int:
+        """Get how many violations of one rule a report keeps.
+        
+        Returns:
+            Cap per rule (0 keeps every violation)
+        """
+        return max(int(self.config.get("analysis", {}).get("max_violations_per_rule", 0) or 0), 0)
+    
+    def is_memory_bounded(self) -> bool:
+        """Check if translation units are released as soon as their rules finish.
+        
+        Returns:
+            True if memory-bounded mode is enabled (disables the TU cache)
+        """
+        return bool(self.config.get("analysis", {}).get("memory_bounded", False))
+    
+    def get_memory_ceiling_bytes(self) -> int:
+        """Get the process size past which accumulated violations are compacted.
+        
+        Returns:
+            Ceiling in bytes (0 disables it)
+        """
+        return max(int(self.config.get("analysis", {}).get("memory_ceiling_mb", 0) or 0), 0) * 1024 * 1024
+    
+    def get_baseline_line_tolerance(self) -> int:
+        """Get how far a violation may move and still match its baseline entry.
+        
+        Returns:
+            Largest line shift, in lines
+        """
+        return int(self.config.get("analysis", {}).get("baseline_line_tolerance", 200))
+    
     def is_ai_enabled(self) -> bool:
         """Check if AI assistant is enabled.
         
@@ -173,6 +361,208 @@ class AnalyzerConfig:
             yaml.dump(self.config, f, default_flow_style=False, indent=2)
 
 
+class PatternMatcher:
+    """Finds which of many ``file_pattern`` strings occur in a path.
+    
+    Plain patterns keep their substring meaning and are matched together
+    with an Aho-Corasick automaton, so a path is scanned once no matter how
+    many patterns there are. Patterns containing glob characters are
+    matched with fnmatch against the whole path or any suffix starting
+    after a ``/``.
+    """
+    
+    GLOB_CHARS = frozenset("*?[")
+    
+    def __init__(self, patterns: List[str]):
+        """Build the matcher.
+        
+        Args:
+            patterns: Patterns, identified by their position in the list
+        """
+        self._goto: List[Dict[str, int]] = [{}]
+        self._fail: List[int] = [0]
+        self._output: List[List[int]] = [[]]
+        self._globs: List[Tuple[int, Any]] = []
+        
+        for pattern_id, pattern in enumerate(patterns):
+            if self.GLOB_CHARS.intersection(pattern):
+                regex = re.compile(r"(?:^|/)" + fnmatch.translate(pattern))
+                self._globs.append((pattern_id, regex))
+            else:
+                self._add_literal(pattern_id, pattern)
+        self._build_failure_links()
+    
+    def match(self, path: str) -> List[int]:
+        """Get the IDs of all patterns matching a path.
+        
+        Args:
+            path: File path
+            
+        Returns:
+            Sorted pattern IDs
+        """
+        matched = set(self._output[0])  # Empty patterns match everything
+        state = 0
+        for char in path:
+            while state and char not in self._goto[state]:
+                state = self._fail[state]
+            state = self._goto[state].get(char, 0)
+            matched.update(self._output[state])
+        
+        for pattern_id, regex in self._globs:
+            if regex.search(path):
+                matched.add(pattern_id)
+        return sorted(matched)
+    
+    def _add_literal(self, pattern_id: int, pattern: str) -> None:
+        state = 0
+        for char in pattern:
+            next_state = self._goto[state].get(char)
+            if next_state is None:
+                next_state = len(self._goto)
+                self._goto[state][char] = next_state
+                self._goto.append({})
+                self._fail.append(0)
+                self._output.append([])
+            state = next_state
+        self._output[state].append(pattern_id)
+    
+    def _build_failure_links(self) -> None:
+        queue = deque(self._goto[0].values())
+        while queue:
+            state = queue.popleft()
+            for char, next_state in self._goto[state].items():
+                queue.append(next_state)
+                fallback = self._fail[state]
+                while fallback and char not in self._goto[fallback]:
+                    fallback = self._fail[fallback]
+                self._fail[next_state] = self._goto[fallback].get(char, 0)
+                if self._fail[next_state] == next_state:
+                    self._fail[next_state] = 0
+                self._output[next_state] = (self._output[next_state] +
+                                            self._output[self._fail[next_state]])
+
+
+class LineIntervalMap:
+    """Maps a line to the first deviation whose line ranges cover it."""
+    
+    def __init__(self, deviations: List[Tuple[int, Deviation]]):
+        """Build the map.
+        
+        Args:
+            deviations: (order, deviation) pairs; lower order wins
+        """
+        self._whole_file: Optional[Tuple[int, Deviation]] = None
+        intervals = []
+        for order, deviation in deviations:
+            if not deviation.line_ranges:
+                if self._whole_file is None or order < self._whole_file[0]:
+                    self._whole_file = (order, deviation)
+                continue
+            for start_line, end_line in deviation.line_ranges:
+                intervals.append((int(start_line), int(end_line), order, deviation))
+        
+        # Split the covered lines into segments owned by a single deviation
+        boundaries = sorted(set([start for start, _, _, _ in intervals] +
+                                [end + 1 for _, end, _, _ in intervals]))
+        self._starts: List[int] = []
+        self._owners: List[Optional[Tuple[int, Deviation]]] = []
+        for segment_start in boundaries:
+            owner = None
+            for start, end, order, deviation in intervals:
+                if start <= segment_start <= end and (owner is None or order < owner[0]):
+                    owner = (order, deviation)
+            self._starts.append(segment_start)
+            self._owners.append(owner)
+    
+    def lookup(self, line: int) -> Optional[Deviation]:
+        """Get the deviation covering a line, or None."""
+        owner = None
+        position = bisect_right(self._starts, line) - 1
+        if position >= 0:
+            owner = self._owners[position]
+        if self._whole_file and (owner is None or self._whole_file[0] < owner[0]):
+            owner = self._whole_file
+        return owner[1] if owner else None
+
+
+class DeviationIndex:
+    """Active deviations indexed by rule ID, file pattern and line range.
+    
+    Expiry is checked once when the index is built. Per-file results are
+    memoized, so matching a violation is a dictionary lookup plus a bisect
+    over that file's line ranges.
+    """
+    
+    def __init__(self, deviations: List[Deviation], today: Optional[date] = None):
+        """Build the index.
+        
+        Args:
+            deviations: Deviations in priority order
+            today: Date used for expiry checks (default: today)
+        """
+        today = today or date.today()
+        self.expired: List[Deviation] = []
+        by_rule: Dict[str, List[Tuple[int, Deviation]]] = {}
+        for order, deviation in enumerate(deviations):
+            if self._is_expired(deviation, today):
+                self.expired.append(deviation)
+                continue
+            by_rule.setdefault(deviation.rule_id, []).append((order, deviation))
+        
+        self._rules: Dict[str, Tuple[PatternMatcher, List[Tuple[int, Deviation]]]] = {
+            rule_id: (PatternMatcher([d.file_pattern for _, d in entries]), entries)
+            for rule_id, entries in by_rule.items()
+        }
+        self._file_maps: Dict[Tuple[str, str], Optional[LineIntervalMap]] = {}
+    
+    def match(self, rule_id: str, file_path: str, line: int) -> Optional[Deviation]:
+        """Find the deviation suppressing a violation.
+        
+        Args:
+            rule_id: Rule identifier
+            file_path: Source file path
+            line: Violation line
+            
+        Returns:
+            Matching deviation or None
+        """
+        key = (rule_id, file_path)
+        if key not in self._file_maps:
+            entries = self._file_entries(rule_id, file_path)
+            self._file_maps[key] = LineIntervalMap(entries) if entries else None
+        
+        line_map = self._file_maps[key]
+        return line_map.lookup(line) if line_map else None
+    
+    def get_file_deviations(self, rule_id: str, file_path: str) -> List[Deviation]:
+        """Get the active deviations of a rule whose pattern matches a file."""
+        return [deviation for _, deviation in self._file_entries(rule_id, file_path)]
+    
+    def _file_entries(self, rule_id: str, file_path: str) -> List[Tuple[int, Deviation]]:
+        rule = self._rules.get(rule_id)
+        if rule is None:
+            return []
+        matcher, entries = rule
+        return [entries[pattern_id] for pattern_id in matcher.match(file_path)]
+    
+    @staticmethod
+    def _is_expired(deviation: Deviation, today: date) -> bool:
+        expiry = deviation.expiry_date
+        if not expiry:
+            return False
+        if isinstance(expiry, datetime):
+            expiry = expiry.date()
+        elif not isinstance(expiry, date):
+            try:
+                expiry = datetime.strptime(str(expiry), "%Y-%m-%d").date()
+            except ValueError:
+                print(f"Warning: Invalid expiry date '{expiry}' for deviation "
+                      f"{deviation.rule_id} ({deviation.file_pattern}); treating as active")
+                return False
+        return expiry < today
+
+
 class DeviationManager:
     """Manages rule deviations/suppressions."""
     
@@ -183,6 +573,9 @@ class DeviationManager:
             deviations_file: Path to deviations YAML file
         """
         self.deviations: List[Deviation] = []
+        self._index: Optional[DeviationIndex] = None
+        self._indexed_list: Optional[List[Deviation]] = None
+        self._indexed_count = 0
         
         if deviations_file:
             self.load_deviations(deviations_file)
@@ -221,21 +614,22 @@ class DeviationManager:
     def is_violation_suppressed(self, violation) -> tuple[bool, Optional[Deviation]]:
         """Check if a violation is suppressed by any deviation.
         
+        Expired deviations never suppress. When several deviations apply,
+        the first one in file order wins.
+        
         Args:
             violation: Violation to check
             
         Returns:
             Tuple of (is_suppressed, matching_deviation)
         """
-        for deviation in self.deviations:
-            if deviation.is_applicable(violation):
-                # TODO: Check expiry date
-                return True, deviation
-        
-        return False, None
+        deviation = self.get_index().match(
+            violation.rule_id, violation.location.file_path, violation.location.line
+        )
+        return deviation is not None, deviation
     
     def get_applicable_deviations(self, rule_id: str, file_path: str) -> List[Deviation]:
-        """Get all deviations applicable to a rule and file.
+        """Get all active deviations applicable to a rule and file.
         
         Args:
             rule_id: Rule identifier
@@ -244,13 +638,33 @@ class DeviationManager:
         Returns:
             List of applicable deviations
         """
-        applicable = []
-        for deviation in self.deviations:
-            if (deviation.rule_id == rule_id and 
-                deviation.file_pattern in file_path):
-                applicable.append(deviation)
+        return self.get_index().get_file_deviations(rule_id, file_path)
+    
+    def add_deviation(self, deviation: Deviation) -> None:
+        """Add a deviation.
+        
+        Args:
+            deviation: Deviation to add
+        """
+        self.deviations.append(deviation)
+        self._index = None
+    
+    def get_index(self) -> "DeviationIndex":
+        """Get the match index, rebuilding it if the deviations changed.
         
-        return applicable
+        Returns:
+            DeviationIndex over the active deviations
+        """
+        if (self._index is None or self._indexed_list is not self.deviations or
+                self._indexed_count != len(self.deviations)):
+            self._index = DeviationIndex(self.deviations)
+            self._indexed_list = self.deviations
+            self._indexed_count = len(self.deviations)
+            if self._index.expired:
+                print(f"Warning: Ignoring {len(self._index.expired)} expired deviation(s): "
+                      + ", ".join(f"{d.rule_id} ({d.file_pattern}, expired {d.expiry_date})"
+                                  for d in self._index.expired))
+        return self._index
     
     def create_sample_deviations_file(self, file_path: str) -> None:
         """Create a sample deviations file.
@@ -294,6 +708,8 @@ standards:
   - CERT
 
 # Rule configuration
+# Entries are rule IDs, rule packs (misra-c-2012, cert-c, or ones installed under the
+# static_analyzer.rule_packs entry point group) or standards; only enabled rules are loaded
 rules:
   enabled:
     - MISRA-C-2012-8.7
@@ -310,8 +726,25 @@ analysis:
     - "**/test/**"
     - "**/tests/**" 
     - "**/*_test.c"
-  max_violations_per_rule: 1000
+  max_violations_per_rule: 1000  # further violations of a rule are counted, not reported (0 = no cap)
   confidence_threshold: "low"  # low, medium, high
+  parallelism: 1  # worker processes, 0 = one per CPU
+  cache_dir: null  # e.g. ".static_analyzer_cache" to reuse results of unchanged files
+  precompiled_headers: []  # common vendor/HAL headers compiled once into a PCH
+  pch_dir: null  # where generated PCH files live (default: cache_dir/pch, else a temporary directory removed on exit)
+  compile_commands: null  # compile_commands.json to take per-file flags and TUs from
+  source_cache_mb: 64  # memory bound for source text kept for snippets
+  tu_cache_size: 0  # parsed translation units kept for reparse (the daemon uses 32)
+  lexical_prefilter: true  # skip parsing files no enabled rule can match textually
+  native_backend: false  # walk ASTs in C++ once static_analyzer/native is built (make native)
+  walk_scope: project  # all, project (skip system and excluded headers) or main_file
+  whole_program: false  # decide cross-TU rules (MISRA 8.7) over all files at once
+  summary_dir: null  # write per-TU summaries here for a later `link` step
+  shard: null  # "i/N" analyzes the i-th of N time-balanced shards (see `merge`)
+  shard_timings: null  # merged report of an earlier run, used to balance shards
+  baseline_line_tolerance: 200  # lines a violation may move and still match the baseline
+  memory_bounded: false  # release each TU right after its rules run (disables tu_cache_size)
+  memory_ceiling_mb: 0  # past this RSS, move violations to a temporary file (0 = off)
 
 # Output configuration
 output:
@@ -324,8 +757,15 @@ ai_assistant:
   enabled: false
   model: "gpt-4"
   api_key_env: "OPENAI_API_KEY"
-  max_tokens: 500
+  max_tokens: 1000  # Per violation; covers explanation, risk and fix
   temperature: 0.1
+  concurrency: 8  # Requests in flight at once
+  max_retries: 5  # Retries on rate limits and transient errors
+  retry_base_delay: 1.0  # Seconds; doubled per retry unless Retry-After is sent
+  response_cache: true  # Reuse responses for the same rule, model and code
+  response_cache_dir: null  # default: ~/.cache/static_analyzer/ai_responses
+  response_cache_ttl_days: 30
+  response_cache_max_entries: 10000
 """
 
 
@@ -0,0 +1,635 @@
+"""Resident analysis service that keeps analyzers warm between requests.
+
+Building a StaticAnalyzer loads libclang, creates an Index and registers
+every rule, and each new process starts with cold parse caches. The
+daemon keeps a few analyzers alive, keyed by configuration, and enables
+the parser's translation unit cache so files seen before are reparsed
+instead of parsed from scratch.
+
+Clients talk to it over a Unix socket, one JSON request and one JSON
+response per line::
+
+    {"method": "analyze", "params": {"files": ["/abs/main.c"]}}
+    {"ok": true, "result": {"report": {...}}}
+
+The "stream" method instead answers with one line per finished file and
+a final ``{"ok": true, "done": true}``.
+
+Services that should use the daemon when it runs call ``get_analyzer``,
+which falls back to a warm in-process analyzer otherwise.
+"""
+
+import copy
+import hashlib
+import json
+import os
+import socket
+import socketserver
+import threading
+import time
+from collections import OrderedDict
+from contextlib import contextmanager
+from typing import Any, Callable, Dict, Iterator, List, Optional, Tuple
+
+from .. import StaticAnalyzer, __version__
+from ..config import AnalyzerConfig
+from ..models import AnalysisReport, Violation
+
+SOCKET_ENV = "STATIC_ANALYZER_DAEMON"
+DEFAULT_SOCKET = os.path.join(os.path.expanduser("~"), ".cache", "static_analyzer", "daemon.sock")
+
+# Translation units cached per warm analyzer unless the config sets its own
+DEFAULT_TU_CACHE_SIZE = 32
+
+# Concurrent runs per configuration; each one holds its own analyzer
+DEFAULT_INSTANCES = 2
+
+
+class DaemonError(Exception):
+    """Raised when the daemon rejects a request or cannot be reached."""
+
+
+def get_socket_path(socket_path: Optional[str] = None) -> str:
+    """Resolve the daemon socket path.
+
+    Args:
+        socket_path: Explicit path (default: $STATIC_ANALYZER_DAEMON, then
+            ~/.cache/static_analyzer/daemon.sock)
+
+    Returns:
+        Socket path
+    """
+    return socket_path or os.environ.get(SOCKET_ENV) or DEFAULT_SOCKET
+
+
+class WarmAnalyzer:
+    """Long-lived StaticAnalyzers for one configuration.
+
+    A StaticAnalyzer (its parser and translation unit cache) serves one
+    run at a time, so each run borrows an idle instance. Up to
+    ``max_instances`` runs proceed at once; further runs wait for an
+    instance to be returned. The most recently returned instance is
+    lent first, as its caches are the warmest.
+    """
+
+    def __init__(self, analyzer: StaticAnalyzer,
+                 factory: Optional[Callable[[], StaticAnalyzer]] = None,
+                 max_instances: int = 1):
+        """Wrap an analyzer.
+
+        Args:
+            analyzer: First analyzer to keep warm
+            factory: Builds further instances of the same configuration
+                (without one, runs share ``analyzer`` one at a time)
+            max_instances: Instances that may run concurrently
+        """
+        self.analyzer = analyzer
+        self.factory = factory
+        self.max_instances = max(max_instances, 1) if factory else 1
+        self.created_at = time.time()
+        self.last_used = self.created_at
+        self.requests = 0
+        self._instances = [analyzer]
+        self._idle = [analyzer]
+        self._retired = False
+        self._available = threading.Condition()
+
+    @contextmanager
+    def session(self) -> Iterator[StaticAnalyzer]:
+        """Hold an analyzer for several calls, e.g. to wrap it in an IncrementalAnalyzer."""
+        analyzer = self._acquire()
+        try:
+            yield analyzer
+        finally:
+            self._release(analyzer)
+
+    def retire(self) -> None:
+        """Close idle instances now and busy ones when their run ends."""
+        with self._available:
+            self._retired = True
+            idle, self._idle = self._idle, []
+            for analyzer in idle:
+                self._instances.remove(analyzer)
+        for analyzer in idle:
+            analyzer.close()
+
+    def analyze_files(self, file_paths: List[str],
+                      enabled_rules: Optional[List[str]] = None) -> AnalysisReport:
+        """Analyze a list of source files (see StaticAnalyzer.analyze_files)."""
+        with self.session() as analyzer:
+            return analyzer.analyze_files(file_paths, enabled_rules)
+
+    def analyze_directory(self, directory: str, recursive: bool = True,
+                          enabled_rules: Optional[List[str]] = None) -> AnalysisReport:
+        """Analyze a directory (see StaticAnalyzer.analyze_directory)."""
+        with self.session() as analyzer:
+            return analyzer.analyze_directory(directory, recursive, enabled_rules=enabled_rules)
+
+    def analyze_compile_commands(self, compile_commands_path: str,
+                                 source_root: Optional[str] = None,
+                                 enabled_rules: Optional[List[str]] = None) -> AnalysisReport:
+        """Analyze a compilation database (see StaticAnalyzer.analyze_compile_commands)."""
+        with self.session() as analyzer:
+            return analyzer.analyze_compile_commands(compile_commands_path, source_root,
+                                                     enabled_rules)
+
+    def iter_violations(self, file_paths: List[str],
+                        enabled_rules: Optional[List[str]] = None,
+                        deadline: Optional[float] = None) -> Iterator[Tuple[str, List[Violation]]]:
+        """Yield each file's violations as it finishes (see StaticAnalyzer.iter_violations).
+
+        The analyzer stays held until the iterator is exhausted or closed.
+        If no instance frees up before the deadline, nothing is yielded.
+        """
+        analyzer = self._acquire(deadline)
+        if analyzer is None:
+            return
+        try:
+            yield from analyzer.iter_violations(file_paths, enabled_rules, deadline)
+        finally:
+            self._release(analyzer)
+
+    def _acquire(self, deadline: Optional[float] = None) -> Optional[StaticAnalyzer]:
+        """Borrow an idle instance, building one if the pool isn't full.
+
+        Args:
+            deadline: time.monotonic() after which to stop waiting
+
+        Returns:
+            The analyzer, or None if the deadline passed first
+        """
+        with self._available:
+            while not self._idle and len(self._instances) >= self.max_instances:
+                timeout = None if deadline is None else deadline - time.monotonic()
+                if timeout is not None and timeout <= 0:
+                    return None
+                self._available.wait(timeout)
+            self.requests += 1
+            self.last_used = time.time()
+            if self._idle:
+                return self._idle.pop()
+            # Reserve the slot, then build outside the lock
+            self._instances.append(None)
+
+        try:
+            analyzer = self.factory()
+        except BaseException:
+            with self._available:
+                self._instances.remove(None)
+                self._available.notify()
+            raise
+        with self._available:
+            self._instances[self._instances.index(None)] = analyzer
+        return analyzer
+
+    def _release(self, analyzer: StaticAnalyzer) -> None:
+        with self._available:
+            if self._retired:
+                self._instances.remove(analyzer)
+            else:
+                self._idle.append(analyzer)
+            self._available.notify()
+        if self._retired:
+            analyzer.close()
+
+    def get_stats(self) -> Dict[str, Any]:
+        """Get usage counters and translation unit cache statistics."""
+        with self._available:
+            instances = [analyzer for analyzer in self._instances if analyzer is not None]
+            busy = len(self._instances) - len(self._idle)
+            stats = {
+                "requests": self.requests,
+                "created_at": self.created_at,
+                "last_used": self.last_used,
+                "instances": len(self._instances),
+                "busy": busy
+            }
+        stats["tu_cache"] = [analyzer.ast_parser.get_tu_cache_stats() for analyzer in instances]
+        return stats
+
+
+class AnalysisService:
+    """Pool of warm analyzers keyed by configuration.
+
+    The same service backs the socket server and the in-process fallback
+    used when no daemon is running.
+    """
+
+    def __init__(self, max_analyzers: int = 4, tu_cache_size: int = DEFAULT_TU_CACHE_SIZE,
+                 instances: int = DEFAULT_INSTANCES):
+        """Initialize an empty pool.
+
+        Args:
+            max_analyzers: Distinct configurations kept warm; the least
+                recently used one is dropped beyond this
+            tu_cache_size: Translation unit cache size for analyzers whose
+                config leaves it at 0
+            instances: Runs of one configuration that may proceed at once
+        """
+        self.max_analyzers = max(max_analyzers, 1)
+        self.tu_cache_size = tu_cache_size
+        self.instances = max(instances, 1)
+        self.started_at = time.time()
+        self.requests = 0
+        self._analyzers: "OrderedDict[str, WarmAnalyzer]" = OrderedDict()
+        self._lock = threading.Lock()
+
+    def get(self, config: Optional[Dict[str, Any]] = None,
+            deviations_file: Optional[str] = None) -> WarmAnalyzer:
+        """Get the warm analyzer for a configuration, building it if needed.
+
+        Args:
+            config: Raw configuration dictionary (default: built-in defaults)
+            deviations_file: Deviations file; a changed file gets a new analyzer
+
+        Returns:
+            WarmAnalyzer for the configuration
+        """
+        key = self._analyzer_key(config, deviations_file)
+        with self._lock:
+            warm = self._analyzers.get(key)
+            if warm is not None:
+                self._analyzers.move_to_end(key)
+                return warm
+
+        # Build outside the pool lock; a concurrent build of the same key just loses
+        analyzer_config = AnalyzerConfig(copy.deepcopy(config) if config else None)
+        if not analyzer_config.get_tu_cache_size():
+            analyzer_config.config["analysis"]["tu_cache_size"] = self.tu_cache_size
+        def build() -> StaticAnalyzer:
+            return StaticAnalyzer(analyzer_config, deviations_file)
+
+        built = WarmAnalyzer(build(), build, self.instances)
+
+        evicted = []
+        with self._lock:
+            warm = self._analyzers.setdefault(key, built)
+            self._analyzers.move_to_end(key)
+            while len(self._analyzers) > self.max_analyzers:
+                evicted.append(self._analyzers.popitem(last=False)[1])
+        if warm is not built:
+            evicted.append(built)
+        for dropped in evicted:
+            dropped.retire()
+        return warm
+
+    def handle(self, method: str, params: Dict[str, Any]) -> Dict[str, Any]:
+        """Run one request.
+
+        Args:
+            method: "analyze", "status" or "ping"
+            params: Method parameters
+
+        Returns:
+            Result dictionary
+
+        Raises:
+            DaemonError: For an unknown method or invalid parameters
+        """
+        self._count_request()
+        if method == "ping":
+            return {"version": __version__, "pid": os.getpid()}
+        if method == "status":
+            return self.get_status()
+        if method == "analyze":
+            return {"report": self.analyze(params).to_dict(encode_json=True)}
+        raise DaemonError(f"Unknown method: {method}")
+
+    def analyze(self, params: Dict[str, Any]) -> AnalysisReport:
+        """Run an analysis request.
+
+        Args:
+            params: One of ``files``, ``directory`` or ``compile_commands``,
+                plus optional ``recursive``, ``source_root``,
+                ``enabled_rules``, ``config`` and ``deviations_file``.
+                Paths must be absolute.
+
+        Returns:
+            AnalysisReport
+        """
+        warm = self.get(params.get("config"), params.get("deviations_file"))
+        enabled_rules = params.get("enabled_rules")
+        if params.get("compile_commands"):
+            return warm.analyze_compile_commands(params["compile_commands"],
+                                                 params.get("source_root"), enabled_rules)
+        if params.get("directory"):
+            return warm.analyze_directory(params["directory"], params.get("recursive", True),
+                                          enabled_rules)
+        if params.get("files") is not None:
+            return warm.analyze_files(params["files"], enabled_rules)
+        raise DaemonError("analyze needs files, directory or compile_commands")
+
+    def iter_violations(self, params: Dict[str, Any]) -> Iterator[Tuple[str, List[Violation]]]:
+        """Run a streaming request.
+
+        Args:
+            params: ``files``, plus the optional analyze parameters and
+                ``time_budget``, the seconds after which to stop
+        """
+        self._count_request()
+        if params.get("files") is None:
+            raise DaemonError("stream needs files")
+        time_budget = params.get("time_budget")
+        deadline = None if time_budget is None else time.monotonic() + float(time_budget)
+        warm = self.get(params.get("config"), params.get("deviations_file"))
+        return warm.iter_violations(params["files"], params.get("enabled_rules"), deadline)
+
+    def get_status(self) -> Dict[str, Any]:
+        """Get uptime, request count and per-analyzer statistics."""
+        with self._lock:
+            pool = list(self._analyzers.items())
+            requests = self.requests
+        return {
+            "version": __version__,
+            "pid": os.getpid(),
+            "uptime_seconds": round(time.time() - self.started_at, 1),
+            "requests": requests,
+            "max_analyzers": self.max_analyzers,
+            "instances": self.instances,
+            "analyzers": {key: warm.get_stats() for key, warm in pool}
+        }
+
+    def _count_request(self) -> None:
+        with self._lock:
+            self.requests += 1
+
+    @staticmethod
+    def _analyzer_key(config: Optional[Dict[str, Any]], deviations_file: Optional[str]) -> str:
+        """Fingerprint a configuration and the deviations file's current version."""
+        deviations_mtime = None
+        if deviations_file:
+            try:
+                deviations_mtime = os.stat(deviations_file).st_mtime_ns
+            except OSError:
+                pass
+        payload = json.dumps([config or {}, deviations_file, deviations_mtime],
+                             sort_keys=True, default=str)
+        return hashlib.sha256(payload.encode("utf-8")).hexdigest()[:16]
+
+
+class _RequestHandler(socketserver.StreamRequestHandler):
+    """Reads one JSON request line and writes one JSON response line."""
+
+    def handle(self) -> None:
+        line = self.rfile.readline()
+        if not line:
+            return
+        try:
+            request = json.loads(line)
+            method = request.get("method", "")
+            if method == "stream":
+                self._stream(request.get("params") or {})
+                return
+            if method == "shutdown":
+                response = {"ok": True, "result": {}}
+                threading.Thread(target=self.server.shutdown, daemon=True).start()
+            else:
+                result = self.server.service.handle(method, request.get("params") or {})
+                response = {"ok": True, "result": result}
+        except Exception as e:
+            response = {"ok": False, "error": str(e)}
+        self._send(response)
+
+    def _stream(self, params: Dict[str, Any]) -> None:
+        results = self.server.service.iter_violations(params)
+        try:
+            for file_path, violations in results:
+                self._send({"ok": True, "file": file_path,
+                            "violations": [v.to_dict(encode_json=True) for v in violations]})
+            self._send({"ok": True, "done": True})
+        except (BrokenPipeError, ConnectionResetError):
+            # The client stopped reading; closing the iterator cancels queued files
+            return
+        finally:
+            results.close()
+
+    def _send(self, response: Dict[str, Any]) -> None:
+        self.wfile.write(json.dumps(response).encode("utf-8") + b"\n")
+        self.wfile.flush()
+
+
+class _DaemonServer(socketserver.ThreadingMixIn, socketserver.UnixStreamServer):
+    daemon_threads = True
+
+
+def serve(socket_path: Optional[str] = None,
+          service: Optional[AnalysisService] = None,
+          ready: Optional[threading.Event] = None) -> None:
+    """Serve analysis requests until a shutdown request arrives.
+
+    Args:
+        socket_path: Socket to listen on (see get_socket_path)
+        service: Service to expose (default: a new AnalysisService)
+        ready: Set once the socket accepts connections
+
+    Raises:
+        DaemonError: If another daemon already listens on the socket
+    """
+    socket_path = get_socket_path(socket_path)
+    if os.path.exists(socket_path):
+        if DaemonClient(socket_path).is_available():
+            raise DaemonError(f"A daemon is already running on {socket_path}")
+        # Left behind by a daemon that didn't shut down cleanly
+        os.unlink(socket_path)
+    os.makedirs(os.path.dirname(os.path.abspath(socket_path)), mode=0o700, exist_ok=True)
+
+    # Requests name arbitrary paths to read, so only the owner may connect;
+    # the socket is created with these permissions rather than changed later
+    previous_umask = os.umask(0o177)
+    try:
+        server = _DaemonServer(socket_path, _RequestHandler)
+    finally:
+        os.umask(previous_umask)
+    server.service = service or AnalysisService()
+    try:
+        if ready is not None:
+            ready.set()
+        server.serve_forever()
+    finally:
+        server.server_close()
+        try:
+            os.unlink(socket_path)
+        except OSError:
+            pass
+
+
+class DaemonClient:
+    """Client for a running analysis daemon."""
+
+    def __init__(self, socket_path: Optional[str] = None, timeout: float = 3600.0):
+        """Initialize the client.
+
+        Args:
+            socket_path: Daemon socket (see get_socket_path)
+            timeout: Seconds to wait for a response
+        """
+        self.socket_path = get_socket_path(socket_path)
+        self.timeout = timeout
+
+    def request(self, method: str, **params: Any) -> Dict[str, Any]:
+        """Send one request and return its result.
+
+        Raises:
+            DaemonError: If the daemon is unreachable or the request failed
+        """
+        try:
+            with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as connection:
+                connection.settimeout(self.timeout)
+                connection.connect(self.socket_path)
+                connection.sendall(json.dumps({"method": method, "params": params}).encode("utf-8")
+                                   + b"\n")
+                with connection.makefile("rb") as stream:
+                    line = stream.readline()
+        except OSError as e:
+            raise DaemonError(f"Cannot reach analysis daemon at {self.socket_path}: {str(e)}")
+
+        if not line:
+            raise DaemonError("Analysis daemon closed the connection")
+        response = json.loads(line)
+        if not response.get("ok"):
+            raise DaemonError(response.get("error", "Unknown daemon error"))
+        return response.get("result", {})
+
+    def iter_request(self, method: str, **params: Any) -> Iterator[Dict[str, Any]]:
+        """Send a streaming request and yield each response line until the last.
+
+        Raises:
+            DaemonError: If the daemon is unreachable or the request failed
+        """
+        try:
+            with socket.socket(socket.AF_UNIX, socket.SOCK_STREAM) as connection:
+                connection.settimeout(self.timeout)
+                connection.connect(self.socket_path)
+                connection.sendall(json.dumps({"method": method, "params": params}).encode("utf-8")
+                                   + b"\n")
+                with connection.makefile("rb") as stream:
+                    for line in stream:
+                        response = json.loads(line)
+                        if not response.get("ok"):
+                            raise DaemonError(response.get("error", "Unknown daemon error"))
+                        if response.get("done"):
+                            return
+                        yield response
+        except OSError as e:
+            raise DaemonError(f"Lost analysis daemon at {self.socket_path}: {str(e)}")
+        raise DaemonError("Analysis daemon closed the connection")
+
+    def is_available(self) -> bool:
+        """Check whether a daemon answers on the socket."""
+        if not os.path.exists(self.socket_path):
+            return False
+        try:
+            self.request("ping")
+            return True
+        except DaemonError:
+            return False
+
+    def status(self) -> Dict[str, Any]:
+        """Get the daemon's status."""
+        return self.request("status")
+
+    def shutdown(self) -> None:
+        """Ask the daemon to exit."""
+        self.request("shutdown")
+
+    def remote_analyzer(self, config: Optional[AnalyzerConfig] = None,
+                        deviations_file: Optional[str] = None) -> "RemoteAnalyzer":
+        """Get an analyzer facade that runs in the daemon.
+
+        Args:
+            config: Configuration to analyze with
+            deviations_file: Deviations file to apply
+
+        Returns:
+            RemoteAnalyzer
+        """
+        return RemoteAnalyzer(self, config.config if config else None, deviations_file)
+
+
+class RemoteAnalyzer:
+    """Runs StaticAnalyzer-style calls in the daemon and rebuilds the reports."""
+
+    def __init__(self, client: DaemonClient, config: Optional[Dict[str, Any]] = None,
+                 deviations_file: Optional[str] = None):
+        self.client = client
+        self.config = config
+        self.deviations_file = os.path.abspath(deviations_file) if deviations_file else None
+
+    def analyze_files(self, file_paths: List[str],
+                      enabled_rules: Optional[List[str]] = None) -> AnalysisReport:
+        """Analyze a list of source files in the daemon."""
+        return self._analyze(files=[os.path.abspath(path) for path in file_paths],
+                             enabled_rules=enabled_rules)
+
+    def analyze_directory(self, directory: str, recursive: bool = True,
+                          enabled_rules: Optional[List[str]] = None) -> AnalysisReport:
+        """Analyze a directory in the daemon."""
+        return self._analyze(directory=os.path.abspath(directory), recursive=recursive,
+                             enabled_rules=enabled_rules)
+
+    def analyze_compile_commands(self, compile_commands_path: str,
+                                 source_root: Optional[str] = None,
+                                 enabled_rules: Optional[List[str]] = None) -> AnalysisReport:
+        """Analyze a compilation database in the daemon."""
+        return self._analyze(compile_commands=os.path.abspath(compile_commands_path),
+                             source_root=os.path.abspath(source_root) if source_root else None,
+                             enabled_rules=enabled_rules)
+
+    def iter_violations(self, file_paths: List[str],
+                        enabled_rules: Optional[List[str]] = None,
+                        deadline: Optional[float] = None) -> Iterator[Tuple[str, List[Violation]]]:
+        """Yield each file's violations as the daemon finishes it; closing stops the daemon's run.
+
+        The deadline (a time.monotonic() value) is sent as the time left,
+        so the daemon stops on its own clock.
+        """
+        time_budget = None if deadline is None else max(deadline - time.monotonic(), 0)
+        responses = self.client.iter_request(
+            "stream", config=self.config, deviations_file=self.deviations_file,
+            files=[os.path.abspath(path) for path in file_paths], enabled_rules=enabled_rules,
+            time_budget=time_budget
+        )
+        try:
+            for response in responses:
+                yield response["file"], [Violation.from_dict(v) for v in response["violations"]]
+        finally:
+            responses.close()
+
+    def _analyze(self, **params: Any) -> AnalysisReport:
+        result = self.client.request("analyze", config=self.config,
+                                     deviations_file=self.deviations_file, **params)
+        return AnalysisReport.from_dict(result["report"])
+
+
+_local_service: Optional[AnalysisService] = None
+_local_service_lock = threading.Lock()
+
+
+def get_local_service() -> AnalysisService:
+    """Get the process-wide in-process service."""
+    global _local_service
+    with _local_service_lock:
+        if _local_service is None:
+            _local_service = AnalysisService()
+        return _local_service
+
+
+def get_analyzer(config: Optional[AnalyzerConfig] = None,
+                 deviations_file: Optional[str] = None,
+                 socket_path: Optional[str] = None):
+    """Get the analyzer a service should use.
+
+    Args:
+        config: Configuration to analyze with
+        deviations_file: Deviations file to apply
+        socket_path: Daemon socket (see get_socket_path)
+
+    Returns:
+        A RemoteAnalyzer when a daemon answers on the socket, otherwise a
+        WarmAnalyzer from this process's own pool. Both offer
+        analyze_files, analyze_directory and analyze_compile_commands.
+    """
+    client = DaemonClient(socket_path)
+    if client.is_available():
+        return client.remote_analyzer(config, deviations_file)
+    return get_local_service().get(config.config if config else None, deviations_file)
@@ -0,0 +1,279 @@
+"""Incremental commit analysis driven by a persisted include graph."""
+
+import dataclasses
+import hashlib
+import json
+import os
+import tempfile
+from pathlib import Path
+from typing import Dict, List, Optional, Set, Any, Tuple
+from ..models import AnalysisReport, Violation
+from ..cache import ResultCache
+
+
+class IncludeGraph:
+    """Which project files each translation unit includes.
+
+    Paths are stored relative to the repository root so a graph built in
+    one checkout can be reused in another. Only files inside the
+    repository are recorded; system headers can't change in a commit.
+    """
+
+    def __init__(self, includes: Optional[Dict[str, List[str]]] = None):
+        """Initialize the graph.
+
+        Args:
+            includes: Mapping of TU path to included file paths
+        """
+        self._includes: Dict[str, Set[str]] = {
+            tu: set(files) for tu, files in (includes or {}).items()
+        }
+        self._dependents: Optional[Dict[str, Set[str]]] = None
+
+    def set_includes(self, translation_unit: str, included_files: List[str]) -> None:
+        """Record the files a TU includes, replacing any previous entry."""
+        self._includes[translation_unit] = set(included_files)
+        self._dependents = None
+
+    def remove(self, translation_unit: str) -> None:
+        """Forget a TU."""
+        if self._includes.pop(translation_unit, None) is not None:
+            self._dependents = None
+
+    def get_includes(self, translation_unit: str) -> List[str]:
+        """Get the files a TU includes."""
+        return sorted(self._includes.get(translation_unit, ()))
+
+    def get_translation_units(self) -> List[str]:
+        """Get every TU in the graph."""
+        return sorted(self._includes)
+
+    def get_impacted(self, changed_files: List[str]) -> Set[str]:
+        """Get the TUs whose results a change can affect.
+
+        Args:
+            changed_files: Changed file paths
+
+        Returns:
+            Changed TUs plus every TU that includes a changed file
+        """
+        if self._dependents is None:
+            self._dependents = {}
+            for tu, files in self._includes.items():
+                for included in files:
+                    self._dependents.setdefault(included, set()).add(tu)
+
+        impacted = set()
+        for changed in changed_files:
+            if changed in self._includes:
+                impacted.add(changed)
+            impacted.update(self._dependents.get(changed, ()))
+        return impacted
+
+    def to_dict(self) -> Dict[str, List[str]]:
+        """Convert the graph to a JSON-compatible dictionary."""
+        return {tu: sorted(files) for tu, files in sorted(self._includes.items())}
+
+    @classmethod
+    def from_dict(cls, data: Dict[str, List[str]]) -> "IncludeGraph":
+        """Create a graph from its dictionary form."""
+        return cls(data)
+
+
+class IncrementalAnalyzer:
+    """Analyze a commit by re-checking only the TUs the change can affect.
+
+    For each analyzed commit the per-TU raw results and the include graph
+    are saved under ``state_dir``. Analyzing a later commit loads the
+    state of its base commit, re-analyzes the changed TUs and the TUs that
+    include a changed file, and reuses the stored results for the rest.
+    Without usable base state the whole tree is analyzed.
+    """
+
+    STATE_VERSION = 1
+
+    def __init__(self, analyzer, state_dir: str, max_states: int = 20):
+        """Initialize the incremental analyzer.
+
+        Args:
+            analyzer: StaticAnalyzer used for the actual analysis
+            state_dir: Directory holding per-repository commit state
+            max_states: Commit states kept per repository
+        """
+        self.analyzer = analyzer
+        self.state_dir = Path(state_dir)
+        self.max_states = max_states
+
+    def analyze_commit(self,
+                       repo_root: str,
+                       repo_id: str,
+                       commit_sha: str,
+                       changed_files: List[str],
+                       base_sha: Optional[str] = None,
+                       enabled_rules: Optional[List[str]] = None) -> AnalysisReport:
+        """Analyze a checked-out commit, reusing the base commit's results.
+
+        Args:
+            repo_root: Checkout of the commit
+            repo_id: Stable identifier of the repository (e.g. its URL)
+            commit_sha: Commit being analyzed
+            changed_files: Files changed since the base, relative to repo_root
+            base_sha: Commit whose state may be reused
+            enabled_rules: Optional list of rule IDs to run
+
+        Returns:
+            AnalysisReport covering the whole tree
+        """
+        repo_root = os.path.abspath(repo_root)
+        enabled_rules = self.analyzer.resolve_enabled_rules(enabled_rules)
+        fingerprint = self._get_fingerprint(enabled_rules)
+
+        source_files = self.analyzer.collect_source_files(repo_root)
+        relative_files = [self._relative(f, repo_root) for f in source_files]
+
+        state = self._load_state(repo_id, base_sha, fingerprint) if base_sha else None
+        if state is None:
+            graph = IncludeGraph()
+            previous_results: Dict[str, List[Dict[str, Any]]] = {}
+            impacted = set(relative_files)
+        else:
+            graph = IncludeGraph.from_dict(state["include_graph"])
+            previous_results = state["results"]
+            changed = [os.path.normpath(f) for f in changed_files]
+            impacted = graph.get_impacted(changed)
+            # New TUs and TUs that failed last time have no stored results
+            impacted.update(f for f in relative_files if f not in previous_results)
+
+        to_analyze = [f for f, rel in zip(source_files, relative_files) if rel in impacted]
+        fresh_results: Dict[str, List[Violation]] = {}
+        for file_path, violations, stats in self.analyzer.iter_file_results(to_analyze, enabled_rules):
+            relative = self._relative(file_path, repo_root)
+            fresh_results[relative] = violations
+            graph.set_includes(relative, [
+                self._relative(f, repo_root) for f in stats.get("includes", [])
+                if self._is_inside(f, repo_root)
+            ])
+
+        # Drop deleted and failed TUs so they are retried next time
+        current = set(relative_files)
+        for tu in graph.get_translation_units():
+            if tu not in current or (tu in impacted and tu not in fresh_results):
+                graph.remove(tu)
+
+        stored_results: Dict[str, List[Dict[str, Any]]] = {}
+        merged: List[Tuple[str, List[Violation], Dict[str, Any]]] = []
+        for file_path, relative in zip(source_files, relative_files):
+            if relative in fresh_results:
+                violations = fresh_results[relative]
+                stored_results[relative] = [self._store_violation(v, repo_root)
+                                            for v in violations]
+            elif relative in previous_results and relative not in impacted:
+                stored_results[relative] = previous_results[relative]
+                violations = [self._load_violation(v, repo_root)
+                              for v in previous_results[relative]]
+            else:
+                continue
+            merged.append((file_path, violations, {}))
+
+        report = self.analyzer.build_report(
+            merged, enabled_rules, files_analyzed=len(merged),
+            total_files_provided=len(source_files)
+        )
+        report.metadata["incremental"] = {
+            "commit": commit_sha,
+            "base_commit": base_sha if state is not None else None,
+            "full_analysis": state is None,
+            "reanalyzed_files": sorted(fresh_results),
+            "reused_files": len(merged) - len(fresh_results)
+        }
+
+        self._save_state(repo_id, commit_sha, {
+            "version": self.STATE_VERSION,
+            "commit": commit_sha,
+            "fingerprint": fingerprint,
+            "include_graph": graph.to_dict(),
+            "results": stored_results
+        })
+        return report
+
+    def _get_fingerprint(self, enabled_rules: List[str]) -> str:
+        """Identify the settings stored results are valid for."""
+        from .. import __version__
+        config = self.analyzer.config
+        return ResultCache.compute_fingerprint(
+            enabled_rules,
+            self.analyzer.ast_parser.include_paths,
+            __version__,
+            extra={
+                "standards": [s.value for s in config.get_enabled_standards()],
+                "compile_commands": config.get_compile_commands()
+            }
+        )
+
+    def _repo_dir(self, repo_id: str) -> Path:
+        return self.state_dir / hashlib.sha256(repo_id.encode("utf-8")).hexdigest()[:16]
+
+    def _load_state(self, repo_id: str, commit_sha: str,
+                    fingerprint: str) -> Optional[Dict[str, Any]]:
+        """Load a commit's state if it was made with the same settings."""
+        state_path = self._repo_dir(repo_id) / f"{commit_sha}.json"
+        if not state_path.exists():
+            return None
+        try:
+            with open(state_path, "r", encoding="utf-8") as f:
+                state = json.load(f)
+        except (OSError, ValueError) as e:
+            print(f"Warning: Could not read incremental state {state_path}: {str(e)}")
+            return None
+
+        if state.get("version") != self.STATE_VERSION or state.get("fingerprint") != fingerprint:
+            return None
+        return state
+
+    def _save_state(self, repo_id: str, commit_sha: str, state: Dict[str, Any]) -> None:
+        """Write a commit's state and evict the oldest states."""
+        repo_dir = self._repo_dir(repo_id)
+        try:
+            repo_dir.mkdir(parents=True, exist_ok=True)
+            fd, tmp_path = tempfile.mkstemp(dir=repo_dir, suffix=".tmp")
+            with os.fdopen(fd, "w", encoding="utf-8") as f:
+                json.dump(state, f)
+            os.replace(tmp_path, repo_dir / f"{commit_sha}.json")
+
+            states = sorted(repo_dir.glob("*.json"), key=lambda p: p.stat().st_mtime)
+            for old_state in states[:-self.max_states]:
+                old_state.unlink()
+        except OSError as e:
+            print(f"Warning: Could not save incremental state for {commit_sha}: {str(e)}")
+
+    @staticmethod
+    def _is_inside(file_path: str, repo_root: str) -> bool:
+        path = os.path.abspath(file_path)
+        return path == repo_root or path.startswith(repo_root.rstrip(os.sep) + os.sep)
+
+    @classmethod
+    def _relative(cls, file_path: str, repo_root: str) -> str:
+        if cls._is_inside(file_path, repo_root):
+            return os.path.relpath(os.path.abspath(file_path), repo_root)
+        return file_path
+
+    @classmethod
+    def _store_violation(cls, violation: Violation, repo_root: str) -> Dict[str, Any]:
+        """Serialize a violation with its path made checkout-independent."""
+        location = dataclasses.replace(
+            violation.location,
+            file_path=cls._relative(violation.location.file_path, repo_root)
+        )
+        return dataclasses.replace(violation, location=location).to_dict(encode_json=True)
+
+    @staticmethod
+    def _load_violation(data: Dict[str, Any], repo_root: str) -> Violation:
+        """Deserialize a stored violation into the current checkout."""
+        violation = Violation.from_dict(data)
+        file_path = violation.location.file_path
+        if not os.path.isabs(file_path):
+            location = dataclasses.replace(
+                violation.location, file_path=os.path.join(repo_root, file_path)
+            )
+            violation = dataclasses.replace(violation, location=location)
+        return violation
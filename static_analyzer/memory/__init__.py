@@ -0,0 +1,110 @@
+"""Bounding the memory of large analysis runs.
+
+Three mechanisms, all driven by the ``analysis`` config section:
+
+- ``max_violations_per_rule`` caps how many violations of one rule a
+  report keeps; the rest are counted, not stored.
+- ``memory_bounded`` releases each translation unit as soon as its rules
+  finish (no translation unit cache, a collection after every file).
+- ``memory_ceiling_mb`` writes the violations a report has accumulated
+  to a temporary NDJSON file once the process grows past the ceiling
+  (see ``reports.SpillReportWriter``). Later violations go straight to
+  the file, and the finished report's ``violations`` read them back from
+  it one at a time instead of holding them.
+"""
+
+import os
+from collections import Counter
+from typing import Any, Dict, List, Optional
+
+from ..models import Violation
+
+
+def current_rss_bytes() -> Optional[int]:
+    """Get the resident set size of this process.
+
+    Returns:
+        Bytes, or None where it cannot be measured. Without /proc this is
+        the peak size so far, which only ever grows.
+    """
+    try:
+        with open("/proc/self/statm", "r") as f:
+            return int(f.read().split()[1]) * os.sysconf("SC_PAGE_SIZE")
+    except (OSError, ValueError, IndexError):
+        pass
+    try:
+        import resource
+        import sys
+        peak = resource.getrusage(resource.RUSAGE_SELF).ru_maxrss
+        return peak if sys.platform == "darwin" else peak * 1024
+    except (ImportError, ValueError):
+        return None
+
+
+class ViolationLimiter:
+    """Keeps at most a fixed number of violations per rule."""
+
+    def __init__(self, max_per_rule: int):
+        """Initialize the limiter.
+
+        Args:
+            max_per_rule: Cap per rule ID; 0 keeps everything
+        """
+        self.max_per_rule = max_per_rule
+        self.kept: Counter = Counter()
+        self.dropped: Counter = Counter()
+
+    def admit(self, violations: List[Violation]) -> List[Violation]:
+        """Get the violations still under their rule's cap.
+
+        Args:
+            violations: Violations in report order
+
+        Returns:
+            Violations to keep; the others are counted as dropped
+        """
+        if self.max_per_rule <= 0:
+            return violations
+        admitted = []
+        for violation in violations:
+            if self.kept[violation.rule_id] < self.max_per_rule:
+                self.kept[violation.rule_id] += 1
+                admitted.append(violation)
+            else:
+                self.dropped[violation.rule_id] += 1
+        return admitted
+
+    @property
+    def total_dropped(self) -> int:
+        return sum(self.dropped.values())
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Describe what was dropped, for report metadata."""
+        return {
+            "max_per_rule": self.max_per_rule,
+            "total": self.total_dropped,
+            "by_rule": dict(sorted(self.dropped.items()))
+        }
+
+
+class MemoryCeiling:
+    """Tells when the process has grown past a size limit."""
+
+    def __init__(self, max_bytes: int):
+        """Initialize the ceiling.
+
+        Args:
+            max_bytes: Limit on the resident set size; 0 disables the check
+        """
+        self.max_bytes = max_bytes
+        self.peak_bytes = 0
+
+    def exceeded(self) -> bool:
+        """Measure the process and check it against the limit."""
+        if self.max_bytes <= 0:
+            return False
+        rss = current_rss_bytes()
+        if rss is None:
+            return False
+        self.peak_bytes = max(self.peak_bytes, rss)
+        return rss > self.max_bytes
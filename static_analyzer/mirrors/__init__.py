@@ -0,0 +1,300 @@
+"""Local bare-mirror cache of remote repositories with per-analysis worktrees."""
+
+import fcntl
+import hashlib
+import os
+import shutil
+import subprocess
+import tempfile
+import threading
+from contextlib import contextmanager
+from pathlib import Path
+from typing import Dict, Iterator, List, Optional, Tuple
+
+
+# Sparse-checkout patterns for the files analysis needs
+DEFAULT_CHECKOUT_PATTERNS = [
+    "*.c", "*.cpp", "*.cc", "*.cxx", "*.h", "*.hpp", "*.hh", "*.hxx",
+    "compile_commands.json", "*.yaml", "*.yml"
+]
+
+
+class GitError(Exception):
+    """A git command failed."""
+
+
+class Checkout:
+    """A worktree of one commit, valid inside ``MirrorCache.checkout``."""
+
+    def __init__(self, path: str, commit_sha: str, ref: str, parent_sha: Optional[str]):
+        self.path = path
+        self.commit_sha = commit_sha
+        self.ref = ref
+        self.parent_sha = parent_sha
+
+
+class MirrorCache:
+    """One bare mirror per remote, updated with ``git fetch``.
+
+    Each analysis gets a detached, sparse worktree of the commit it needs
+    instead of a fresh clone. Mirrors are guarded by a file lock so that
+    several threads or server processes can share the cache directory.
+    When the cache grows past ``max_bytes`` the least recently used
+    mirrors are removed.
+    """
+
+    DEFAULT_MAX_BYTES = 2 * 1024 * 1024 * 1024
+    GIT_TIMEOUT = 600
+
+    _shared: Optional["MirrorCache"] = None
+    _shared_lock = threading.Lock()
+
+    def __init__(self, cache_dir: str,
+                 max_bytes: int = DEFAULT_MAX_BYTES,
+                 token: Optional[str] = None):
+        """Initialize the mirror cache.
+
+        Args:
+            cache_dir: Directory holding the bare mirrors
+            max_bytes: Size above which unused mirrors are evicted
+            token: GitHub token used for fetches (never written to disk)
+        """
+        self.cache_dir = Path(cache_dir)
+        self.max_bytes = max_bytes
+        self.token = token
+        self._thread_locks: Dict[str, threading.Lock] = {}
+        self._thread_locks_guard = threading.Lock()
+
+    @classmethod
+    def shared(cls) -> "MirrorCache":
+        """Get the process-wide cache configured from the environment.
+
+        Uses MIRROR_CACHE_DIR, MIRROR_CACHE_MAX_MB and GITHUB_TOKEN.
+        """
+        with cls._shared_lock:
+            if cls._shared is None:
+                cache_dir = os.environ.get(
+                    "MIRROR_CACHE_DIR",
+                    os.path.join(os.path.expanduser("~"), ".cache", "static_analyzer", "mirrors")
+                )
+                max_mb = int(os.environ.get("MIRROR_CACHE_MAX_MB", "2048"))
+                cls._shared = cls(cache_dir, max_mb * 1024 * 1024,
+                                  os.environ.get("GITHUB_TOKEN") or None)
+            return cls._shared
+
+    @contextmanager
+    def checkout(self, repo_url: str, ref: Optional[str] = None,
+                 patterns: Optional[List[str]] = None) -> Iterator[Checkout]:
+        """Check out a commit of a remote into a temporary worktree.
+
+        Args:
+            repo_url: Remote repository URL
+            ref: Branch, tag or commit SHA (default: the remote's HEAD)
+            patterns: Sparse-checkout patterns (default: C/C++ sources,
+                compilation databases and YAML config). An empty list
+                checks out everything.
+
+        Yields:
+            Checkout of the resolved commit, removed on exit
+        """
+        mirror = self._mirror_path(repo_url)
+        worktree = tempfile.mkdtemp(prefix="analysis-")
+        try:
+            with self._locked(mirror):
+                self._update_mirror(repo_url, mirror, ref)
+                commit_sha = self._resolve(mirror, ref or "HEAD")
+                if commit_sha is None:
+                    raise GitError(f"Unknown ref '{ref}' in {repo_url}")
+                parent_sha = self._resolve(mirror, f"{commit_sha}^")
+                ref_name = ref or self._default_branch(mirror)
+
+                self._git(["worktree", "add", "--detach", "--no-checkout", worktree, commit_sha],
+                          git_dir=mirror)
+            self._populate(worktree, DEFAULT_CHECKOUT_PATTERNS if patterns is None else patterns)
+            (mirror / "last_used").touch()
+
+            yield Checkout(worktree, commit_sha, ref_name, parent_sha)
+        finally:
+            with self._locked(mirror):
+                if mirror.exists():
+                    self._git(["worktree", "remove", "--force", worktree],
+                              git_dir=mirror, check=False)
+                    self._git(["worktree", "prune"], git_dir=mirror, check=False)
+            shutil.rmtree(worktree, ignore_errors=True)
+            self.evict()
+
+    def resolve_remote(self, repo_url: str, ref: Optional[str] = None) -> Tuple[str, str]:
+        """Resolve a ref of a remote to a commit without cloning or fetching.
+
+        Args:
+            repo_url: Remote repository URL
+            ref: Branch or tag (default: the remote's HEAD); a full commit
+                SHA is returned as is
+
+        Returns:
+            (commit_sha, ref_name), ref_name being the default branch when
+            no ref is given
+
+        Raises:
+            GitError: If the remote cannot be reached or has no such ref
+        """
+        if ref and len(ref) == 40 and self._looks_like_sha(ref):
+            return ref.lower(), ref
+        # An annotated tag resolves to its tag object; the peeled entry is the commit
+        candidates = ([f"refs/tags/{ref}^{{}}", f"refs/heads/{ref}", f"refs/tags/{ref}"]
+                      if ref else ["HEAD"])
+        result = self._git(["ls-remote", "--symref", self._authenticated_url(repo_url)] + candidates)
+
+        ref_name = ref or "HEAD"
+        shas: Dict[str, str] = {}
+        for line in result.stdout.splitlines():
+            target, _, name = line.partition("\t")
+            if target.startswith("ref: "):
+                if name == "HEAD" and target[5:].startswith("refs/heads/"):
+                    ref_name = target[len("ref: refs/heads/"):]
+            elif name:
+                shas[name] = target
+        for name in candidates:
+            if name in shas:
+                return shas[name], ref_name
+        raise GitError(f"Unknown ref '{ref or 'HEAD'}' in {repo_url}")
+
+    def evict(self) -> None:
+        """Remove least recently used mirrors until under the size bound."""
+        if not self.cache_dir.exists():
+            return
+
+        mirrors = [p for p in self.cache_dir.iterdir() if p.suffix == ".git" and p.is_dir()]
+        sizes = {p: self._directory_size(p) for p in mirrors}
+        total = sum(sizes.values())
+        mirrors.sort(key=self._last_used)
+        for mirror in mirrors:
+            if total <= self.max_bytes:
+                break
+            if self._try_remove(mirror):
+                total -= sizes[mirror]
+
+    def _update_mirror(self, repo_url: str, mirror: Path, ref: Optional[str]) -> None:
+        """Create the mirror, or fetch into it if it already exists."""
+        fetch_url = self._authenticated_url(repo_url)
+        if not (mirror / "HEAD").exists():
+            shutil.rmtree(mirror, ignore_errors=True)
+            self.cache_dir.mkdir(parents=True, exist_ok=True)
+            self._git(["clone", "--mirror", "--quiet", fetch_url, str(mirror)])
+            # Keep credentials out of the on-disk config
+            self._git(["remote", "set-url", "origin", repo_url], git_dir=mirror)
+            # Sparse patterns are stored per worktree, not in the shared config
+            # (core.bare moves to the main config.worktree so worktrees aren't bare too)
+            self._git(["config", "core.repositoryformatversion", "1"], git_dir=mirror)
+            self._git(["config", "extensions.worktreeConfig", "true"], git_dir=mirror)
+            self._git(["config", "--unset", "core.bare"], git_dir=mirror)
+            self._git(["config", "--worktree", "core.bare", "true"], git_dir=mirror)
+            return
+
+        # A commit that is already present never changes, so skip the fetch
+        if ref and self._looks_like_sha(ref) and self._resolve(mirror, ref):
+            return
+
+        self._git(["fetch", "--prune", "--quiet", fetch_url,
+                   "+refs/heads/*:refs/heads/*", "+refs/tags/*:refs/tags/*"], git_dir=mirror)
+        if ref and self._looks_like_sha(ref) and not self._resolve(mirror, ref):
+            # Commits only reachable from pull request refs etc.
+            self._git(["fetch", "--quiet", fetch_url, ref], git_dir=mirror, check=False)
+
+    def _populate(self, worktree: str, patterns: List[str]) -> None:
+        """Fill a no-checkout worktree, limited to the sparse patterns."""
+        if patterns:
+            self._git(["sparse-checkout", "set", "--no-cone"] + patterns, cwd=worktree)
+        self._git(["read-tree", "-mu", "HEAD"], cwd=worktree)
+
+    def _resolve(self, mirror: Path, ref: str) -> Optional[str]:
+        """Resolve a ref to a commit SHA, or None if it doesn't exist."""
+        result = self._git(["rev-parse", "--verify", "--quiet", f"{ref}^{{commit}}"],
+                           git_dir=mirror, check=False)
+        return result.stdout.strip() if result.returncode == 0 else None
+
+    def _default_branch(self, mirror: Path) -> str:
+        result = self._git(["symbolic-ref", "--short", "HEAD"], git_dir=mirror, check=False)
+        return result.stdout.strip() if result.returncode == 0 else "HEAD"
+
+    def _git(self, args: List[str], git_dir: Optional[Path] = None,
+             check: bool = True, cwd: Optional[str] = None) -> subprocess.CompletedProcess:
+        cmd = ["git"]
+        if git_dir is not None:
+            cmd += ["--git-dir", str(git_dir)]
+        cmd += args
+        try:
+            result = subprocess.run(cmd, capture_output=True, text=True,
+                                    cwd=cwd, timeout=self.GIT_TIMEOUT)
+        except subprocess.TimeoutExpired:
+            raise GitError(f"Timeout running git {args[0]}")
+        if check and result.returncode != 0:
+            stderr = result.stderr.strip()
+            if self.token:
+                stderr = stderr.replace(self.token, "***")
+            raise GitError(f"git {args[0]} failed: {stderr}")
+        return result
+
+    def _authenticated_url(self, repo_url: str) -> str:
+        if self.token and repo_url.startswith("https://github.com"):
+            return repo_url.replace("https://", f"https://{self.token}@", 1)
+        return repo_url
+
+    def _mirror_path(self, repo_url: str) -> Path:
+        normalized = repo_url.rstrip("/")
+        if normalized.endswith(".git"):
+            normalized = normalized[:-4]
+        digest = hashlib.sha256(normalized.lower().encode("utf-8")).hexdigest()[:16]
+        return self.cache_dir / f"{digest}.git"
+
+    @contextmanager
+    def _locked(self, mirror: Path) -> Iterator[None]:
+        """Hold the mirror's thread lock and its cross-process file lock."""
+        with self._thread_locks_guard:
+            thread_lock = self._thread_locks.setdefault(str(mirror), threading.Lock())
+        with thread_lock:
+            self.cache_dir.mkdir(parents=True, exist_ok=True)
+            with open(f"{mirror}.lock", "w") as lock_file:
+                fcntl.flock(lock_file, fcntl.LOCK_EX)
+                try:
+                    yield
+                finally:
+                    fcntl.flock(lock_file, fcntl.LOCK_UN)
+
+    def _try_remove(self, mirror: Path) -> bool:
+        """Remove a mirror unless another analysis is using it."""
+        with open(f"{mirror}.lock", "w") as lock_file:
+            try:
+                fcntl.flock(lock_file, fcntl.LOCK_EX | fcntl.LOCK_NB)
+            except OSError:
+                return False
+            try:
+                worktrees = mirror / "worktrees"
+                if worktrees.exists() and any(worktrees.iterdir()):
+                    return False
+                shutil.rmtree(mirror, ignore_errors=True)
+                return True
+            finally:
+                fcntl.flock(lock_file, fcntl.LOCK_UN)
+
+    @staticmethod
+    def _last_used(mirror: Path) -> float:
+        try:
+            return (mirror / "last_used").stat().st_mtime
+        except OSError:
+            return 0.0
+
+    @staticmethod
+    def _directory_size(path: Path) -> int:
+        total = 0
+        for root, _, files in os.walk(path):
+            for name in files:
+                try:
+                    total += os.path.getsize(os.path.join(root, name))
+                except OSError:
+                    pass
+        return total
+
+    @staticmethod
+    def _looks_like_sha(ref: str) -> bool:
+        return 7 <= len(ref) <= 40 and all(c in "0123456789abcdef" for c in ref.lower())
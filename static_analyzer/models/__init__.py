@@ -77,6 +77,10 @@ class Violation:
     source_context: Optional[str] = None
     metadata: Optional[Dict[str, Any]] = None
     
+    # Name of the function the violation is in, if any; part of the
+    # baseline fingerprint, so it survives lines shifting around it
+    enclosing_function: Optional[str] = None
+    
     # AI-generated fields (optional)
     ai_explanation: Optional[str] = None
     ai_risk_summary: Optional[str] = None
@@ -131,40 +135,54 @@ class AnalysisReport:
 
     def generate_summary(self) -> None:
         """Generate summary statistics."""
-        total_violations = len(self.violations)
-        
-        severity_counts = {
-            severity.value: len(self.get_violations_by_severity(severity))
-            for severity in Severity
-        }
-        
-        standard_counts = {
-            standard.value: len(self.get_violations_by_standard(standard))
-            for standard in Standard
-        }
-        
-        rule_counts = {}
-        for violation in self.violations:
-            rule_counts[violation.rule_id] = rule_counts.get(violation.rule_id, 0) + 1
-
-        self.summary = {
-            "total_violations": total_violations,
-            "by_severity": severity_counts,
-            "by_standard": standard_counts,
-            "by_rule": rule_counts,
-            "files_analyzed": len(set(v.location.file_path for v in self.violations))
-        }
+        summary = ReportSummary()
+        summary.add_violations(self.violations)
+        self.summary = summary.to_dict()
 
     def to_json_file(self, file_path: str) -> None:
         """Save report to JSON file."""
         self.generate_summary()
         with open(file_path, 'w') as f:
-            json.dump(self.to_dict(), f, indent=2)
+            json.dump(self.to_dict(encode_json=True), f, indent=2)
 
     def to_json(self) -> str:
         """Convert report to JSON string."""
         self.generate_summary()
-        return json.dumps(self.to_dict(), indent=2)
+        return json.dumps(self.to_dict(encode_json=True), indent=2)
+
+
+class ReportSummary:
+    """Summary counters updated one violation at a time."""
+    
+    def __init__(self) -> None:
+        self.total_violations = 0
+        self.by_severity = {severity.value: 0 for severity in Severity}
+        self.by_standard = {standard.value: 0 for standard in Standard}
+        self.by_rule: Dict[str, int] = {}
+        self._files = set()
+    
+    def add_violation(self, violation: Violation) -> None:
+        """Count a violation."""
+        self.total_violations += 1
+        self.by_severity[violation.severity.value] += 1
+        self.by_standard[violation.standard.value] += 1
+        self.by_rule[violation.rule_id] = self.by_rule.get(violation.rule_id, 0) + 1
+        self._files.add(violation.location.file_path)
+    
+    def add_violations(self, violations: List[Violation]) -> None:
+        """Count several violations."""
+        for violation in violations:
+            self.add_violation(violation)
+    
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert counters to the report summary format."""
+        return {
+            "total_violations": self.total_violations,
+            "by_severity": dict(self.by_severity),
+            "by_standard": dict(self.by_standard),
+            "by_rule": dict(self.by_rule),
+            "files_analyzed": len(self._files)
+        }
 
 
 @dataclass_json
@@ -0,0 +1,140 @@
+"""Optional compiled backend for the rule engine's AST walk.
+
+Every ``cursor.kind`` and ``get_children()`` in a Python walk is a ctypes
+call into libclang, which dominates analysis time on large translation
+units. The ``_native`` extension (built from walker.cpp, see
+CMakeLists.txt here or ``make native``) walks the unit in C++ and hands
+back only the cursors the enabled rules dispatch on, together with their
+enclosing function. It can also evaluate rules that declare a
+``native_check`` entirely in C++.
+
+The extension does not link against libclang. It receives the address
+of ``clang_visitChildren`` from the library clang.cindex loaded, so both
+always agree on the libclang copy and on the cursor layout. The engine
+only uses it when ``analysis.native_backend`` is set; when the extension
+is not built, ``get_native_walker`` returns None and the engine keeps
+its Python walk.
+"""
+
+import ctypes
+from typing import Dict, Iterable, List, Optional, Sequence, Tuple
+
+from clang.cindex import Cursor, TranslationUnit, conf
+
+try:
+    from . import _native
+except ImportError:
+    _native = None
+
+
+class NativeWalk:
+    """Result of one native walk over a translation unit."""
+
+    def __init__(self, nodes: List[Tuple[Cursor, Optional[Cursor]]],
+                 check_matches: Dict[str, List[Cursor]], nodes_visited: int):
+        """Initialize the result.
+
+        Args:
+            nodes: (cursor, enclosing function or None) for every node of a
+                requested kind, in pre-order
+            check_matches: Cursors flagged by each requested native check
+            nodes_visited: Number of nodes the walk visited
+        """
+        self.nodes = nodes
+        self.check_matches = check_matches
+        self.nodes_visited = nodes_visited
+
+
+class NativeWalker:
+    """Walks translation units through the compiled extension."""
+
+    def __init__(self, module):
+        """Initialize the walker.
+
+        Args:
+            module: The loaded ``_native`` extension
+        """
+        self._module = module
+        self._visit_children = ctypes.cast(conf.lib.clang_visitChildren, ctypes.c_void_p).value
+        self.checks = frozenset(module.CHECKS)
+
+    def walk(self,
+             translation_unit: TranslationUnit,
+             kinds: Iterable[int],
+             function_kinds: Iterable[int],
+             checks: Sequence[str] = (),
+             roots: Optional[List[Cursor]] = None) -> NativeWalk:
+        """Walk a translation unit natively.
+
+        Args:
+            translation_unit: Unit to walk
+            kinds: Cursor kind IDs whose nodes are returned
+            function_kinds: Cursor kind IDs that open a function body
+            checks: Native checks to evaluate (see ``checks``)
+            roots: Top-level declarations to walk in place of the whole
+                unit, which is then visited on its own
+
+        Returns:
+            NativeWalk with the nodes in the same order as
+            ASTTraverser.walk_with_enclosing_function
+        """
+        kinds = list(kinds)
+        unit_cursor = translation_unit.cursor
+        root_records = (bytes(unit_cursor) if roots is None
+                        else b"".join(bytes(root) for root in roots))
+        matches, match_functions, functions, check_records, nodes_visited = self._module.walk(
+            self._visit_children, root_records,
+            kinds, list(function_kinds), list(checks)
+        )
+
+        function_cursors = self._cursors(functions, translation_unit)
+        function_indexes = memoryview(match_functions).cast("i")
+        nodes = [
+            (cursor, function_cursors[index] if index >= 0 else None)
+            for cursor, index in zip(self._cursors(matches, translation_unit), function_indexes)
+        ]
+        if roots is not None:
+            nodes_visited += 1
+            if unit_cursor.kind.value in kinds:
+                nodes.insert(0, (unit_cursor, None))
+        check_matches = {name: self._cursors(records, translation_unit)
+                         for name, records in check_records.items()}
+        return NativeWalk(nodes, check_matches, nodes_visited)
+
+    @staticmethod
+    def _cursors(records: bytes, translation_unit: TranslationUnit) -> List[Cursor]:
+        """Turn packed CXCursor records into cursors owned by the unit."""
+        size = ctypes.sizeof(Cursor)
+        cursors = []
+        for offset in range(0, len(records), size):
+            cursor = Cursor.from_buffer_copy(records, offset)
+            # clang.cindex keeps the unit alive through this attribute
+            cursor._tu = translation_unit
+            cursors.append(cursor)
+        return cursors
+
+
+_walker: Optional[NativeWalker] = None
+_load_failed = False
+
+
+def is_available() -> bool:
+    """Check whether the compiled extension is built and usable."""
+    return get_native_walker() is not None
+
+
+def get_native_walker() -> Optional[NativeWalker]:
+    """Get the process-wide native walker, or None if the extension is unavailable."""
+    global _walker, _load_failed
+    if _walker is not None or _load_failed or _native is None:
+        return _walker
+
+    try:
+        if _native.CURSOR_SIZE != ctypes.sizeof(Cursor):
+            raise RuntimeError(f"extension cursor size {_native.CURSOR_SIZE} does not match "
+                               f"clang.cindex ({ctypes.sizeof(Cursor)})")
+        _walker = NativeWalker(_native)
+    except Exception as e:
+        print(f"Warning: Native backend disabled: {e}")
+        _load_failed = True
+    return _walker
@@ -0,0 +1,292 @@
+// Native AST walk for the rule engine (see static_analyzer/native/__init__.py).
+//
+// The module does not link against libclang. Python passes the address of
+// clang_visitChildren from the library clang.cindex already loaded, so the
+// cursors handed back belong to the same libclang copy as the translation
+// unit. Cursors travel back as raw CXCursor bytes, which match the layout
+// of clang.cindex.Cursor.
+
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <clang-c/Index.h>
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+using VisitChildrenFn = unsigned (*)(CXCursor, CXCursorVisitor, CXClientData);
+
+// Native checks, in the order their names are accepted by walk()
+enum Check { kSwitchWithoutDefault, kCheckCount };
+const char* const kCheckNames[kCheckCount] = {"switch_without_default"};
+
+struct Walk {
+    VisitChildrenFn visit_children = nullptr;
+    std::vector<bool> wanted;           // indexed by cursor kind
+    std::vector<bool> function_kinds;   // kinds that open a function body
+    bool checks[kCheckCount] = {};
+
+    std::string matches;                // CXCursor records of wanted nodes
+    std::vector<int32_t> match_functions;  // enclosing function index per match, or -1
+    std::string functions;              // CXCursor records of enclosing functions
+    std::string check_matches[kCheckCount];
+    long long nodes_visited = 0;
+};
+
+struct ChildContext {
+    Walk* walk;
+    int32_t function;
+};
+
+bool kind_in(const std::vector<bool>& kinds, int kind) {
+    return kind >= 0 && static_cast<size_t>(kind) < kinds.size() && kinds[kind];
+}
+
+void append_cursor(std::string& out, const CXCursor& cursor) {
+    out.append(reinterpret_cast<const char*>(&cursor), sizeof(CXCursor));
+}
+
+// True once a DEFAULT_STMT is found anywhere below the visited node
+CXChildVisitResult find_default(CXCursor cursor, CXCursor, CXClientData data) {
+    if (cursor.kind == CXCursor_DefaultStmt) {
+        *static_cast<bool*>(data) = true;
+        return CXChildVisit_Break;
+    }
+    return CXChildVisit_Recurse;
+}
+
+struct SwitchContext {
+    VisitChildrenFn visit_children;
+    bool found;
+};
+
+// Mirrors MISRA_C_2012_16_4._has_default_label: a default label directly
+// under the switch, or anywhere inside one of its compound statements
+CXChildVisitResult scan_switch_child(CXCursor cursor, CXCursor, CXClientData data) {
+    auto* context = static_cast<SwitchContext*>(data);
+    if (cursor.kind == CXCursor_DefaultStmt) {
+        context->found = true;
+        return CXChildVisit_Break;
+    }
+    if (cursor.kind == CXCursor_CompoundStmt) {
+        context->visit_children(cursor, find_default, &context->found);
+        if (context->found) {
+            return CXChildVisit_Break;
+        }
+    }
+    return CXChildVisit_Continue;
+}
+
+void visit_node(Walk& walk, CXCursor cursor, int32_t function);
+
+CXChildVisitResult visit_child(CXCursor cursor, CXCursor, CXClientData data) {
+    auto* context = static_cast<ChildContext*>(data);
+    visit_node(*context->walk, cursor, context->function);
+    return CXChildVisit_Continue;
+}
+
+// Pre-order, children in source order: the same sequence as
+// ASTTraverser.walk_with_enclosing_function
+void visit_node(Walk& walk, CXCursor cursor, int32_t function) {
+    walk.nodes_visited++;
+    int kind = cursor.kind;
+
+    if (kind_in(walk.wanted, kind)) {
+        append_cursor(walk.matches, cursor);
+        walk.match_functions.push_back(function);
+    }
+    if (walk.checks[kSwitchWithoutDefault] && kind == CXCursor_SwitchStmt) {
+        SwitchContext context = {walk.visit_children, false};
+        walk.visit_children(cursor, scan_switch_child, &context);
+        if (!context.found) {
+            append_cursor(walk.check_matches[kSwitchWithoutDefault], cursor);
+        }
+    }
+
+    if (kind_in(walk.function_kinds, kind)) {
+        function = static_cast<int32_t>(walk.functions.size() / sizeof(CXCursor));
+        append_cursor(walk.functions, cursor);
+    }
+    ChildContext context = {&walk, function};
+    walk.visit_children(cursor, visit_child, &context);
+}
+
+bool read_kinds(PyObject* sequence, std::vector<bool>& kinds) {
+    PyObject* fast = PySequence_Fast(sequence, "cursor kinds must be a sequence of integers");
+    if (fast == nullptr) {
+        return false;
+    }
+    Py_ssize_t count = PySequence_Fast_GET_SIZE(fast);
+    PyObject** items = PySequence_Fast_ITEMS(fast);
+    for (Py_ssize_t i = 0; i < count; ++i) {
+        long kind = PyLong_AsLong(items[i]);
+        if (kind == -1 && PyErr_Occurred()) {
+            Py_DECREF(fast);
+            return false;
+        }
+        if (kind < 0) {
+            continue;
+        }
+        if (static_cast<size_t>(kind) >= kinds.size()) {
+            kinds.resize(kind + 1, false);
+        }
+        kinds[kind] = true;
+    }
+    Py_DECREF(fast);
+    return true;
+}
+
+bool read_checks(PyObject* sequence, bool* checks) {
+    PyObject* fast = PySequence_Fast(sequence, "checks must be a sequence of names");
+    if (fast == nullptr) {
+        return false;
+    }
+    Py_ssize_t count = PySequence_Fast_GET_SIZE(fast);
+    PyObject** items = PySequence_Fast_ITEMS(fast);
+    for (Py_ssize_t i = 0; i < count; ++i) {
+        const char* name = PyUnicode_AsUTF8(items[i]);
+        if (name == nullptr) {
+            Py_DECREF(fast);
+            return false;
+        }
+        int check = 0;
+        while (check < kCheckCount && std::string(kCheckNames[check]) != name) {
+            ++check;
+        }
+        if (check == kCheckCount) {
+            PyErr_Format(PyExc_ValueError, "Unknown native check: %s", name);
+            Py_DECREF(fast);
+            return false;
+        }
+        checks[check] = true;
+    }
+    Py_DECREF(fast);
+    return true;
+}
+
+PyObject* native_walk(PyObject*, PyObject* args) {
+    PyObject* visit_children_address;
+    Py_buffer root_records;
+    PyObject* kinds;
+    PyObject* function_kinds;
+    PyObject* checks;
+    if (!PyArg_ParseTuple(args, "Oy*OOO", &visit_children_address, &root_records,
+                          &kinds, &function_kinds, &checks)) {
+        return nullptr;
+    }
+
+    Walk walk;
+    std::vector<CXCursor> roots(root_records.len / sizeof(CXCursor));
+    bool ok = root_records.len % static_cast<Py_ssize_t>(sizeof(CXCursor)) == 0;
+    if (!ok) {
+        PyErr_SetString(PyExc_ValueError, "roots are not CXCursor records");
+    } else {
+        if (!roots.empty()) {
+            std::memcpy(roots.data(), root_records.buf, roots.size() * sizeof(CXCursor));
+        }
+        walk.visit_children = reinterpret_cast<VisitChildrenFn>(
+            PyLong_AsVoidPtr(visit_children_address));
+        if (PyErr_Occurred()) {
+            ok = false;
+        } else if (walk.visit_children == nullptr) {
+            PyErr_SetString(PyExc_ValueError, "clang_visitChildren address is null");
+            ok = false;
+        } else {
+            ok = read_kinds(kinds, walk.wanted)
+                 && read_kinds(function_kinds, walk.function_kinds)
+                 && read_checks(checks, walk.checks);
+        }
+    }
+    PyBuffer_Release(&root_records);
+    if (!ok) {
+        return nullptr;
+    }
+
+    // The walk touches no Python objects, so other threads may run meanwhile
+    Py_BEGIN_ALLOW_THREADS
+    for (const CXCursor& root_cursor : roots) {
+        visit_node(walk, root_cursor, -1);
+    }
+    Py_END_ALLOW_THREADS
+
+    PyObject* check_results = PyDict_New();
+    if (check_results == nullptr) {
+        return nullptr;
+    }
+    for (int check = 0; check < kCheckCount; ++check) {
+        if (!walk.checks[check]) {
+            continue;
+        }
+        PyObject* records = PyBytes_FromStringAndSize(walk.check_matches[check].data(),
+                                                      walk.check_matches[check].size());
+        if (records == nullptr || PyDict_SetItemString(check_results, kCheckNames[check], records) < 0) {
+            Py_XDECREF(records);
+            Py_DECREF(check_results);
+            return nullptr;
+        }
+        Py_DECREF(records);
+    }
+
+    return Py_BuildValue(
+        "(y#y#y#NL)",
+        walk.matches.data(), static_cast<Py_ssize_t>(walk.matches.size()),
+        reinterpret_cast<const char*>(walk.match_functions.data()),
+        static_cast<Py_ssize_t>(walk.match_functions.size() * sizeof(int32_t)),
+        walk.functions.data(), static_cast<Py_ssize_t>(walk.functions.size()),
+        check_results,
+        walk.nodes_visited);
+}
+
+PyMethodDef methods[] = {
+    {"walk", native_walk, METH_VARARGS,
+     "walk(visit_children_address, roots, kinds, function_kinds, checks)\n"
+     "--\n\n"
+     "Walk the subtrees under packed CXCursor roots, in order, and collect\n"
+     "the cursors of the given kinds.\n\n"
+     "Returns (matches, match_functions, functions, check_matches,\n"
+     "nodes_visited): CXCursor records of matching nodes, the int32 index\n"
+     "of each match's enclosing function (-1 for none), CXCursor records\n"
+     "of those functions, the records each native check flagged, and the\n"
+     "number of nodes walked."},
+    {nullptr, nullptr, 0, nullptr}
+};
+
+PyModuleDef module = {
+    PyModuleDef_HEAD_INIT, "_native",
+    "Native AST walk for the static analyzer's rule engine.", -1, methods,
+    nullptr, nullptr, nullptr, nullptr
+};
+
+}  // namespace
+
+PyMODINIT_FUNC PyInit__native(void) {
+    PyObject* m = PyModule_Create(&module);
+    if (m == nullptr) {
+        return nullptr;
+    }
+    PyObject* checks = PyTuple_New(kCheckCount);
+    if (checks == nullptr) {
+        Py_DECREF(m);
+        return nullptr;
+    }
+    for (int check = 0; check < kCheckCount; ++check) {
+        PyObject* name = PyUnicode_FromString(kCheckNames[check]);
+        if (name == nullptr) {
+            Py_DECREF(checks);
+            Py_DECREF(m);
+            return nullptr;
+        }
+        PyTuple_SET_ITEM(checks, check, name);
+    }
+    if (PyModule_AddIntConstant(m, "CURSOR_SIZE", sizeof(CXCursor)) < 0
+        || PyModule_AddObject(m, "CHECKS", checks) < 0) {
+        Py_DECREF(checks);
+        Py_DECREF(m);
+        return nullptr;
+    }
+    return m;
+}
@@ -0,0 +1,238 @@
+"""Timing instrumentation for analysis runs and Prometheus-style export."""
+
+import threading
+import time
+from contextlib import contextmanager
+from typing import Any, Dict, Iterator, List, Optional, Tuple
+
+
+class AnalysisProfiler:
+    """Wall time per phase, rule and file for one analysis run.
+
+    Per-file profiles are plain dictionaries so worker processes can send
+    them back with their results::
+
+        {"seconds": 1.2, "parse_seconds": 0.9, "cached": False,
+         "nodes_visited": 5400, "rules": {"CERT-EXP34-C": [0.2, 3]},
+         "prefilter_seconds": 0.001, "prefiltered_rules": ["MISRA-C-2012-16.4"]}
+
+    where each rule maps to ``[seconds, violations]``. A file that no
+    enabled rule could match (see LexicalPrefilter) also has
+    ``"prefiltered": True`` and was never parsed. Parse and rule
+    phases are summed over files, so with several workers they can exceed
+    the run's wall time.
+    """
+
+    # Slowest files kept in report metadata
+    TOP_FILES = 25
+
+    def __init__(self):
+        """Initialize an empty profile."""
+        self.phases: Dict[str, float] = {}
+        self.rules: Dict[str, List[float]] = {}
+        self.files: Dict[str, Dict[str, Any]] = {}
+        self.nodes_visited = 0
+        self.cached_files = 0
+        self.prefiltered_files = 0
+        self.prefiltered_rules: Dict[str, int] = {}
+
+    @contextmanager
+    def phase(self, name: str) -> Iterator[None]:
+        """Add the time spent inside the block to a phase."""
+        start = time.perf_counter()
+        try:
+            yield
+        finally:
+            self.add_phase(name, time.perf_counter() - start)
+
+    def add_phase(self, name: str, seconds: float) -> None:
+        """Add time to a phase."""
+        self.phases[name] = self.phases.get(name, 0.0) + seconds
+
+    def add_file(self, file_path: str, file_profile: Dict[str, Any]) -> None:
+        """Merge one file's profile into the run.
+
+        Args:
+            file_path: Analyzed file
+            file_profile: Per-file profile dictionary (see class docstring)
+        """
+        self.files[file_path] = {
+            "seconds": file_profile.get("seconds", 0.0),
+            "parse_seconds": file_profile.get("parse_seconds", 0.0),
+            "cached": file_profile.get("cached", False)
+        }
+        if file_profile.get("cached"):
+            self.cached_files += 1
+        if file_profile.get("prefiltered"):
+            self.prefiltered_files += 1
+        for rule_id in file_profile.get("prefiltered_rules", ()):
+            self.prefiltered_rules[rule_id] = self.prefiltered_rules.get(rule_id, 0) + 1
+        if "prefilter_seconds" in file_profile:
+            self.add_phase("prefilter", file_profile["prefilter_seconds"])
+        self.add_phase("parse", file_profile.get("parse_seconds", 0.0))
+        self.nodes_visited += file_profile.get("nodes_visited", 0)
+
+        rule_total = 0.0
+        for rule_id, (seconds, violations) in file_profile.get("rules", {}).items():
+            entry = self.rules.setdefault(rule_id, [0.0, 0])
+            entry[0] += seconds
+            entry[1] += violations
+            rule_total += seconds
+        self.add_phase("rules", rule_total)
+
+    def top_files(self, n: int) -> List[Tuple[str, Dict[str, Any]]]:
+        """Get the n slowest files."""
+        return sorted(self.files.items(), key=lambda item: item[1]["seconds"], reverse=True)[:n]
+
+    def file_seconds(self) -> Dict[str, float]:
+        """Get the analysis time of every profiled file."""
+        return {file_path: round(entry["seconds"], 4) for file_path, entry in self.files.items()}
+
+    def top_rules(self, n: int) -> List[Tuple[str, List[float]]]:
+        """Get the n slowest rules as (rule_id, [seconds, violations])."""
+        return sorted(self.rules.items(), key=lambda item: item[1][0], reverse=True)[:n]
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert the profile to a JSON-compatible dictionary for report metadata."""
+        return {
+            "phases": {name: round(seconds, 4) for name, seconds in sorted(self.phases.items())},
+            "rules": {
+                rule_id: {"seconds": round(seconds, 4), "violations": int(violations)}
+                for rule_id, (seconds, violations) in sorted(self.rules.items())
+            },
+            "nodes_visited": self.nodes_visited,
+            "files_profiled": len(self.files),
+            "cached_files": self.cached_files,
+            "prefiltered_files": self.prefiltered_files,
+            "prefiltered_rules": dict(sorted(self.prefiltered_rules.items())),
+            "slowest_files": [
+                {"file": file_path,
+                 "seconds": round(entry["seconds"], 4),
+                 "parse_seconds": round(entry["parse_seconds"], 4),
+                 "cached": entry["cached"]}
+                for file_path, entry in self.top_files(self.TOP_FILES)
+            ]
+        }
+
+
+def format_profile(profile: Dict[str, Any], top_n: int = 10) -> str:
+    """Format a report's profile metadata for the terminal.
+
+    Args:
+        profile: ``metadata["profile"]`` of a report
+        top_n: Number of files and rules to list
+
+    Returns:
+        Multi-line text
+    """
+    lines = ["Phases:"]
+    for name, seconds in sorted(profile.get("phases", {}).items(), key=lambda item: -item[1]):
+        lines.append(f"  {name:<24}{seconds:>10.3f}s")
+
+    rules = sorted(profile.get("rules", {}).items(), key=lambda item: -item[1]["seconds"])
+    lines.append(f"Slowest rules (nodes visited: {profile.get('nodes_visited', 0)}):")
+    for rule_id, entry in rules[:top_n]:
+        lines.append(f"  {rule_id:<24}{entry['seconds']:>10.3f}s  {entry['violations']:>6} violations")
+
+    if profile.get("prefiltered_rules"):
+        lines.append(f"Skipped by the lexical pre-filter "
+                     f"({profile.get('prefiltered_files', 0)} files not parsed):")
+        for rule_id, files in profile["prefiltered_rules"].items():
+            lines.append(f"  {rule_id:<24}{files:>10} files")
+
+    lines.append("Slowest files:")
+    for entry in profile.get("slowest_files", [])[:top_n]:
+        suffix = "  (cached)" if entry.get("cached") else f"  parse {entry['parse_seconds']:.3f}s"
+        lines.append(f"  {entry['seconds']:>8.3f}s  {entry['file']}{suffix}")
+    return "\n".join(lines)
+
+
+class AnalysisMetrics:
+    """Process-wide counters over many analyses, rendered for Prometheus.
+
+    Servers call ``record`` with each report's profile and expose
+    ``render`` on a /metrics endpoint.
+    """
+
+    def __init__(self):
+        """Initialize empty counters."""
+        self._lock = threading.Lock()
+        self.analyses = 0
+        self.files = 0
+        self.violations = 0
+        self.phase_seconds: Dict[str, float] = {}
+        self.rule_seconds: Dict[str, float] = {}
+        self.rule_violations: Dict[str, int] = {}
+        self.nodes_visited = 0
+        self.prefiltered_files = 0
+
+    def record(self, profile: Dict[str, Any]) -> None:
+        """Add one report's profile metadata to the counters."""
+        with self._lock:
+            self.analyses += 1
+            self.files += profile.get("files_profiled", 0)
+            self.nodes_visited += profile.get("nodes_visited", 0)
+            self.prefiltered_files += profile.get("prefiltered_files", 0)
+            for name, seconds in profile.get("phases", {}).items():
+                self.phase_seconds[name] = self.phase_seconds.get(name, 0.0) + seconds
+            for rule_id, entry in profile.get("rules", {}).items():
+                self.rule_seconds[rule_id] = self.rule_seconds.get(rule_id, 0.0) + entry["seconds"]
+                self.rule_violations[rule_id] = (self.rule_violations.get(rule_id, 0)
+                                                 + entry["violations"])
+                self.violations += entry["violations"]
+
+    def render(self, prefix: str = "static_analyzer") -> str:
+        """Render the counters in the Prometheus text exposition format."""
+        with self._lock:
+            return render_prometheus([
+                (f"{prefix}_analyses_total", "counter", "Completed analyses",
+                 [({}, self.analyses)]),
+                (f"{prefix}_files_total", "counter", "Files analyzed",
+                 [({}, self.files)]),
+                (f"{prefix}_nodes_visited_total", "counter", "AST nodes visited by the rule engine",
+                 [({}, self.nodes_visited)]),
+                (f"{prefix}_prefiltered_files_total", "counter",
+                 "Files skipped without parsing by the lexical pre-filter",
+                 [({}, self.prefiltered_files)]),
+                (f"{prefix}_phase_seconds_total", "counter", "Time spent per analysis phase",
+                 [({"phase": name}, seconds) for name, seconds in sorted(self.phase_seconds.items())]),
+                (f"{prefix}_rule_seconds_total", "counter", "Time spent per rule",
+                 [({"rule": rule_id}, seconds) for rule_id, seconds in sorted(self.rule_seconds.items())]),
+                (f"{prefix}_rule_violations_total", "counter", "Violations reported per rule",
+                 [({"rule": rule_id}, count) for rule_id, count in sorted(self.rule_violations.items())])
+            ])
+
+
+def render_prometheus(metrics: List[Tuple[str, str, str, List[Tuple[Dict[str, str], float]]]]) -> str:
+    """Render metrics in the Prometheus text exposition format.
+
+    Args:
+        metrics: (name, type, help, [(labels, value), ...]) tuples
+
+    Returns:
+        Exposition text
+    """
+    lines = []
+    for name, metric_type, help_text, samples in metrics:
+        lines.append(f"# HELP {name} {help_text}")
+        lines.append(f"# TYPE {name} {metric_type}")
+        for labels, value in samples:
+            label_text = ",".join(
+                '{}="{}"'.format(key, str(val).replace("\\", "\\\\").replace('"', '\\"'))
+                for key, val in sorted(labels.items())
+            )
+            lines.append(f"{name}{{{label_text}}} {value}" if label_text else f"{name} {value}")
+    return "\n".join(lines) + "\n"
+
+
+_shared_metrics: Optional[AnalysisMetrics] = None
+_shared_metrics_lock = threading.Lock()
+
+
+def get_metrics() -> AnalysisMetrics:
+    """Get the process-wide metrics registry."""
+    global _shared_metrics
+    with _shared_metrics_lock:
+        if _shared_metrics is None:
+            _shared_metrics = AnalysisMetrics()
+        return _shared_metrics
@@ -0,0 +1,274 @@
+"""Whole-program analysis over per-translation-unit summaries.
+
+Some rules can only be decided with every translation unit in view:
+MISRA C:2012 Rule 8.7 asks whether an object with external linkage is
+used by one function in the whole program, not in one file. Such rules
+run in two phases.
+
+1. While each TU is analyzed (in parallel, and cached like any other
+   per-file result), the rule records what it needs into a
+   TranslationUnitSummary: the symbols the TU declares, the functions
+   that reference them, and the files it includes. Summaries are plain
+   JSON and can be written to a directory, e.g. one per CI shard.
+2. A link step merges the summaries into a ProgramSummary and each
+   whole-program rule reports from it through ``Rule.check_program``.
+   Linking needs no parsing, so it is cheap even for large programs.
+
+Symbols are keyed by their clang USR, which is the same in every TU for
+an entity with external linkage and file-qualified for internal linkage.
+"""
+
+import hashlib
+import json
+import os
+from dataclasses import asdict, dataclass
+from pathlib import Path
+from typing import Any, Dict, Iterable, List, Optional, Set, Tuple
+
+from clang.cindex import Cursor, LinkageKind
+
+from ..ast import SourceLocationExtractor
+from ..models import SourceLocation
+
+# Bumped when summaries change shape or meaning (2: internal_linkage from cursor linkage)
+SUMMARY_VERSION = 2
+
+# File extension of summaries written by save_summary
+SUMMARY_EXTENSION = ".summary.json"
+
+
+@dataclass
+class ProgramSymbol:
+    """A declaration recorded in a translation unit summary."""
+    usr: str
+    name: str
+    kind: str
+    file_path: str
+    line: int
+    column: int
+    is_definition: bool
+    internal_linkage: bool
+    source_context: Optional[str] = None
+
+    @classmethod
+    def from_cursor(cls, cursor: Cursor) -> "ProgramSymbol":
+        """Record a declaration cursor.
+
+        Args:
+            cursor: Declaration to record
+
+        Returns:
+            ProgramSymbol describing the declaration
+        """
+        location = SourceLocationExtractor.from_clang_location(cursor.location)
+        return cls(
+            usr=cursor.get_usr(),
+            name=cursor.spelling,
+            kind=cursor.kind.name,
+            file_path=location.file_path,
+            line=location.line,
+            column=location.column,
+            is_definition=bool(cursor.is_definition()),
+            internal_linkage=cursor.linkage == LinkageKind.INTERNAL,
+            source_context=SourceLocationExtractor.get_source_text(cursor)
+        )
+
+    @property
+    def location(self) -> SourceLocation:
+        """Get the declaration's location as a report location."""
+        return SourceLocation(file_path=self.file_path, line=self.line, column=self.column)
+
+
+class TranslationUnitSummary:
+    """What whole-program rules recorded about one translation unit."""
+
+    def __init__(self, file_path: str):
+        """Initialize an empty summary.
+
+        Args:
+            file_path: Main file of the translation unit
+        """
+        self.file_path = file_path
+        self.includes: List[str] = []
+        self.symbols: Dict[str, ProgramSymbol] = {}
+        self.references: Dict[str, Set[str]] = {}
+        self.functions: Dict[str, str] = {}
+
+    def add_symbol(self, cursor: Cursor) -> None:
+        """Record a declaration, preferring the definition over other declarations.
+
+        Args:
+            cursor: Declaration cursor
+        """
+        usr = cursor.get_usr()
+        if not usr:
+            return
+        existing = self.symbols.get(usr)
+        if existing is None or (not existing.is_definition and cursor.is_definition()):
+            self.symbols[usr] = ProgramSymbol.from_cursor(cursor)
+
+    def add_reference(self, usr: str, function: Optional[Cursor]) -> None:
+        """Record that a function references a symbol.
+
+        Args:
+            usr: USR of the referenced declaration
+            function: Function the reference occurs in; references outside
+                any function only mark the symbol as known
+        """
+        functions = self.references.setdefault(usr, set())
+        if function is None:
+            return
+        function_usr = function.get_usr() or function.spelling
+        functions.add(function_usr)
+        self.functions[function_usr] = function.spelling
+
+    def to_dict(self) -> Dict[str, Any]:
+        """Convert to the serialized summary format."""
+        return {
+            "version": SUMMARY_VERSION,
+            "file_path": self.file_path,
+            "includes": sorted(self.includes),
+            "symbols": [asdict(symbol) for symbol in self.symbols.values()],
+            "references": {usr: sorted(functions)
+                           for usr, functions in self.references.items()},
+            "functions": self.functions
+        }
+
+    @classmethod
+    def from_dict(cls, data: Dict[str, Any]) -> "TranslationUnitSummary":
+        """Create a summary from its serialized form.
+
+        Raises:
+            ValueError: If the data is not a summary this version can read
+        """
+        if data.get("version") != SUMMARY_VERSION:
+            raise ValueError(f"Unsupported summary version: {data.get('version')}")
+        summary = cls(data["file_path"])
+        summary.load(data)
+        return summary
+
+    def load(self, data: Dict[str, Any]) -> None:
+        """Replace this summary's contents with a serialized summary's."""
+        self.includes = list(data.get("includes", []))
+        self.symbols = {}
+        for symbol_data in data.get("symbols", []):
+            symbol = ProgramSymbol(**symbol_data)
+            self.symbols[symbol.usr] = symbol
+        self.references = {usr: set(functions)
+                           for usr, functions in data.get("references", {}).items()}
+        self.functions = dict(data.get("functions", {}))
+
+    def save(self, path: str) -> None:
+        """Write the summary as JSON."""
+        with open(path, "w", encoding="utf-8") as f:
+            json.dump(self.to_dict(), f)
+
+    @classmethod
+    def load_file(cls, path: str) -> "TranslationUnitSummary":
+        """Read a summary written by ``save``."""
+        with open(path, "r", encoding="utf-8") as f:
+            return cls.from_dict(json.load(f))
+
+
+class ProgramSummary:
+    """Summaries of every translation unit in a program, linked together."""
+
+    def __init__(self):
+        """Initialize an empty program."""
+        self.translation_units: List[str] = []
+        self.symbols: Dict[str, ProgramSymbol] = {}
+        self.references: Dict[str, Set[str]] = {}
+        self.functions: Dict[str, str] = {}
+
+    @classmethod
+    def link(cls, summaries: Iterable[TranslationUnitSummary]) -> "ProgramSummary":
+        """Merge translation unit summaries.
+
+        A TU summarized twice (e.g. by overlapping shards) is linked once,
+        using the last summary seen for it.
+
+        Args:
+            summaries: Summaries to link
+
+        Returns:
+            ProgramSummary over all of them
+        """
+        latest: Dict[str, TranslationUnitSummary] = {}
+        for summary in summaries:
+            latest[summary.file_path] = summary
+
+        program = cls()
+        for file_path in sorted(latest):
+            summary = latest[file_path]
+            program.translation_units.append(file_path)
+            for usr, symbol in summary.symbols.items():
+                existing = program.symbols.get(usr)
+                if existing is None or (not existing.is_definition and symbol.is_definition):
+                    program.symbols[usr] = symbol
+            for usr, functions in summary.references.items():
+                program.references.setdefault(usr, set()).update(functions)
+            program.functions.update(summary.functions)
+        return program
+
+    def get_referencing_functions(self, usr: str) -> List[Tuple[str, str]]:
+        """Get the functions of the whole program that reference a symbol.
+
+        Args:
+            usr: USR of the declaration
+
+        Returns:
+            (function_usr, function_name) tuples sorted by name
+        """
+        return sorted(((function_usr, self.functions.get(function_usr, function_usr))
+                       for function_usr in self.references.get(usr, ())),
+                      key=lambda function: (function[1], function[0]))
+
+
+def summary_file_name(file_path: str) -> str:
+    """Get the file name a TU's summary is saved under in a summary directory."""
+    digest = hashlib.sha256(file_path.encode("utf-8")).hexdigest()[:16]
+    return f"{Path(file_path).name}.{digest}{SUMMARY_EXTENSION}"
+
+
+def save_summary(summary: TranslationUnitSummary, directory: str) -> str:
+    """Save a summary into a summary directory.
+
+    Args:
+        summary: Summary to save
+        directory: Directory to write to; created if missing
+
+    Returns:
+        Path of the written file
+    """
+    os.makedirs(directory, exist_ok=True)
+    path = os.path.join(directory, summary_file_name(summary.file_path))
+    summary.save(path)
+    return path
+
+
+def load_summaries(paths: Iterable[str]) -> List[TranslationUnitSummary]:
+    """Load summaries from summary files and directories.
+
+    Unreadable files are skipped with a warning so one bad shard does not
+    hide the rest of the program.
+
+    Args:
+        paths: Summary files, or directories searched for ``*.summary.json``
+
+    Returns:
+        Loaded summaries in path order
+    """
+    files: List[str] = []
+    for path in paths:
+        if os.path.isdir(path):
+            files.extend(sorted(str(p) for p in Path(path).rglob(f"*{SUMMARY_EXTENSION}")))
+        else:
+            files.append(path)
+
+    summaries = []
+    for file_path in files:
+        try:
+            summaries.append(TranslationUnitSummary.load_file(file_path))
+        except (OSError, ValueError, KeyError, TypeError) as e:
+            print(f"Warning: Could not load summary {file_path}: {str(e)}")
+    return summaries
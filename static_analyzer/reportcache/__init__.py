@@ -0,0 +1,281 @@
+"""Cache of finished web reports, keyed by repository, commit and configuration.
+
+A report of one commit analyzed with one configuration never changes, so
+the web interface serves it again instead of re-analyzing. The commit is
+resolved with ``git ls-remote`` (see ``MirrorCache.resolve_remote``), so
+a cache hit costs no clone or fetch.
+
+Each entry holds the report's canonical JSON body and an ETag computed
+from it, which lets HTTP clients revalidate with If-None-Match and get a
+304 instead of the body.
+
+Identical requests that arrive while the report is still being computed
+share one analysis: the first becomes the leader of a Flight and the
+others wait for its result. Flights are per process; with a cache
+directory, finished reports are shared between server processes too.
+"""
+
+import hashlib
+import json
+import os
+import threading
+import time
+from collections import OrderedDict
+from pathlib import Path
+from typing import Any, Callable, Dict, Optional, Tuple
+
+
+def report_key(repo_url: str, commit_sha: str, config_fingerprint: str) -> str:
+    """Build the cache key of a report.
+
+    Args:
+        repo_url: Repository URL (case and a trailing ".git" or "/" are ignored)
+        commit_sha: Resolved commit
+        config_fingerprint: See config_fingerprint
+
+    Returns:
+        Hex key
+    """
+    normalized = repo_url.strip().rstrip("/")
+    if normalized.endswith(".git"):
+        normalized = normalized[:-4]
+    payload = "\0".join((normalized.lower(), commit_sha, config_fingerprint))
+    return hashlib.sha256(payload.encode("utf-8")).hexdigest()
+
+
+def config_fingerprint(*settings: Any) -> str:
+    """Hash everything besides the commit that can change a report."""
+    encoded = json.dumps(settings, sort_keys=True, default=str).encode("utf-8")
+    return hashlib.sha256(encoded).hexdigest()[:32]
+
+
+class CachedReport:
+    """A finished report and its HTTP validator."""
+
+    def __init__(self, report: Dict[str, Any], expires_at: Optional[float] = None):
+        """Initialize the entry.
+
+        Args:
+            report: Report as sent to clients
+            expires_at: time.time() after which the entry is stale (None: never)
+        """
+        self.report = report
+        self.body = json.dumps(report, sort_keys=True, separators=(",", ":")).encode("utf-8")
+        self.etag = '"' + hashlib.sha256(self.body).hexdigest()[:32] + '"'
+        self.expires_at = expires_at
+
+    def is_fresh(self) -> bool:
+        return self.expires_at is None or time.time() < self.expires_at
+
+    def matches(self, if_none_match: Optional[str]) -> bool:
+        """Check an If-None-Match header against this entry's ETag."""
+        if not if_none_match:
+            return False
+        tags = [tag.strip() for tag in if_none_match.split(",")]
+        return "*" in tags or self.etag in tags or f"W/{self.etag}" in tags
+
+
+class _FlightState:
+    """Outcome of one computation, shared by its leader and waiters."""
+
+    def __init__(self, entry: Optional[CachedReport] = None):
+        self.entry = entry
+        self.error: Optional[BaseException] = None
+        self.done = threading.Event()
+        if entry is not None:
+            self.done.set()
+
+
+class Flight:
+    """One request's part in the computation of a report."""
+
+    def __init__(self, cache: "ReportCache", key: str, state: _FlightState, leader: bool):
+        self.cache = cache
+        self.key = key
+        self.leader = leader
+        self._state = state
+
+    @property
+    def entry(self) -> Optional[CachedReport]:
+        return self._state.entry
+
+    def complete(self, report: Dict[str, Any], ttl: Optional[float] = None) -> CachedReport:
+        """Publish the leader's report to waiters and the cache.
+
+        Args:
+            report: Finished report
+            ttl: Seconds the report stays cached; None keeps it until
+                evicted, 0 hands it to waiters without caching it
+
+        Returns:
+            The cache entry
+        """
+        expires_at = None if ttl is None else time.time() + ttl
+        entry = CachedReport(report, expires_at)
+        if ttl is None or ttl > 0:
+            self.cache.put(self.key, entry)
+        self._finish(entry, None)
+        return entry
+
+    def abandon(self, error: Optional[BaseException] = None) -> None:
+        """End a leader's flight without a report; no-op once completed.
+
+        Args:
+            error: Raised to waiters; without one they may retry
+        """
+        if not self._state.done.is_set():
+            self._finish(None, error)
+
+    def wait(self, timeout: Optional[float] = None) -> Optional[CachedReport]:
+        """Wait for the leader.
+
+        Returns:
+            The report, or None if the leader gave up without an error
+
+        Raises:
+            The leader's error, or TimeoutError
+        """
+        if not self._state.done.wait(timeout):
+            raise TimeoutError("Timed out waiting for a shared analysis")
+        if self._state.error is not None:
+            raise self._state.error
+        return self._state.entry
+
+    def _finish(self, entry: Optional[CachedReport], error: Optional[BaseException]) -> None:
+        self._state.entry = entry
+        self._state.error = error
+        self.cache._end_flight(self.key, self._state)
+        self._state.done.set()
+
+
+class ReportCache:
+    """LRU cache of finished reports with single-flight computation."""
+
+    def __init__(self, max_entries: int = 64, cache_dir: Optional[str] = None):
+        """Initialize the cache.
+
+        Args:
+            max_entries: Reports kept in memory
+            cache_dir: Directory where reports without a TTL are also kept
+                on disk, one file per key (default: memory only)
+        """
+        self.max_entries = max_entries
+        self.cache_dir = Path(cache_dir) if cache_dir else None
+        self.hits = 0
+        self.misses = 0
+        self.shared = 0
+        self._entries: "OrderedDict[str, CachedReport]" = OrderedDict()
+        self._flights: Dict[str, _FlightState] = {}
+        self._lock = threading.Lock()
+
+    def lookup(self, key: str) -> Optional[CachedReport]:
+        """Get a fresh cached report, without counting a hit or miss."""
+        with self._lock:
+            return self._lookup_locked(key)
+
+    def put(self, key: str, entry: CachedReport) -> None:
+        """Cache a report in memory and, without a TTL, on disk."""
+        with self._lock:
+            self._entries[key] = entry
+            self._entries.move_to_end(key)
+            while len(self._entries) > self.max_entries:
+                self._entries.popitem(last=False)
+        if self.cache_dir is not None and entry.expires_at is None:
+            try:
+                self.cache_dir.mkdir(parents=True, exist_ok=True)
+                path = self._path(key)
+                tmp_path = path.with_suffix(f".{os.getpid()}.{threading.get_ident()}.tmp")
+                tmp_path.write_bytes(entry.body)
+                os.replace(tmp_path, path)
+            except OSError as e:
+                print(f"Warning: Could not write report cache entry: {str(e)}")
+
+    def begin(self, key: str) -> Flight:
+        """Join the computation of a report.
+
+        Returns:
+            A completed flight on a cache hit, the running flight when
+            another request is computing it, or a new flight this caller
+            leads and must complete or abandon
+        """
+        with self._lock:
+            entry = self._lookup_locked(key)
+            if entry is not None:
+                self.hits += 1
+                return Flight(self, key, _FlightState(entry), leader=False)
+            state = self._flights.get(key)
+            if state is not None:
+                self.shared += 1
+                return Flight(self, key, state, leader=False)
+            self.misses += 1
+            state = _FlightState()
+            self._flights[key] = state
+            return Flight(self, key, state, leader=True)
+
+    def get_or_compute(self,
+                       key: str,
+                       compute: Callable[[], Dict[str, Any]],
+                       ttl: Optional[Callable[[Dict[str, Any]], Optional[float]]] = None
+                       ) -> Tuple[CachedReport, str]:
+        """Get a report, computing it once however many callers ask at once.
+
+        Args:
+            key: See report_key
+            compute: Produces the report
+            ttl: Gives a report's TTL (see Flight.complete); default: no TTL
+
+        Returns:
+            (entry, "hit" | "shared" | "miss")
+        """
+        while True:
+            flight = self.begin(key)
+            if flight.leader:
+                try:
+                    report = compute()
+                except BaseException as e:
+                    flight.abandon(e)
+                    raise
+                return flight.complete(report, ttl(report) if ttl else None), "miss"
+            status = "hit" if flight.entry is not None else "shared"
+            entry = flight.wait()
+            if entry is not None:
+                return entry, status
+            # The leader gave up (e.g. its client disconnected): take over
+
+    def get_stats(self) -> Dict[str, int]:
+        """Get entry counts and hit counters."""
+        with self._lock:
+            return {
+                "entries": len(self._entries),
+                "in_flight": len(self._flights),
+                "hits": self.hits,
+                "shared": self.shared,
+                "misses": self.misses
+            }
+
+    def _lookup_locked(self, key: str) -> Optional[CachedReport]:
+        entry = self._entries.get(key)
+        if entry is not None:
+            if entry.is_fresh():
+                self._entries.move_to_end(key)
+                return entry
+            del self._entries[key]
+        if self.cache_dir is None:
+            return None
+        try:
+            report = json.loads(self._path(key).read_bytes())
+        except (OSError, ValueError):
+            return None
+        entry = CachedReport(report)
+        self._entries[key] = entry
+        while len(self._entries) > self.max_entries:
+            self._entries.popitem(last=False)
+        return entry
+
+    def _end_flight(self, key: str, state: _FlightState) -> None:
+        with self._lock:
+            if self._flights.get(key) is state:
+                del self._flights[key]
+
+    def _path(self, key: str) -> Path:
+        return self.cache_dir / f"{key}.json"
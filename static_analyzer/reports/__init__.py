@@ -0,0 +1,324 @@
+"""Streaming report writers for large analysis runs."""
+
+import array
+import json
+import os
+import tempfile
+import weakref
+from collections.abc import Sequence
+from typing import Dict, Any, Iterator, List, Optional, TextIO, BinaryIO, Union
+from ..models import Violation, RuleMetadata, ReportSummary, Severity
+from ..store import ViolationStore
+
+
+class ReportWriter:
+    """Base class for writers that emit violations as files finish.
+
+    Violations are serialized one at a time and only counted in memory,
+    so the size of a run no longer bounds peak memory. Call
+    ``write_violations`` for each file's results, then ``close`` once.
+    """
+
+    format_name = ""
+    # Whether the writer needs a binary stream
+    binary = False
+
+    def __init__(self, stream: TextIO):
+        """Initialize the writer.
+
+        Args:
+            stream: Text stream the report is written to
+        """
+        self.stream = stream
+        self.summary = ReportSummary()
+        self._started = False
+        self._closed = False
+
+    def write_violations(self, violations: List[Violation]) -> None:
+        """Write a batch of violations and update the summary counters.
+
+        Args:
+            violations: Violations to write, in report order
+        """
+        if not self._started:
+            self._begin()
+            self._started = True
+        for violation in violations:
+            self._write_violation(violation)
+            self.summary.add_violation(violation)
+        self.stream.flush()
+
+    def close(self, metadata: Optional[Dict[str, Any]] = None,
+              rules: Optional[Dict[str, RuleMetadata]] = None) -> Dict[str, Any]:
+        """Write the trailer and finish the report.
+
+        Args:
+            metadata: Report metadata
+            rules: Metadata of the rules that may appear in the report
+
+        Returns:
+            Summary of everything written
+        """
+        summary = self.summary.to_dict()
+        if self._closed:
+            return summary
+        if not self._started:
+            self._begin()
+            self._started = True
+        self._end(summary, metadata or {}, rules or {})
+        self.stream.flush()
+        self._closed = True
+        return summary
+
+    def _begin(self) -> None:
+        """Write anything that precedes the first violation."""
+
+    def _write_violation(self, violation: Violation) -> None:
+        raise NotImplementedError
+
+    def _end(self, summary: Dict[str, Any], metadata: Dict[str, Any],
+             rules: Dict[str, RuleMetadata]) -> None:
+        """Write anything that follows the last violation."""
+
+
+class NDJSONReportWriter(ReportWriter):
+    """One JSON object per line: each violation, then a summary record."""
+
+    format_name = "ndjson"
+
+    def _write_violation(self, violation: Violation) -> None:
+        record = {"type": "violation"}
+        record.update(violation.to_dict(encode_json=True))
+        self._write_record(record)
+
+    def _end(self, summary: Dict[str, Any], metadata: Dict[str, Any],
+             rules: Dict[str, RuleMetadata]) -> None:
+        self._write_record({"type": "summary", "summary": summary, "metadata": metadata})
+
+    def _write_record(self, record: Dict[str, Any]) -> None:
+        self.stream.write(json.dumps(record) + "\n")
+
+
+class SpillReportWriter(NDJSONReportWriter):
+    """NDJSON report in a temporary file, for violations moved out of memory.
+
+    Only the offset of each violation record is kept. ``finish`` closes the
+    report and hands the file to a SpilledViolations, which reads the
+    violations back one at a time.
+    """
+
+    def __init__(self, directory: Optional[str] = None):
+        """Create the spill file.
+
+        Args:
+            directory: Where to create it (default: the temporary directory)
+        """
+        fd, self.path = tempfile.mkstemp(prefix="violations-", suffix=".ndjson", dir=directory)
+        super().__init__(os.fdopen(fd, "w", encoding="utf-8"))
+        self.offsets = array.array("Q")
+        self._position = 0
+        self._cleanup = weakref.finalize(self, _remove_file, self.path)
+
+    def _write_violation(self, violation: Violation) -> None:
+        self.offsets.append(self._position)
+        super()._write_violation(violation)
+
+    def _write_record(self, record: Dict[str, Any]) -> None:
+        line = json.dumps(record) + "\n"
+        self.stream.write(line)
+        # json.dumps escapes non-ASCII text, so characters are bytes
+        self._position += len(line)
+
+    def finish(self, metadata: Optional[Dict[str, Any]] = None,
+               rules: Optional[Dict[str, RuleMetadata]] = None) -> "SpilledViolations":
+        """Close the report and get the violations written to it.
+
+        Args:
+            metadata: Report metadata
+            rules: Metadata of the rules that may appear in the report
+
+        Returns:
+            SpilledViolations that now owns (and eventually removes) the file
+        """
+        self.close(metadata, rules)
+        self.stream.close()
+        self._cleanup.detach()
+        return SpilledViolations(self.path, self.offsets)
+
+
+class SpilledViolations(Sequence):
+    """Read-only sequence of the violations in a spill file.
+
+    Violations are decoded on access and not kept, so holding the sequence
+    costs eight bytes per violation. The file is removed once the sequence
+    is garbage collected.
+    """
+
+    def __init__(self, path: str, offsets: "array.array"):
+        """Initialize the sequence.
+
+        Args:
+            path: NDJSON file written by SpillReportWriter
+            offsets: Offset of each violation record in the file
+        """
+        self.path = path
+        self._offsets = offsets
+        weakref.finalize(self, _remove_file, path)
+
+    def __len__(self) -> int:
+        return len(self._offsets)
+
+    def __getitem__(self, index):
+        if isinstance(index, slice):
+            return [self[i] for i in range(*index.indices(len(self)))]
+        offset = self._offsets[index]
+        with open(self.path, "rb") as f:
+            f.seek(offset)
+            return self._decode(f.readline())
+
+    def __iter__(self) -> Iterator[Violation]:
+        with open(self.path, "rb") as f:
+            for _ in range(len(self)):
+                yield self._decode(f.readline())
+
+    @staticmethod
+    def _decode(line: bytes) -> Violation:
+        record = json.loads(line)
+        del record["type"]
+        return Violation.from_dict(record)
+
+
+def _remove_file(path: str) -> None:
+    try:
+        os.unlink(path)
+    except OSError:
+        pass
+
+
+class SARIFReportWriter(ReportWriter):
+    """SARIF 2.1.0 log with results streamed before the tool section.
+
+    JSON object members are unordered, so ``results`` is written first and
+    the driver's rule list, which depends on which rules fired, is written
+    after the last result.
+    """
+
+    format_name = "sarif"
+
+    SCHEMA = "https://json.schemastore.org/sarif-2.1.0.json"
+
+    LEVELS = {
+        Severity.CRITICAL: "error",
+        Severity.MAJOR: "error",
+        Severity.MINOR: "warning",
+        Severity.INFO: "note"
+    }
+
+    def __init__(self, stream: TextIO):
+        super().__init__(stream)
+        self._result_count = 0
+
+    def _begin(self) -> None:
+        self.stream.write('{"version": "2.1.0", "$schema": %s, "runs": [{"results": [\n'
+                          % json.dumps(self.SCHEMA))
+
+    def _write_violation(self, violation: Violation) -> None:
+        location = violation.location
+        region = {"startLine": location.line, "startColumn": location.column}
+        if location.end_line:
+            region["endLine"] = location.end_line
+        if location.end_column:
+            region["endColumn"] = location.end_column
+
+        result = {
+            "ruleId": violation.rule_id,
+            "level": self.LEVELS.get(violation.severity, "warning"),
+            "message": {"text": violation.message},
+            "locations": [{
+                "physicalLocation": {
+                    "artifactLocation": {"uri": location.file_path},
+                    "region": region
+                }
+            }],
+            "properties": {
+                "severity": violation.severity.value,
+                "confidence": violation.confidence.value,
+                "standard": violation.standard.value
+            }
+        }
+        if violation.ai_suggested_fix:
+            result["properties"]["suggestedFix"] = violation.ai_suggested_fix
+
+        separator = ",\n" if self._result_count else ""
+        self.stream.write(separator + json.dumps(result))
+        self._result_count += 1
+
+    def _end(self, summary: Dict[str, Any], metadata: Dict[str, Any],
+             rules: Dict[str, RuleMetadata]) -> None:
+        driver_rules = []
+        for rule_id in sorted(summary["by_rule"]):
+            descriptor = {"id": rule_id}
+            rule = rules.get(rule_id)
+            if rule:
+                descriptor["shortDescription"] = {"text": rule.title}
+                descriptor["fullDescription"] = {"text": rule.description}
+                descriptor["properties"] = {"category": rule.category}
+            driver_rules.append(descriptor)
+
+        tool = {
+            "driver": {
+                "name": "static-analyzer",
+                "version": metadata.get("analyzer_version", "1.0.0"),
+                "rules": driver_rules
+            }
+        }
+        properties = {"summary": summary, "metadata": metadata}
+        self.stream.write('\n], "tool": %s, "properties": %s}]}\n'
+                          % (json.dumps(tool), json.dumps(properties)))
+
+
+class StoreReportWriter(ReportWriter):
+    """Collects violations in a compact ViolationStore and saves it on close.
+
+    Unlike the text formats the stream must be binary; the store is only
+    written once, when the run finishes.
+    """
+
+    format_name = "store"
+    binary = True
+
+    def __init__(self, stream: BinaryIO):
+        super().__init__(stream)
+        self.store = ViolationStore()
+
+    def _write_violation(self, violation: Violation) -> None:
+        self.store.append(violation)
+
+    def _end(self, summary: Dict[str, Any], metadata: Dict[str, Any],
+             rules: Dict[str, RuleMetadata]) -> None:
+        self.store.metadata = dict(metadata, summary=summary)
+        self.store.files_analyzed = metadata.get("files_analyzed")
+        self.store.write(self.stream)
+
+
+STREAMING_FORMATS = {
+    NDJSONReportWriter.format_name: NDJSONReportWriter,
+    SARIFReportWriter.format_name: SARIFReportWriter,
+    StoreReportWriter.format_name: StoreReportWriter
+}
+
+
+def create_report_writer(format: str, stream: Union[TextIO, BinaryIO]) -> ReportWriter:
+    """Create a streaming writer for a report format.
+
+    Args:
+        format: "ndjson", "sarif" or "store"
+        stream: Stream the report is written to (binary for "store")
+
+    Returns:
+        Report writer instance
+    """
+    writer_class = STREAMING_FORMATS.get(format)
+    if writer_class is None:
+        raise ValueError(f"Unsupported streaming format: {format}")
+    return writer_class(stream)
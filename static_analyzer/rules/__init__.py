@@ -1,13 +1,50 @@
 """Rule engine for static analysis."""
 
+import importlib
+import os
+import re
+import time
 from abc import ABC, abstractmethod
-from typing import List, Optional, Dict, Any, Type
-from clang.cindex import Cursor, TranslationUnit
+from typing import List, Optional, Dict, Any, Type, Tuple, Pattern, Set, Iterable
+from clang.cindex import Cursor, CursorKind, TranslationUnit
 from ..models import Violation, RuleMetadata, SourceLocation, Confidence
+from ..ast import ASTTraverser, SymbolIndex, WalkScope, FUNCTION_KINDS
+from ..native import get_native_walker
+from ..program import ProgramSummary, TranslationUnitSummary
 
 
 class Rule(ABC):
-    """Abstract base class for static analysis rules."""
+    """Abstract base class for static analysis rules.
+    
+    Rules come in two flavours. Visitor rules list the cursor kinds they
+    care about in ``cursor_kinds`` and receive matching nodes through
+    ``check_cursor`` while the engine walks the translation unit once.
+    Legacy rules leave ``cursor_kinds`` empty and override
+    ``check_translation_unit`` to do their own traversal.
+    """
+    
+    # Cursor kinds dispatched to check_cursor by the engine's shared walk
+    cursor_kinds: Tuple[CursorKind, ...] = ()
+    
+    # Whether the rule queries SymbolIndex.for_translation_unit, so the engine
+    # fills the index during its walk instead of a separate pass
+    uses_symbol_index: bool = False
+    
+    # Regular expression (over the raw bytes, comments removed) that must
+    # occur in a file or a header it includes for the rule to report
+    # anything there; None means the rule always runs. Patterns have to be
+    # conservative, since a miss hides real violations.
+    lexical_prerequisite: Optional[str] = None
+    
+    # Name of a check the native backend evaluates in C++ in place of
+    # check_cursor; matches are passed to report_native_match
+    native_check: Optional[str] = None
+    
+    # Whether the rule is decided over every translation unit at once (see
+    # static_analyzer.program). In a whole-program run the engine calls
+    # summarize_translation_unit instead of end_translation_unit, and the
+    # rule reports from the linked summaries in check_program.
+    whole_program: bool = False
     
     def __init__(self):
         """Initialize the rule."""
@@ -29,21 +66,59 @@ class Rule(ABC):
         """
         pass
     
-    @abstractmethod
+    @property
+    def is_visitor(self) -> bool:
+        """Whether this rule is driven by the engine's single AST walk."""
+        return bool(self.cursor_kinds)
+    
     def check_translation_unit(self, translation_unit: TranslationUnit) -> List[Violation]:
         """Check a translation unit for violations.
         
+        Legacy rules override this. For visitor rules the default runs the
+        visitor hooks over a private walk, so a rule can still be executed
+        on its own outside the engine.
+        
         Args:
             translation_unit: Clang translation unit to analyze
             
         Returns:
             List of violations found
         """
+        if not self.is_visitor:
+            return []
+        
+        kinds = set(self.cursor_kinds)
+        self.begin_translation_unit(translation_unit)
+        
+        violations = []
+        for cursor in ASTTraverser.walk_ast(translation_unit.cursor):
+            if cursor.kind in kinds:
+                violations.extend(self.check_cursor(cursor))
+        
+        violations.extend(self.end_translation_unit(translation_unit))
+        return violations
+    
+    def begin_translation_unit(self, translation_unit: TranslationUnit) -> None:
+        """Reset per-translation-unit state before a visitor walk.
+        
+        Args:
+            translation_unit: Translation unit about to be walked
+        """
+        pass
+    
+    def release_translation_unit(self) -> None:
+        """Drop per-translation-unit state once the unit's analysis is done.
+        
+        Cursors kept between walks hold their translation unit alive, so
+        rules that keep them in begin_translation_unit clear them here.
+        """
         pass
     
     def check_cursor(self, cursor: Cursor) -> List[Violation]:
         """Check a specific cursor for violations.
         
+        Called for every node whose kind is listed in ``cursor_kinds``.
+        
         Args:
             cursor: AST cursor to check
             
@@ -53,6 +128,52 @@ class Rule(ABC):
         # Default implementation - override if needed
         return []
     
+    def report_native_match(self, cursor: Cursor) -> List[Violation]:
+        """Report a node flagged by this rule's ``native_check``.
+        
+        Args:
+            cursor: AST cursor the native check flagged
+            
+        Returns:
+            List of violations found
+        """
+        return self.check_cursor(cursor)
+    
+    def end_translation_unit(self, translation_unit: TranslationUnit) -> List[Violation]:
+        """Report violations that need the whole walk to be decided.
+        
+        Args:
+            translation_unit: Translation unit that was walked
+            
+        Returns:
+            List of violations found
+        """
+        return []
+    
+    def summarize_translation_unit(self,
+                                   translation_unit: TranslationUnit,
+                                   summary: TranslationUnitSummary) -> None:
+        """Record what check_program needs from a walked translation unit.
+        
+        Called in place of end_translation_unit in whole-program runs.
+        
+        Args:
+            translation_unit: Translation unit that was walked
+            summary: Summary of the unit to add to
+        """
+        pass
+    
+    def check_program(self, program: ProgramSummary) -> List[Violation]:
+        """Report violations from the linked summaries of every translation unit.
+        
+        Args:
+            program: Linked summaries of the analyzed program
+            
+        Returns:
+            List of violations found
+        """
+        return []
+    
     def create_violation(self, 
                         cursor: Cursor, 
                         message: str,
@@ -76,6 +197,34 @@ class Rule(ABC):
         if source_context is None:
             source_context = SourceLocationExtractor.get_source_text(cursor)
         
+        try:
+            function = ASTTraverser.get_parent_function(cursor)
+        except Exception:
+            function = None
+        
+        return self.create_violation_at(location, message, source_context, metadata,
+                                        function.spelling if function is not None else None)
+    
+    def create_violation_at(self,
+                            location: SourceLocation,
+                            message: str,
+                            source_context: Optional[str] = None,
+                            metadata: Optional[Dict[str, Any]] = None,
+                            enclosing_function: Optional[str] = None) -> Violation:
+        """Create a violation for this rule at a location without a cursor.
+        
+        Used by check_program, which only has the recorded summaries.
+        
+        Args:
+            location: Where the violation occurred
+            message: Violation message
+            source_context: Source code context
+            metadata: Additional metadata
+            enclosing_function: Name of the function the location is in
+            
+        Returns:
+            Violation object
+        """
         return Violation(
             rule_id=self.metadata.id,
             standard=self.metadata.standard,
@@ -84,17 +233,114 @@ class Rule(ABC):
             severity=self.metadata.severity,
             confidence=Confidence.MEDIUM,  # Default confidence
             source_context=source_context,
-            metadata=metadata
+            metadata=metadata,
+            enclosing_function=enclosing_function
         )
 
 
+# Entry point group third-party rule packs are published under
+RULE_PACK_ENTRY_POINT_GROUP = "static_analyzer.rule_packs"
+
+
+class RulePack:
+    """A set of rules of one standard, imported only when one is needed.
+    
+    Rules are listed by ID as "module:ClassName" strings, so registering
+    a pack (or discovering it through the ``static_analyzer.rule_packs``
+    entry point group) imports nothing but the pack declaration. A rule's
+    module is imported the first time the rule is enabled or listed.
+    
+    Example pyproject.toml of a third-party pack::
+    
+        [project.entry-points."static_analyzer.rule_packs"]
+        acme = "acme_rules.pack:ACME_PACK"
+    """
+    
+    def __init__(self, name: str, standard: str, rules: Dict[str, str]):
+        """Initialize the pack.
+        
+        Args:
+            name: Pack name; enabling it in ``rules.enabled`` enables
+                every rule in the pack
+            standard: Standard value of the pack's rules (e.g. "MISRA")
+            rules: Rule ID to "module:ClassName"
+        """
+        self.name = name
+        self.standard = standard
+        self.rules = rules
+    
+    def load_rule(self, rule_id: str) -> Type[Rule]:
+        """Import a rule's class.
+        
+        Raises:
+            ImportError: If the module or class is missing
+        """
+        module_name, _, class_name = self.rules[rule_id].partition(":")
+        module = importlib.import_module(module_name)
+        try:
+            return getattr(module, class_name)
+        except AttributeError:
+            raise ImportError(f"{module_name} has no rule class {class_name}")
+
+
+BUILTIN_RULE_PACKS = [
+    RulePack("misra-c-2012", "MISRA", {
+        "MISRA-C-2012-8.7": f"{__name__}.misra:MISRA_C_2012_8_7",
+        "MISRA-C-2012-10.1": f"{__name__}.misra:MISRA_C_2012_10_1",
+        "MISRA-C-2012-16.4": f"{__name__}.misra:MISRA_C_2012_16_4"
+    }),
+    RulePack("cert-c", "CERT", {
+        "CERT-EXP34-C": f"{__name__}.cert:CERT_EXP34_C",
+        "CERT-ARR30-C": f"{__name__}.cert:CERT_ARR30_C"
+    })
+]
+
+
+def discover_rule_packs() -> List[RulePack]:
+    """Get the rule packs installed under the entry point group.
+    
+    An entry point refers to a RulePack or a list of them. Packs that
+    fail to load are skipped with a warning.
+    """
+    try:
+        from importlib.metadata import entry_points
+        found = entry_points(group=RULE_PACK_ENTRY_POINT_GROUP)
+    except Exception as e:
+        print(f"Warning: Could not list rule pack entry points: {e}")
+        return []
+    
+    packs = []
+    for entry_point in found:
+        try:
+            loaded = entry_point.load()
+        except Exception as e:
+            print(f"Warning: Could not load rule pack '{entry_point.name}': {e}")
+            continue
+        for pack in (loaded if isinstance(loaded, (list, tuple)) else [loaded]):
+            if isinstance(pack, RulePack):
+                packs.append(pack)
+            else:
+                print(f"Warning: Entry point '{entry_point.name}' is not a RulePack")
+    return packs
+
+
 class RuleRegistry:
-    """Registry for managing static analysis rules."""
+    """Registry for managing static analysis rules.
+    
+    Rules registered through a RulePack are instantiated on first use, so
+    the cost of building a registry does not grow with the size of the
+    catalog, only with the rules that are actually enabled.
+    """
     
     def __init__(self):
         """Initialize the rule registry."""
         self._rules: Dict[str, Type[Rule]] = {}
         self._instances: Dict[str, Rule] = {}
+        # Rules registered but not imported yet, and every rule's standard and pack
+        self._pending: Dict[str, RulePack] = {}
+        self._standards: Dict[str, str] = {}
+        self._packs: Dict[str, RulePack] = {}
+        self._enabled_cache: Dict[Tuple[str, ...], List[Rule]] = {}
     
     def register_rule(self, rule_class: Type[Rule]) -> None:
         """Register a rule class.
@@ -108,6 +354,26 @@ class RuleRegistry:
         
         self._rules[rule_id] = rule_class
         self._instances[rule_id] = instance
+        self._standards[rule_id] = instance.metadata.standard.value
+        self._pending.pop(rule_id, None)
+        self._enabled_cache.clear()
+    
+    def register_pack(self, pack: RulePack) -> None:
+        """Register a pack's rules without importing them.
+        
+        Rules already registered keep their earlier registration.
+        
+        Args:
+            pack: Rule pack to register
+        """
+        if pack.name in self._packs:
+            return
+        self._packs[pack.name] = pack
+        for rule_id in pack.rules:
+            if rule_id not in self._standards:
+                self._pending[rule_id] = pack
+                self._standards[rule_id] = pack.standard
+        self._enabled_cache.clear()
     
     def get_rule(self, rule_id: str) -> Optional[Rule]:
         """Get a rule instance by ID.
@@ -118,7 +384,10 @@ class RuleRegistry:
         Returns:
             Rule instance or None if not found
         """
-        return self._instances.get(rule_id)
+        instance = self._instances.get(rule_id)
+        if instance is None and rule_id in self._pending:
+            instance = self._load(rule_id)
+        return instance
     
     def get_all_rules(self) -> List[Rule]:
         """Get all registered rule instances.
@@ -126,7 +395,10 @@ class RuleRegistry:
         Returns:
             List of all rule instances
         """
-        return list(self._instances.values())
+        for rule_id in list(self._pending):
+            self._load(rule_id)
+        # In registration order, however the rules were loaded
+        return [self._instances[rule_id] for rule_id in self._standards if rule_id in self._instances]
     
     def get_enabled_rules(self, enabled_rule_ids: List[str]) -> List[Rule]:
         """Get enabled rule instances.
@@ -137,12 +409,16 @@ class RuleRegistry:
         Returns:
             List of enabled rule instances
         """
-        enabled_rules = []
-        for rule_id in enabled_rule_ids:
-            rule = self.get_rule(rule_id)
-            if rule:
-                enabled_rules.append(rule)
-        return enabled_rules
+        key = tuple(enabled_rule_ids)
+        enabled_rules = self._enabled_cache.get(key)
+        if enabled_rules is None:
+            enabled_rules = []
+            for rule_id in enabled_rule_ids:
+                rule = self.get_rule(rule_id)
+                if rule:
+                    enabled_rules.append(rule)
+            self._enabled_cache[key] = enabled_rules
+        return list(enabled_rules)
     
     def get_rules_by_standard(self, standard: str) -> List[Rule]:
         """Get all rules for a specific standard.
@@ -153,10 +429,42 @@ class RuleRegistry:
         Returns:
             List of matching rules
         """
-        return [
-            rule for rule in self._instances.values()
-            if rule.metadata.standard.value == standard
-        ]
+        return self.get_enabled_rules([
+            rule_id for rule_id, rule_standard in self._standards.items()
+            if rule_standard == standard
+        ])
+    
+    def expand_rule_ids(self, rule_ids: Iterable[str]) -> List[str]:
+        """Replace pack names and standards in a rule list by their rule IDs.
+        
+        Args:
+            rule_ids: Rule IDs, pack names (e.g. "misra-c-2012") or
+                standards (e.g. "MISRA")
+            
+        Returns:
+            Rule IDs in order, without duplicates; unknown entries are kept
+            so callers can report them
+        """
+        expanded: Dict[str, None] = {}
+        for entry in rule_ids:
+            if entry in self._standards:
+                expanded[entry] = None
+            elif entry in self._packs:
+                expanded.update(dict.fromkeys(self._packs[entry].rules))
+            elif entry in self._standards.values():
+                expanded.update((rule_id, None) for rule_id, standard in self._standards.items()
+                                if standard == entry)
+            else:
+                expanded[entry] = None
+        return list(expanded)
+    
+    def get_rule_standard(self, rule_id: str) -> Optional[str]:
+        """Get a rule's standard value without importing the rule."""
+        return self._standards.get(rule_id)
+    
+    def is_loaded(self, rule_id: str) -> bool:
+        """Check whether a rule has been instantiated."""
+        return rule_id in self._instances
     
     def list_rule_ids(self) -> List[str]:
         """Get list of all registered rule IDs.
@@ -164,28 +472,242 @@ class RuleRegistry:
         Returns:
             List of rule IDs
         """
-        return list(self._rules.keys())
+        return list(self._standards.keys())
+    
+    def _load(self, rule_id: str) -> Optional[Rule]:
+        """Import and instantiate a pending rule."""
+        pack = self._pending.pop(rule_id)
+        try:
+            rule_class = pack.load_rule(rule_id)
+            instance = rule_class()
+            actual_id = instance.metadata.id
+        except Exception as e:
+            print(f"Warning: Could not load rule {rule_id} from pack '{pack.name}': {e}")
+            self._standards.pop(rule_id, None)
+            return None
+        if actual_id != rule_id:
+            print(f"Warning: Pack '{pack.name}' lists {rule_id} but its class reports {actual_id}")
+        self._rules[rule_id] = rule_class
+        self._instances[rule_id] = instance
+        return instance
+
+
+class LexicalPrefilter:
+    """Skips rules whose lexical prerequisite appears nowhere in a file.
+    
+    A file is scanned together with every header it includes, following
+    ``#include`` directives through the including file's directory and
+    the -iquote/-I/-isystem/-idirafter paths of its arguments. Headers
+    that cannot be found there (usually the toolchain's own) are not
+    scanned. Each file's scan is kept, keyed by mtime and size, so a
+    header shared by many translation units is read once per process.
+    """
+    
+    INCLUDE_DIRECTIVE = re.compile(rb'^[ \t]*#[ \t]*include[ \t]*([<"])([^>"\n]+)[>"]', re.MULTILINE)
+    
+    # String and character literals are matched first so comment markers
+    # inside them are left alone
+    _COMMENT_OR_LITERAL = re.compile(
+        rb'"(?:\\.|[^"\\\n])*"|\'(?:\\.|[^\'\\\n])*\'|/\*.*?\*/|//[^\n]*', re.DOTALL
+    )
+    
+    _QUOTE_PATH_OPTIONS = ('-iquote',)
+    _ANGLE_PATH_OPTIONS = ('-I', '-isystem', '-idirafter')
+    
+    def __init__(self):
+        """Initialize an empty scan cache."""
+        self._patterns: Dict[str, Pattern[bytes]] = {}
+        # Stat stamp, comment-free text, include directives and pattern results per file
+        self._scans: Dict[str, Tuple[Tuple[int, int], bytes, List[Tuple[bool, str]], Dict[str, bool]]] = {}
+        self.files_scanned = 0
+    
+    def select(self,
+               file_path: str,
+               rules: List[Rule],
+               args: Optional[List[str]] = None,
+               forced_includes: Optional[List[str]] = None) -> Tuple[List[Rule], List[Rule], List[str]]:
+        """Split rules into those that can fire on a file and those that cannot.
+        
+        Args:
+            file_path: Source file about to be parsed
+            rules: Enabled rules
+            args: Clang arguments the file will be parsed with
+            forced_includes: Headers included ahead of the file (e.g. the
+                precompiled common headers)
+            
+        Returns:
+            (runnable, skipped, scanned): rules to run, rules that cannot
+            match, and the files scanned. ``scanned`` lists every header
+            found whenever a rule was skipped.
+        """
+        patterns = {rule.lexical_prerequisite for rule in rules if rule.lexical_prerequisite}
+        if not patterns:
+            return list(rules), [], []
+        
+        quote_paths, angle_paths, forced = self._search_paths(args or [])
+        queue = [os.path.abspath(file_path)]
+        queue.extend(os.path.abspath(path) for path in (forced_includes or []) + forced)
+        seen: Set[str] = set()
+        scanned = []
+        matched: Set[str] = set()
+        
+        while queue and len(matched) < len(patterns):
+            path = queue.pop(0)
+            if path in seen:
+                continue
+            seen.add(path)
+            scan = self._scan(path)
+            if scan is None:
+                if not scanned:
+                    # The file itself is unreadable; let the parser report it
+                    return list(rules), [], []
+                continue
+            scanned.append(path)
+            
+            text, directives, results = scan[1], scan[2], scan[3]
+            for pattern in patterns:
+                if pattern in matched:
+                    continue
+                found = results.get(pattern)
+                if found is None:
+                    found = results[pattern] = self._compile(pattern).search(text) is not None
+                if found:
+                    matched.add(pattern)
+            
+            includer_dir = os.path.dirname(path)
+            for quoted, name in directives:
+                header = self._resolve(name, includer_dir if quoted else None,
+                                       quote_paths if quoted else [], angle_paths)
+                if header is not None and header not in seen:
+                    queue.append(header)
+        
+        runnable = [rule for rule in rules
+                    if not rule.lexical_prerequisite or rule.lexical_prerequisite in matched]
+        skipped = [rule for rule in rules
+                   if rule.lexical_prerequisite and rule.lexical_prerequisite not in matched]
+        return runnable, skipped, scanned
+    
+    def _compile(self, pattern: str) -> Pattern[bytes]:
+        compiled = self._patterns.get(pattern)
+        if compiled is None:
+            compiled = self._patterns[pattern] = re.compile(pattern.encode('utf-8'))
+        return compiled
+    
+    def _scan(self, path: str) -> Optional[Tuple[Tuple[int, int], bytes, List[Tuple[bool, str]], Dict[str, bool]]]:
+        """Read a file (or reuse its previous scan) and list its includes."""
+        try:
+            stat = os.stat(path)
+        except OSError:
+            return None
+        stamp = (stat.st_mtime_ns, stat.st_size)
+        scan = self._scans.get(path)
+        if scan is not None and scan[0] == stamp:
+            return scan
+        
+        try:
+            with open(path, 'rb') as f:
+                data = f.read()
+        except OSError:
+            return None
+        self.files_scanned += 1
+        
+        text = self._COMMENT_OR_LITERAL.sub(
+            lambda match: match.group(0) if match.group(0)[:1] in (b'"', b"'") else b' ', data
+        )
+        directives = [(match.group(1) == b'"', match.group(2).decode('utf-8', 'replace').strip())
+                      for match in self.INCLUDE_DIRECTIVE.finditer(text)]
+        scan = self._scans[path] = (stamp, text, directives, {})
+        return scan
+    
+    @staticmethod
+    def _resolve(name: str, includer_dir: Optional[str],
+                 quote_paths: List[str], angle_paths: List[str]) -> Optional[str]:
+        """Find an included header the way the preprocessor searches for it."""
+        if os.path.isabs(name):
+            return name if os.path.isfile(name) else None
+        directories = ([includer_dir] if includer_dir else []) + quote_paths + angle_paths
+        for directory in directories:
+            candidate = os.path.normpath(os.path.join(directory, name))
+            if os.path.isfile(candidate):
+                return candidate
+        return None
+    
+    @classmethod
+    def _search_paths(cls, args: List[str]) -> Tuple[List[str], List[str], List[str]]:
+        """Get the quote and angle include search paths and forced includes from arguments."""
+        quote_paths: List[str] = []
+        angle_paths: List[str] = []
+        forced: List[str] = []
+        working_directory = os.getcwd()
+        
+        i = 0
+        while i < len(args):
+            arg = args[i]
+            value = None
+            target = None
+            if arg == '-working-directory' and i + 1 < len(args):
+                working_directory = args[i + 1]
+                i += 2
+                continue
+            if arg == '-include' and i + 1 < len(args):
+                value, target = args[i + 1], forced
+                i += 1
+            else:
+                for option in cls._QUOTE_PATH_OPTIONS + cls._ANGLE_PATH_OPTIONS:
+                    if arg == option and i + 1 < len(args):
+                        value = args[i + 1]
+                        i += 1
+                    elif arg.startswith(option) and len(arg) > len(option):
+                        value = arg[len(option):]
+                    else:
+                        continue
+                    target = quote_paths if option in cls._QUOTE_PATH_OPTIONS else angle_paths
+                    break
+            if value is not None:
+                target.append(os.path.join(working_directory, value))
+            i += 1
+        return quote_paths, angle_paths, forced
 
 
 class RuleEngine:
     """Engine for executing static analysis rules."""
     
-    def __init__(self, registry: Optional[RuleRegistry] = None):
+    def __init__(self,
+                 registry: Optional[RuleRegistry] = None,
+                 use_native: bool = False,
+                 walk_scope: str = WalkScope.ALL,
+                 exclude_patterns: Optional[List[str]] = None):
         """Initialize the rule engine.
         
         Args:
             registry: Rule registry to use
+            use_native: Walk translation units with the compiled backend
+                when it is built (see static_analyzer.native)
+            walk_scope: Which top-level declarations visitor rules see
+                (see WalkScope)
+            exclude_patterns: Headers skipped by the ``project`` scope
         """
         self.registry = registry or RuleRegistry()
+        self.use_native = use_native
+        self.walk_scope = walk_scope
+        self.exclude_patterns = exclude_patterns or []
+        # Dispatch tables per set of walking rules, built once and reused for every unit
+        self._dispatch_tables: Dict[Tuple[int, ...], Dict[CursorKind, List[Rule]]] = {}
     
     def analyze_translation_unit(self, 
                                 translation_unit: TranslationUnit,
-                                enabled_rules: Optional[List[str]] = None) -> List[Violation]:
+                                enabled_rules: Optional[List[str]] = None,
+                                profile: Optional[Dict[str, Any]] = None,
+                                summary: Optional[TranslationUnitSummary] = None) -> List[Violation]:
         """Analyze a translation unit with specified rules.
         
         Args:
             translation_unit: Translation unit to analyze
             enabled_rules: List of rule IDs to run, or None for all rules
+            profile: If given, receives "rules" (rule ID to
+                [seconds, violations]) and "nodes_visited"
+            summary: For a whole-program run; whole-program rules record
+                into it and report later from check_program
             
         Returns:
             List of violations found
@@ -195,30 +717,253 @@ class RuleEngine:
         else:
             rules = self.registry.get_enabled_rules(enabled_rules)
         
+        # Violations are collected per rule and concatenated in rule order so
+        # the output does not depend on how the shared walk interleaves rules
+        results: Dict[str, List[Violation]] = {}
+        timings: Dict[str, float] = {}
+        nodes_visited = 0
+        
+        visitor_rules = [rule for rule in rules if rule.is_visitor]
+        if visitor_rules:
+            visitor_results, nodes_visited = self._run_visitor_rules(
+                translation_unit, visitor_rules, timings, summary
+            )
+            results.update(visitor_results)
+        
+        for rule in rules:
+            if rule.is_visitor:
+                continue
+            start = time.perf_counter()
+            try:
+                if summary is not None and rule.whole_program:
+                    rule.summarize_translation_unit(translation_unit, summary)
+                    results[rule.metadata.id] = []
+                else:
+                    results[rule.metadata.id] = rule.check_translation_unit(translation_unit)
+            except Exception as e:
+                print(f"Error running rule {rule.metadata.id}: {str(e)}")
+                continue
+            finally:
+                timings[rule.metadata.id] = time.perf_counter() - start
+        
+        # Indexed and rule-held cursors keep the translation unit alive
+        SymbolIndex.release(translation_unit)
+        for rule in rules:
+            rule.release_translation_unit()
+        
         violations = []
+        for rule in rules:
+            violations.extend(results.get(rule.metadata.id, []))
+        
+        if profile is not None:
+            profile["nodes_visited"] = nodes_visited
+            profile["rules"] = {
+                rule.metadata.id: [timings.get(rule.metadata.id, 0.0),
+                                   len(results.get(rule.metadata.id, []))]
+                for rule in rules
+            }
+        
+        return violations
+    
+    def _run_visitor_rules(self,
+                           translation_unit: TranslationUnit,
+                           rules: List[Rule],
+                           timings: Dict[str, float],
+                           summary: Optional[TranslationUnitSummary] = None) -> Tuple[Dict[str, List[Violation]], int]:
+        """Run visitor rules over a single walk of the translation unit.
+        
+        A rule that raises is dropped for the rest of the unit and reports
+        nothing, matching how a failing legacy rule is handled.
+        
+        Args:
+            translation_unit: Translation unit to analyze
+            rules: Visitor rules to run
+            timings: Receives the seconds spent in each rule's hooks
+            summary: Summary whole-program rules record into, if any
+            
+        Returns:
+            Violations keyed by rule ID, and the number of nodes walked
+        """
+        results: Dict[str, List[Violation]] = {}
+        active = []
+        clock = time.perf_counter
         
         for rule in rules:
+            start = clock()
             try:
-                rule_violations = rule.check_translation_unit(translation_unit)
-                violations.extend(rule_violations)
+                rule.begin_translation_unit(translation_unit)
             except Exception as e:
                 print(f"Error running rule {rule.metadata.id}: {str(e)}")
                 continue
+            finally:
+                timings[rule.metadata.id] = clock() - start
+            results[rule.metadata.id] = []
+            active.append(rule)
+        
+        # Rules the native backend evaluates itself never see check_cursor
+        walker = get_native_walker() if self.use_native else None
+        native_rules = []
+        if walker is not None:
+            native_rules = [rule for rule in active if rule.native_check in walker.checks]
+        python_rules = [rule for rule in active if rule not in native_rules]
+        dispatch = self._get_dispatch_table(python_rules)
+        
+        symbol_index = None
+        if any(rule.uses_symbol_index for rule in active):
+            symbol_index = SymbolIndex()
+            SymbolIndex.attach(translation_unit, symbol_index)
+        
+        prune = WalkScope.prune_callback(translation_unit, self.walk_scope, self.exclude_patterns)
+        
+        native_walk = None
+        if walker is not None:
+            kinds = set(dispatch)
+            if symbol_index is not None:
+                kinds |= SymbolIndex.REFERENCE_KINDS
+            root = translation_unit.cursor
+            roots = None
+            if prune is not None:
+                # Scope is decided per top-level declaration, so walk the kept ones
+                roots = [child for child in root.get_children() if not prune(child, 1)]
+            native_walk = walker.walk(
+                translation_unit,
+                [kind.value for kind in kinds],
+                [kind.value for kind in FUNCTION_KINDS],
+                [rule.native_check for rule in native_rules],
+                roots
+            )
+            walk = native_walk.nodes
+        else:
+            walk = ASTTraverser.walk_with_enclosing_function(translation_unit.cursor, prune)
+        
+        nodes_visited = 0
+        for cursor, function in walk:
+            nodes_visited += 1
+            if symbol_index is not None:
+                symbol_index.record(cursor, function)
+            interested = dispatch.get(cursor.kind)
+            if not interested:
+                continue
+            for rule in interested:
+                rule_id = rule.metadata.id
+                start = clock()
+                try:
+                    results[rule_id].extend(rule.check_cursor(cursor))
+                except Exception as e:
+                    print(f"Error running rule {rule_id}: {str(e)}")
+                    del results[rule_id]
+                    active.remove(rule)
+                    python_rules.remove(rule)
+                    dispatch = self._get_dispatch_table(python_rules)
+                finally:
+                    timings[rule_id] += clock() - start
+        
+        if native_walk is not None:
+            # The native walk only hands back dispatched nodes
+            nodes_visited = native_walk.nodes_visited
+            for rule in native_rules:
+                rule_id = rule.metadata.id
+                start = clock()
+                try:
+                    for cursor in native_walk.check_matches.get(rule.native_check, []):
+                        results[rule_id].extend(rule.report_native_match(cursor))
+                except Exception as e:
+                    print(f"Error running rule {rule_id}: {str(e)}")
+                    del results[rule_id]
+                    active.remove(rule)
+                finally:
+                    timings[rule_id] += clock() - start
+        
+        for rule in active:
+            start = clock()
+            try:
+                if summary is not None and rule.whole_program:
+                    rule.summarize_translation_unit(translation_unit, summary)
+                else:
+                    results[rule.metadata.id].extend(
+                        rule.end_translation_unit(translation_unit)
+                    )
+            except Exception as e:
+                print(f"Error running rule {rule.metadata.id}: {str(e)}")
+                del results[rule.metadata.id]
+            finally:
+                timings[rule.metadata.id] += clock() - start
+        
+        return results, nodes_visited
+    
+    def check_program(self,
+                      program: ProgramSummary,
+                      enabled_rules: Optional[List[str]] = None) -> List[Violation]:
+        """Run the link step of whole-program rules.
+        
+        Args:
+            program: Linked summaries of every analyzed translation unit
+            enabled_rules: List of rule IDs to run, or None for all rules
+            
+        Returns:
+            Violations found, in rule order
+        """
+        if enabled_rules is None:
+            rules = self.registry.get_all_rules()
+        else:
+            rules = self.registry.get_enabled_rules(enabled_rules)
         
+        violations = []
+        for rule in rules:
+            if not rule.whole_program:
+                continue
+            try:
+                violations.extend(rule.check_program(program))
+            except Exception as e:
+                print(f"Error running rule {rule.metadata.id}: {str(e)}")
         return violations
     
-    def register_builtin_rules(self) -> None:
-        """Register all built-in rules."""
-        try:
-            from .misra import MISRA_C_2012_8_7, MISRA_C_2012_10_1
-            from .cert import CERT_EXP34_C
-            
-            self.registry.register_rule(MISRA_C_2012_8_7)
-            self.registry.register_rule(MISRA_C_2012_10_1) 
-            self.registry.register_rule(CERT_EXP34_C)
-        except ImportError as e:
-            print(f"Warning: Could not import built-in rules: {e}")
-            print("This may be due to missing libclang dependency")
+    def _get_dispatch_table(self, rules: List[Rule]) -> Dict[CursorKind, List[Rule]]:
+        """Get the dispatch table of a rule set, building it on first use.
+        
+        Args:
+            rules: Visitor rules, in rule order
+            
+        Returns:
+            Dictionary of cursor kind to interested rules (shared; not to be modified)
+        """
+        # Cached tables keep their rules alive, so these identities are never reused
+        key = tuple(id(rule) for rule in rules)
+        dispatch = self._dispatch_tables.get(key)
+        if dispatch is None:
+            dispatch = self._dispatch_tables[key] = self._build_dispatch_table(rules)
+        return dispatch
+    
+    @staticmethod
+    def _build_dispatch_table(rules: List[Rule]) -> Dict[CursorKind, List[Rule]]:
+        """Map each cursor kind to the rules that want to visit it.
+        
+        Args:
+            rules: Visitor rules
+            
+        Returns:
+            Dictionary of cursor kind to interested rules, in rule order
+        """
+        dispatch: Dict[CursorKind, List[Rule]] = {}
+        for rule in rules:
+            for kind in rule.cursor_kinds:
+                dispatch.setdefault(kind, []).append(rule)
+        return dispatch
+    
+    def register_builtin_rules(self, discover: bool = True) -> None:
+        """Register the built-in rule packs and, optionally, installed ones.
+        
+        Rules are imported when first enabled (see RulePack).
+        
+        Args:
+            discover: Also register packs found through the
+                ``static_analyzer.rule_packs`` entry point group
+        """
+        for pack in BUILTIN_RULE_PACKS:
+            self.registry.register_pack(pack)
+        if discover:
+            for pack in discover_rule_packs():
+                self.registry.register_pack(pack)
     
     def get_available_rules(self) -> List[Dict[str, Any]]:
         """Get information about all available rules.
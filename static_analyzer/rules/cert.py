@@ -1,15 +1,26 @@
 """CERT C/C++ rule implementations."""
 
-from typing import List, Optional
+from typing import List, Optional, Dict, FrozenSet, NamedTuple, Tuple
 from clang.cindex import Cursor, CursorKind, TranslationUnit, TypeKind
 from ..models import Violation, RuleMetadata, Standard, Severity, Confidence
 from ..ast import ASTTraverser, TypeAnalyzer
 from . import Rule
 
 
+class FunctionNullFacts(NamedTuple):
+    """Null-pointer facts about one function body, computed in a single walk."""
+    null_assigned: FrozenSet[str]
+    null_checked: FrozenSet[str]
+
+
 class CERT_EXP34_C(Rule):
     """CERT EXP34-C - Do not dereference null pointers."""
     
+    # Functions whose result may be NULL
+    NULL_RETURNING_FUNCTIONS = frozenset(
+        ["malloc", "calloc", "realloc", "fopen", "strchr", "strstr"]
+    )
+    
     def get_metadata(self) -> RuleMetadata:
         return RuleMetadata(
             id="CERT-EXP34-C",
@@ -25,19 +36,28 @@ class CERT_EXP34_C(Rule):
             ]
         )
     
-    def check_translation_unit(self, translation_unit: TranslationUnit) -> List[Violation]:
-        violations = []
-        
-        # Find all pointer dereferences and check for potential null dereference
-        for cursor in ASTTraverser.walk_ast(translation_unit.cursor):
-            if cursor.kind == CursorKind.UNARY_OPERATOR:
-                violations.extend(self._check_unary_dereference(cursor))
-            elif cursor.kind == CursorKind.MEMBER_REF_EXPR:
-                violations.extend(self._check_member_access(cursor))
-            elif cursor.kind == CursorKind.ARRAY_SUBSCRIPT_EXPR:
-                violations.extend(self._check_array_subscript(cursor))
-        
-        return violations
+    cursor_kinds = (
+        CursorKind.UNARY_OPERATOR,
+        CursorKind.MEMBER_REF_EXPR,
+        CursorKind.ARRAY_SUBSCRIPT_EXPR,
+    )
+    # No lexical prerequisite: a dereference can't be told from a
+    # multiplication textually, so nearly every file would match anyway
+    lexical_prerequisite = None
+    
+    def begin_translation_unit(self, translation_unit: TranslationUnit) -> None:
+        self._function_facts: Dict[Tuple[int, str, int], FunctionNullFacts] = {}
+    
+    def release_translation_unit(self) -> None:
+        self._function_facts = {}
+    
+    def check_cursor(self, cursor: Cursor) -> List[Violation]:
+        # Check pointer dereferences for potential null dereference
+        if cursor.kind == CursorKind.UNARY_OPERATOR:
+            return self._check_unary_dereference(cursor)
+        elif cursor.kind == CursorKind.MEMBER_REF_EXPR:
+            return self._check_member_access(cursor)
+        return self._check_array_subscript(cursor)
     
     def _check_unary_dereference(self, cursor: Cursor) -> List[Violation]:
         """Check unary dereference operations for null pointer access."""
@@ -150,7 +170,7 @@ class CERT_EXP34_C(Rule):
         # Check for function calls that might return null
         elif cursor.kind == CursorKind.CALL_EXPR:
             func_name = cursor.spelling
-            if func_name in ["malloc", "calloc", "realloc", "fopen", "strchr", "strstr"]:
+            if func_name in self.NULL_RETURNING_FUNCTIONS:
                 return {
                     "risk_level": "high",
                     "reason": f"Function '{func_name}' may return NULL",
@@ -166,43 +186,57 @@ class CERT_EXP34_C(Rule):
     def _has_null_assignment(self, cursor: Cursor, var_name: str) -> bool:
         """Check if variable has been assigned NULL in the current scope."""
         # Simplified check - look for NULL assignments in the same function
-        parent_func = ASTTraverser.get_parent_function(cursor)
-        if not parent_func:
-            return False
-        
-        for node in ASTTraverser.walk_ast(parent_func):
-            if (node.kind == CursorKind.BINARY_OPERATOR and 
-                self._is_assignment_to_var(node, var_name) and
-                self._assigns_null_value(node)):
-                return True
-        
-        return False
+        facts = self._get_function_facts(cursor)
+        return facts is not None and var_name in facts.null_assigned
     
     def _has_null_check_before_use(self, cursor: Cursor, var_name: str) -> bool:
         """Check if there's a null check before this usage."""
         # This is a very simplified implementation
         # A real implementation would need control flow analysis
+        facts = self._get_function_facts(cursor)
+        return facts is not None and var_name in facts.null_checked
+    
+    def _get_function_facts(self, cursor: Cursor) -> Optional[FunctionNullFacts]:
+        """Get the null-pointer facts of the function containing a cursor.
         
+        Facts are computed once per function and reused by every
+        dereference inside it.
+        """
         parent_func = ASTTraverser.get_parent_function(cursor)
         if not parent_func:
-            return False
-        
-        # Look for if statements that check the variable
-        for node in ASTTraverser.walk_ast(parent_func):
-            if (node.kind == CursorKind.IF_STMT and 
-                self._checks_null_condition(node, var_name)):
-                return True
-        
-        return False
+            return None
+        
+        # Cursor hashes alone can collide between functions
+        key = (parent_func.hash, parent_func.get_usr(), parent_func.extent.start.offset)
+        facts = self._function_facts.get(key)
+        if facts is None:
+            facts = self._compute_function_facts(parent_func)
+            self._function_facts[key] = facts
+        return facts
     
-    def _is_assignment_to_var(self, cursor: Cursor, var_name: str) -> bool:
-        """Check if cursor is an assignment to the specified variable."""
-        children = list(cursor.get_children())
-        if len(children) >= 1:
-            left_operand = children[0]
-            return (left_operand.kind == CursorKind.DECL_REF_EXPR and 
-                   left_operand.spelling == var_name)
-        return False
+    def _compute_function_facts(self, function: Cursor) -> FunctionNullFacts:
+        """Summarize NULL assignments and null checks."""
+        null_assigned = set()
+        null_checked = set()
+        
+        for node in ASTTraverser.walk_ast(function):
+            if node.kind == CursorKind.BINARY_OPERATOR:
+                children = list(node.get_children())
+                if (children and children[0].kind == CursorKind.DECL_REF_EXPR and
+                        self._assigns_null_value(node)):
+                    null_assigned.add(children[0].spelling)
+            elif node.kind == CursorKind.IF_STMT:
+                # Very simplified - any variable referenced in the condition
+                children = list(node.get_children())
+                if children:
+                    for condition_node in ASTTraverser.walk_ast(children[0]):
+                        if condition_node.kind == CursorKind.DECL_REF_EXPR:
+                            null_checked.add(condition_node.spelling)
+        
+        return FunctionNullFacts(
+            null_assigned=frozenset(null_assigned),
+            null_checked=frozenset(null_checked)
+        )
     
     def _assigns_null_value(self, cursor: Cursor) -> bool:
         """Check if assignment assigns a NULL value."""
@@ -214,18 +248,6 @@ class CERT_EXP34_C(Rule):
                  child.spelling.upper() == "NULL")):
                 return True
         return False
-    
-    def _checks_null_condition(self, if_cursor: Cursor, var_name: str) -> bool:
-        """Check if IF statement condition checks for null."""
-        # Very simplified - look for variable reference in condition
-        children = list(if_cursor.get_children())
-        if len(children) >= 1:
-            condition = children[0]
-            for node in ASTTraverser.walk_ast(condition):
-                if (node.kind == CursorKind.DECL_REF_EXPR and 
-                    node.spelling == var_name):
-                    return True
-        return False
 
 
 class CERT_ARR30_C(Rule):
@@ -247,18 +269,15 @@ class CERT_ARR30_C(Rule):
             ]
         )
     
-    def check_translation_unit(self, translation_unit: TranslationUnit) -> List[Violation]:
-        violations = []
-        
-        # Find array subscript expressions and check bounds
-        for cursor in ASTTraverser.walk_ast(translation_unit.cursor):
-            if cursor.kind == CursorKind.ARRAY_SUBSCRIPT_EXPR:
-                violations.extend(self._check_array_bounds(cursor))
-            elif cursor.kind == CursorKind.BINARY_OPERATOR:
-                # Check pointer arithmetic
-                violations.extend(self._check_pointer_arithmetic(cursor))
-        
-        return violations
+    cursor_kinds = (CursorKind.ARRAY_SUBSCRIPT_EXPR, CursorKind.BINARY_OPERATOR)
+    # No lexical prerequisite: any "+" or "-" may be pointer arithmetic
+    lexical_prerequisite = None
+    
+    def check_cursor(self, cursor: Cursor) -> List[Violation]:
+        # Check array bounds and pointer arithmetic
+        if cursor.kind == CursorKind.ARRAY_SUBSCRIPT_EXPR:
+            return self._check_array_bounds(cursor)
+        return self._check_pointer_arithmetic(cursor)
     
     def _check_array_bounds(self, cursor: Cursor) -> List[Violation]:
         """Check array subscript for potential bounds violations."""
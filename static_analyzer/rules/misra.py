@@ -1,9 +1,10 @@
 """MISRA C:2012 rule implementations."""
 
-from typing import List, Set
-from clang.cindex import Cursor, CursorKind, TranslationUnit, TypeKind
+from typing import List, Set, Dict
+from clang.cindex import Cursor, CursorKind, LinkageKind, TranslationUnit, TypeKind
 from ..models import Violation, RuleMetadata, Standard, Severity, Confidence
-from ..ast import ASTTraverser, TypeAnalyzer
+from ..ast import ASTTraverser, TypeAnalyzer, SymbolIndex
+from ..program import ProgramSummary, TranslationUnitSummary
 from . import Rule
 
 
@@ -25,24 +26,39 @@ class MISRA_C_2012_8_7(Rule):
             ]
         )
     
-    def check_translation_unit(self, translation_unit: TranslationUnit) -> List[Violation]:
+    cursor_kinds = (CursorKind.VAR_DECL,)
+    uses_symbol_index = True
+    
+    # A file-scope object may be shared through an extern declaration in
+    # another TU, so the single-function question is only answerable over
+    # the whole program. Per-TU runs still report from one unit.
+    whole_program = True
+    
+    def begin_translation_unit(self, translation_unit: TranslationUnit) -> None:
+        self._global_vars: Dict[str, Cursor] = {}
+    
+    def release_translation_unit(self) -> None:
+        self._global_vars = {}
+    
+    def check_cursor(self, cursor: Cursor) -> List[Violation]:
+        # Collect global variable declarations, one per symbol, preferring
+        # the definition over extern declarations
+        if cursor.semantic_parent.kind == CursorKind.TRANSLATION_UNIT:
+            usr = cursor.get_usr()
+            if usr not in self._global_vars or cursor.is_definition():
+                self._global_vars[usr] = cursor
+        return []
+    
+    def end_translation_unit(self, translation_unit: TranslationUnit) -> List[Violation]:
         violations = []
-        
-        # Find all global variable declarations
-        global_vars = []
-        for cursor in ASTTraverser.walk_ast(translation_unit.cursor):
-            if (cursor.kind == CursorKind.VAR_DECL and 
-                cursor.semantic_parent.kind == CursorKind.TRANSLATION_UNIT):
-                global_vars.append(cursor)
+        symbol_index = SymbolIndex.for_translation_unit(translation_unit)
         
         # For each global variable, check if it's only used in one function
-        for var_cursor in global_vars:
+        for usr, var_cursor in self._global_vars.items():
             if self._is_static_variable(var_cursor):
                 continue  # Static variables are okay at file scope
             
-            usage_functions = self._find_variable_usage_functions(
-                translation_unit.cursor, var_cursor.spelling
-            )
+            usage_functions = symbol_index.get_referencing_functions(usr)
             
             if len(usage_functions) == 1:
                 # Variable is only used in one function - should be local
@@ -60,23 +76,49 @@ class MISRA_C_2012_8_7(Rule):
         
         return violations
     
-    def _is_static_variable(self, cursor: Cursor) -> bool:
-        """Check if variable has static storage class."""
-        return cursor.storage_class == 1  # Static storage class
+    def summarize_translation_unit(self,
+                                   translation_unit: TranslationUnit,
+                                   summary: TranslationUnitSummary) -> None:
+        symbol_index = SymbolIndex.for_translation_unit(translation_unit)
+        for usr, var_cursor in self._global_vars.items():
+            summary.add_symbol(var_cursor)
+            for reference in symbol_index.get_references(usr):
+                summary.add_reference(usr, reference.function)
     
-    def _find_variable_usage_functions(self, root: Cursor, var_name: str) -> Set[str]:
-        """Find all functions that use a specific variable."""
-        usage_functions = set()
-        
-        for cursor in ASTTraverser.walk_ast(root):
-            if (cursor.kind == CursorKind.DECL_REF_EXPR and 
-                cursor.spelling == var_name):
-                # Find the parent function
-                parent_func = ASTTraverser.get_parent_function(cursor)
-                if parent_func:
-                    usage_functions.add(parent_func.spelling)
+    def check_program(self, program: ProgramSummary) -> List[Violation]:
+        violations = []
+        symbols = sorted(program.symbols.values(),
+                         key=lambda symbol: (symbol.file_path, symbol.line, symbol.column))
+        for symbol in symbols:
+            # Static variables are okay at file scope, and an object with no
+            # definition in the program is defined (and maybe used) elsewhere
+            if symbol.kind != CursorKind.VAR_DECL.name:
+                continue
+            if symbol.internal_linkage or not symbol.is_definition:
+                continue
+            
+            usage_functions = program.get_referencing_functions(symbol.usr)
+            if len(usage_functions) == 1:
+                function_name = usage_functions[0][1]
+                violations.append(
+                    self.create_violation_at(
+                        symbol.location,
+                        f"Variable '{symbol.name}' is only used in function "
+                        f"'{function_name}' and should be defined at block scope",
+                        symbol.source_context,
+                        metadata={
+                            "variable_name": symbol.name,
+                            "used_in_function": function_name,
+                            "whole_program": True
+                        }
+                    )
+                )
         
-        return usage_functions
+        return violations
+    
+    def _is_static_variable(self, cursor: Cursor) -> bool:
+        """Check if a file-scope variable is static (internal linkage)."""
+        return cursor.linkage == LinkageKind.INTERNAL
 
 
 class MISRA_C_2012_10_1(Rule):
@@ -97,17 +139,13 @@ class MISRA_C_2012_10_1(Rule):
             ]
         )
     
-    def check_translation_unit(self, translation_unit: TranslationUnit) -> List[Violation]:
-        violations = []
-        
-        # Find all binary operators and check operand types
-        for cursor in ASTTraverser.walk_ast(translation_unit.cursor):
-            if cursor.kind == CursorKind.BINARY_OPERATOR:
-                violations.extend(self._check_binary_operator(cursor))
-            elif cursor.kind == CursorKind.UNARY_OPERATOR:
-                violations.extend(self._check_unary_operator(cursor))
-        
-        return violations
+    cursor_kinds = (CursorKind.BINARY_OPERATOR, CursorKind.UNARY_OPERATOR)
+    
+    def check_cursor(self, cursor: Cursor) -> List[Violation]:
+        # Check operand types of binary and unary operators
+        if cursor.kind == CursorKind.BINARY_OPERATOR:
+            return self._check_binary_operator(cursor)
+        return self._check_unary_operator(cursor)
     
     def _check_binary_operator(self, cursor: Cursor) -> List[Violation]:
         """Check binary operator for type compatibility."""
@@ -237,21 +275,22 @@ class MISRA_C_2012_16_4(Rule):
             ]
         )
     
-    def check_translation_unit(self, translation_unit: TranslationUnit) -> List[Violation]:
-        violations = []
-        
-        # Find all switch statements
-        for cursor in ASTTraverser.walk_ast(translation_unit.cursor):
-            if cursor.kind == CursorKind.SWITCH_STMT:
-                if not self._has_default_label(cursor):
-                    violations.append(
-                        self.create_violation(
-                            cursor,
-                            "Switch statement missing default label"
-                        )
-                    )
-        
-        return violations
+    cursor_kinds = (CursorKind.SWITCH_STMT,)
+    lexical_prerequisite = r'\bswitch\b'
+    native_check = "switch_without_default"
+    
+    def check_cursor(self, cursor: Cursor) -> List[Violation]:
+        if not self._has_default_label(cursor):
+            return [
+                self.create_violation(
+                    cursor,
+                    "Switch statement missing default label"
+                )
+            ]
+        return []
+    
+    def report_native_match(self, cursor: Cursor) -> List[Violation]:
+        return [self.create_violation(cursor, "Switch statement missing default label")]
     
     def _has_default_label(self, switch_cursor: Cursor) -> bool:
         """Check if switch statement has a default label."""
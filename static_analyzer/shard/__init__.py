@@ -0,0 +1,247 @@
+"""Sharding one analysis run across several CI runners.
+
+Every runner is given the full file list and its shard (``i/N``) and
+picks its own files, so no coordinator is needed. The assignment is a
+pure function of the file list and the timings file. Runners that see
+the same inputs always agree on it, and every file lands in exactly one
+shard.
+
+Files are balanced by their analysis time in an earlier run. The
+timings come from a merged report (``metadata.file_seconds``), or from
+a shard report (``metadata.shard.file_seconds``), the ``slowest_files``
+of any report's profile, or a plain ``{file: seconds}`` JSON object.
+Files with no recorded timing count as the median of the known ones.
+
+``StaticAnalyzer.merge_shard_reports`` combines the shard reports into
+one. Header violations found by several shards are kept once, and
+deviations are applied there, once.
+"""
+
+import json
+import os
+from statistics import median
+from typing import Any, Dict, Iterable, List, Optional, Tuple
+
+from ..store import ViolationStore
+
+
+class ShardSpec:
+    """One shard of a run: ``index`` of ``count``, counted from 1."""
+
+    def __init__(self, index: int, count: int):
+        """Initialize the shard.
+
+        Args:
+            index: Shard number, 1 to count
+            count: Total number of shards
+
+        Raises:
+            ValueError: If the shard is out of range
+        """
+        if count < 1 or not 1 <= index <= count:
+            raise ValueError(f"Invalid shard {index}/{count}")
+        self.index = index
+        self.count = count
+
+    @classmethod
+    def parse(cls, text: str) -> "ShardSpec":
+        """Parse an ``i/N`` shard specification.
+
+        Raises:
+            ValueError: If the text is not of the form ``i/N``
+        """
+        try:
+            index, count = (int(part) for part in text.split("/"))
+        except ValueError:
+            raise ValueError(f"Invalid shard '{text}', expected i/N (e.g. 2/4)") from None
+        return cls(index, count)
+
+    def __str__(self) -> str:
+        return f"{self.index}/{self.count}"
+
+    def select(self, file_paths: List[str], timings: Optional[Dict[str, float]] = None) -> List[str]:
+        """Get this shard's files.
+
+        Args:
+            file_paths: Every file of the run, in report order
+            timings: Seconds per file from an earlier run
+
+        Returns:
+            This shard's files, in the order they were given
+        """
+        assignment = assign_shards(file_paths, self.count, timings)
+        return [file_path for file_path in file_paths
+                if assignment[file_path] == self.index - 1]
+
+
+def assign_shards(file_paths: Iterable[str],
+                  count: int,
+                  timings: Optional[Dict[str, float]] = None) -> Dict[str, int]:
+    """Split files into shards of about equal expected analysis time.
+
+    Files are handed out slowest first, each to the shard with the least
+    time so far (ties go to the lowest shard). Equal-time files are
+    taken in path order, so the result depends neither on the order of
+    the input nor on anything but the file list and timings.
+
+    Args:
+        file_paths: Files to split
+        count: Number of shards
+        timings: Seconds per file from an earlier run
+
+    Returns:
+        File path to shard number, counted from 0
+    """
+    files = sorted(set(file_paths))
+    weights = _weights(files, timings or {})
+
+    loads = [0.0] * count
+    assignment: Dict[str, int] = {}
+    for file_path in sorted(files, key=lambda path: (-weights[path], path)):
+        shard = min(range(count), key=lambda index: (loads[index], index))
+        assignment[file_path] = shard
+        loads[shard] += weights[file_path]
+    return assignment
+
+
+def _weights(files: List[str], timings: Dict[str, float]) -> Dict[str, float]:
+    """Expected seconds per file; unknown files count as the median."""
+    known = {}
+    for file_path in files:
+        seconds = timings.get(file_path)
+        if seconds is None:
+            seconds = timings.get(os.path.abspath(file_path))
+        if seconds is not None:
+            known[file_path] = max(float(seconds), 0.0)
+    default = median(known.values()) if known else 1.0
+    return {file_path: known.get(file_path, default) for file_path in files}
+
+
+def load_file_timings(path: str) -> Dict[str, float]:
+    """Load per-file seconds recorded by an earlier run.
+
+    Args:
+        path: Merged or shard report (JSON), or a ``{file: seconds}`` object
+
+    Returns:
+        File path to seconds; empty if the file has no timings or cannot
+        be read
+    """
+    try:
+        with open(path, "r", encoding="utf-8") as f:
+            data = json.load(f)
+    except (OSError, ValueError) as e:
+        print(f"Warning: Could not read shard timings from {path}: {str(e)}")
+        return {}
+    if not isinstance(data, dict):
+        return {}
+
+    metadata = data.get("metadata")
+    if not isinstance(metadata, dict):
+        return {file_path: seconds for file_path, seconds in data.items()
+                if isinstance(seconds, (int, float))}
+    return file_timings_from_metadata(metadata)
+
+
+def file_timings_from_metadata(metadata: Dict[str, Any]) -> Dict[str, float]:
+    """Get the per-file seconds a report's metadata records."""
+    if "file_seconds" in metadata:
+        return dict(metadata["file_seconds"])
+    shard = metadata.get("shard") or {}
+    if "file_seconds" in shard:
+        return dict(shard["file_seconds"])
+    return {entry["file"]: entry["seconds"]
+            for entry in (metadata.get("profile") or {}).get("slowest_files", [])}
+
+
+def load_shard_reports(paths: Iterable[str]) -> List[Tuple[str, ViolationStore]]:
+    """Load shard reports in any format a baseline can be (see ViolationStore.load).
+
+    Args:
+        paths: Shard report files
+
+    Returns:
+        (path, store) tuples ordered by shard number, then path; the
+        store's metadata is the shard report's metadata
+    """
+    reports = [(path, ViolationStore.load(path)) for path in paths]
+
+    def shard_index(report: Tuple[str, ViolationStore]) -> Tuple[int, str]:
+        shard = report[1].metadata.get("shard") or {}
+        return shard.get("index", 0), report[0]
+
+    return sorted(reports, key=shard_index)
+
+
+def check_shard_coverage(reports: List[Tuple[str, ViolationStore]]) -> List[str]:
+    """Find shards that are missing, duplicated or from different splits.
+
+    Args:
+        reports: Loaded shard reports
+
+    Returns:
+        Human-readable problems; empty if the reports cover exactly one split
+    """
+    counts = set()
+    indexes: Dict[int, str] = {}
+    issues = []
+    for path, store in reports:
+        shard = store.metadata.get("shard")
+        if not shard:
+            issues.append(f"{path} is not a shard report")
+            continue
+        counts.add(shard["count"])
+        if shard["index"] in indexes:
+            issues.append(f"Shard {shard['index']}/{shard['count']} given twice "
+                          f"({indexes[shard['index']]} and {path})")
+        indexes[shard["index"]] = path
+
+    if len(counts) > 1:
+        issues.append(f"Shard reports come from different splits: {sorted(counts)} shards")
+    elif counts:
+        count = counts.pop()
+        missing = [index for index in range(1, count + 1) if index not in indexes]
+        if missing:
+            issues.append(f"Missing shards: {', '.join(f'{index}/{count}' for index in missing)}")
+    return issues
+
+
+def merge_shard_metadata(reports: List[Tuple[str, ViolationStore]]) -> Dict[str, Any]:
+    """Combine the metadata of shard reports.
+
+    Args:
+        reports: Loaded shard reports
+
+    Returns:
+        Metadata for the merged report. ``file_seconds`` holds every
+        shard's per-file timings, so the merged report can be passed as
+        the timings of the next sharded run.
+    """
+    file_seconds: Dict[str, float] = {}
+    shards = []
+    files_analyzed = 0
+    total_files_provided = 0
+    for path, store in reports:
+        metadata = store.metadata
+        shard = metadata.get("shard") or {}
+        file_seconds.update(file_timings_from_metadata(metadata))
+        files_analyzed += metadata.get("files_analyzed", 0)
+        total_files_provided = max(total_files_provided, metadata.get("total_files_provided", 0))
+        shards.append({
+            "report": path,
+            "index": shard.get("index"),
+            "count": shard.get("count"),
+            "files_analyzed": metadata.get("files_analyzed", 0),
+            "violations": len(store),
+            "seconds": (metadata.get("profile") or {}).get("phases", {}).get("total")
+        })
+
+    first = reports[0][1].metadata if reports else {}
+    return {
+        "analyzer_version": first.get("analyzer_version"),
+        "config": first.get("config"),
+        "files_analyzed": files_analyzed,
+        "total_files_provided": total_files_provided,
+        "shards": shards,
+        "file_seconds": dict(sorted(file_seconds.items()))
+    }
@@ -0,0 +1,351 @@
+"""Compact columnar storage for large sets of violations.
+
+A ViolationStore keeps one row per violation in typed arrays. File
+paths, rule IDs, messages and source contexts are interned in a shared
+string table, and severity, standard and confidence are small integer
+codes. Rarely set fields (metadata and AI text) live in a sparse side
+table. A million violations that repeat a few thousand distinct strings
+take tens of megabytes instead of gigabytes of dataclasses.
+
+Stores are saved as a gzip-compressed binary file: a JSON header with
+the string table, followed by the raw column arrays. Reports and
+baselines can be loaded, summarized and compared without creating a
+Violation per row.
+"""
+
+import array
+import gzip
+import json
+import struct
+import sys
+from collections import Counter
+from typing import Any, BinaryIO, Dict, Iterable, Iterator, List, Optional, Set, Tuple
+
+from ..models import Violation, SourceLocation, Severity, Standard, Confidence
+
+STORE_MAGIC = b"VSTORE\x00\x01"
+STORE_VERSION = 1
+
+# File extension conventionally used for saved stores
+STORE_EXTENSION = ".vstore"
+
+# Rule, file, line and column identify a violation across runs
+Signature = Tuple[str, str, int, int]
+
+_ENUMS = {
+    "severity": Severity,
+    "standard": Standard,
+    "confidence": Confidence
+}
+
+# (name, array typecode); -1 marks a missing optional value in the signed columns
+_COLUMNS = (
+    ("rule_id", "I"),
+    ("file_path", "I"),
+    ("line", "I"),
+    ("column", "I"),
+    ("end_line", "i"),
+    ("end_column", "i"),
+    ("severity", "B"),
+    ("standard", "B"),
+    ("confidence", "B"),
+    ("message", "I"),
+    ("source_context", "i"),
+    ("enclosing_function", "i")
+)
+
+# Optional fields kept per row only when set
+_EXTRA_FIELDS = ("metadata", "ai_explanation", "ai_risk_summary", "ai_suggested_fix")
+
+
+class ViolationStore:
+    """Violations stored column by column with interned strings."""
+
+    def __init__(self):
+        """Initialize an empty store."""
+        self.strings: List[str] = []
+        self._string_ids: Dict[str, int] = {}
+        self.columns: Dict[str, array.array] = {
+            name: array.array(typecode) for name, typecode in _COLUMNS
+        }
+        self.extras: Dict[int, Dict[str, Any]] = {}
+        self.metadata: Dict[str, Any] = {}
+        # Files the run analyzed, including those without violations (None: unknown)
+        self.files_analyzed: Optional[int] = None
+        self._codes = {name: {member: code for code, member in enumerate(enum)}
+                       for name, enum in _ENUMS.items()}
+        self._members = {name: list(enum) for name, enum in _ENUMS.items()}
+
+    @classmethod
+    def from_violations(cls, violations: Iterable[Violation]) -> "ViolationStore":
+        """Build a store from Violation objects."""
+        store = cls()
+        for violation in violations:
+            store.append(violation)
+        return store
+
+    def __len__(self) -> int:
+        return len(self.columns["rule_id"])
+
+    def __iter__(self) -> Iterator[Violation]:
+        for row in range(len(self)):
+            yield self.violation(row)
+
+    def intern(self, text: str) -> int:
+        """Get the string table index of a string, adding it if needed."""
+        index = self._string_ids.get(text)
+        if index is None:
+            index = len(self.strings)
+            self.strings.append(text)
+            self._string_ids[text] = index
+        return index
+
+    def append(self, violation: Violation) -> None:
+        """Add a violation as a new row."""
+        location = violation.location
+        self._append_row(
+            violation.rule_id, location.file_path, location.line, location.column,
+            location.end_line, location.end_column, violation.severity,
+            violation.standard, violation.confidence, violation.message,
+            violation.source_context, violation.enclosing_function,
+            {field: getattr(violation, field) for field in _EXTRA_FIELDS}
+        )
+
+    def append_dict(self, data: Dict[str, Any]) -> None:
+        """Add a violation from its JSON form (``Violation.to_dict(encode_json=True)``)."""
+        location = data["location"]
+        self._append_row(
+            data["rule_id"], location["file_path"], location["line"], location["column"],
+            location.get("end_line"), location.get("end_column"),
+            Severity(data["severity"]), Standard(data["standard"]),
+            Confidence(data["confidence"]), data["message"], data.get("source_context"),
+            data.get("enclosing_function"),
+            {field: data.get(field) for field in _EXTRA_FIELDS}
+        )
+
+    def _append_row(self, rule_id: str, file_path: str, line: int, column: int,
+                    end_line: Optional[int], end_column: Optional[int],
+                    severity: Severity, standard: Standard, confidence: Confidence,
+                    message: str, source_context: Optional[str],
+                    enclosing_function: Optional[str],
+                    extras: Dict[str, Any]) -> None:
+        columns = self.columns
+        columns["rule_id"].append(self.intern(rule_id))
+        columns["file_path"].append(self.intern(file_path))
+        columns["line"].append(line)
+        columns["column"].append(column)
+        columns["end_line"].append(-1 if end_line is None else end_line)
+        columns["end_column"].append(-1 if end_column is None else end_column)
+        columns["severity"].append(self._codes["severity"][severity])
+        columns["standard"].append(self._codes["standard"][standard])
+        columns["confidence"].append(self._codes["confidence"][confidence])
+        columns["message"].append(self.intern(message))
+        columns["source_context"].append(-1 if source_context is None
+                                         else self.intern(source_context))
+        columns["enclosing_function"].append(-1 if enclosing_function is None
+                                             else self.intern(enclosing_function))
+        extras = {field: value for field, value in extras.items() if value is not None}
+        if extras:
+            self.extras[len(self) - 1] = extras
+
+    def violation(self, row: int) -> Violation:
+        """Materialize one row as a Violation."""
+        columns = self.columns
+        end_line = columns["end_line"][row]
+        end_column = columns["end_column"][row]
+        context = columns["source_context"][row]
+        function = columns["enclosing_function"][row]
+        return Violation(
+            rule_id=self.strings[columns["rule_id"][row]],
+            standard=self._members["standard"][columns["standard"][row]],
+            location=SourceLocation(
+                file_path=self.strings[columns["file_path"][row]],
+                line=columns["line"][row],
+                column=columns["column"][row],
+                end_line=None if end_line < 0 else end_line,
+                end_column=None if end_column < 0 else end_column
+            ),
+            message=self.strings[columns["message"][row]],
+            severity=self._members["severity"][columns["severity"][row]],
+            confidence=self._members["confidence"][columns["confidence"][row]],
+            source_context=None if context < 0 else self.strings[context],
+            enclosing_function=None if function < 0 else self.strings[function],
+            **self.extras.get(row, {})
+        )
+
+    def signature(self, row: int) -> Signature:
+        """Get the identity of one row for baseline comparison."""
+        columns = self.columns
+        return (self.strings[columns["rule_id"][row]], self.strings[columns["file_path"][row]],
+                columns["line"][row], columns["column"][row])
+
+    @staticmethod
+    def violation_signature(violation: Violation) -> Signature:
+        """Get the identity of a Violation for baseline comparison."""
+        return (violation.rule_id, violation.location.file_path,
+                violation.location.line, violation.location.column)
+
+    def signatures(self) -> Set[Signature]:
+        """Get the signatures of every row."""
+        return {self.signature(row) for row in range(len(self))}
+
+    def diff(self, baseline: "ViolationStore") -> Tuple[List[int], List[int]]:
+        """Compare against a baseline store.
+
+        Args:
+            baseline: Store of the earlier run
+
+        Returns:
+            (new_rows, fixed_rows): rows of this store missing from the
+            baseline, and rows of the baseline missing from this store
+        """
+        baseline_signatures = baseline.signatures()
+        current_signatures = set()
+        new_rows = []
+        for row in range(len(self)):
+            signature = self.signature(row)
+            current_signatures.add(signature)
+            if signature not in baseline_signatures:
+                new_rows.append(row)
+        fixed_rows = [row for row in range(len(baseline))
+                      if baseline.signature(row) not in current_signatures]
+        return new_rows, fixed_rows
+
+    def summary(self) -> Dict[str, Any]:
+        """Compute the report summary (see ReportSummary) from the columns.
+
+        ``files_analyzed`` is the run's count when known, otherwise the
+        number of files with violations.
+        """
+        severities = Counter(self.columns["severity"])
+        standards = Counter(self.columns["standard"])
+        rules = Counter(self.columns["rule_id"])
+        return {
+            "total_violations": len(self),
+            "by_severity": {member.value: severities.get(code, 0)
+                            for code, member in enumerate(self._members["severity"])},
+            "by_standard": {member.value: standards.get(code, 0)
+                            for code, member in enumerate(self._members["standard"])},
+            "by_rule": {self.strings[index]: count for index, count in rules.items()},
+            "files_analyzed": (self.files_analyzed if self.files_analyzed is not None
+                               else len(set(self.columns["file_path"])))
+        }
+
+    def save(self, path: str) -> None:
+        """Write the store to a file (see ``write``)."""
+        with open(path, "wb") as f:
+            self.write(f)
+
+    def write(self, stream: BinaryIO) -> None:
+        """Write the store as gzip-compressed binary.
+
+        Args:
+            stream: Binary stream to write to
+        """
+        header = {
+            "version": STORE_VERSION,
+            "byteorder": sys.byteorder,
+            "rows": len(self),
+            "strings": self.strings,
+            "enums": {name: [member.value for member in members]
+                      for name, members in self._members.items()},
+            "columns": [[name, column.typecode, len(column) * column.itemsize]
+                        for name, column in self.columns.items()],
+            "extras": {str(row): extras for row, extras in self.extras.items()},
+            "metadata": self.metadata,
+            "files_analyzed": self.files_analyzed
+        }
+        header_bytes = json.dumps(header, default=str).encode("utf-8")
+        with gzip.GzipFile(fileobj=stream, mode="wb") as out:
+            out.write(STORE_MAGIC)
+            out.write(struct.pack(">Q", len(header_bytes)))
+            out.write(header_bytes)
+            for column in self.columns.values():
+                out.write(column.tobytes())
+
+    @classmethod
+    def read(cls, stream: BinaryIO) -> "ViolationStore":
+        """Read a store written by ``write``.
+
+        Raises:
+            ValueError: If the stream is not a violation store
+        """
+        with gzip.GzipFile(fileobj=stream, mode="rb") as data:
+            if data.read(len(STORE_MAGIC)) != STORE_MAGIC:
+                raise ValueError("Not a violation store")
+            header_length = struct.unpack(">Q", data.read(8))[0]
+            header = json.loads(data.read(header_length).decode("utf-8"))
+            if header.get("version") != STORE_VERSION:
+                raise ValueError(f"Unsupported violation store version: {header.get('version')}")
+
+            store = cls()
+            store.strings = header["strings"]
+            store._string_ids = {text: index for index, text in enumerate(store.strings)}
+            for name, typecode, size in header["columns"]:
+                column = array.array(typecode)
+                column.frombytes(data.read(size))
+                if header["byteorder"] != sys.byteorder:
+                    column.byteswap()
+                store.columns[name] = column
+            # Stores written before a column existed hold no values for it
+            for name, typecode in _COLUMNS:
+                if len(store.columns[name]) != header["rows"]:
+                    missing = -1 if typecode.islower() else 0
+                    store.columns[name] = array.array(typecode, [missing]) * header["rows"]
+
+        # Map the codes written by another version of the enums to this one's
+        for name, values in header["enums"].items():
+            if values != [member.value for member in store._members[name]]:
+                codes = [store._codes[name][_ENUMS[name](value)] for value in values]
+                store.columns[name] = array.array("B", (codes[code] for code in store.columns[name]))
+        store.extras = {int(row): extras for row, extras in header["extras"].items()}
+        store.metadata = header.get("metadata") or {}
+        store.files_analyzed = header.get("files_analyzed", store.metadata.get("files_analyzed"))
+        return store
+
+    @classmethod
+    def load(cls, path: str) -> "ViolationStore":
+        """Load violations from a saved store, an NDJSON report or a JSON report.
+
+        NDJSON reports are read a line at a time, so only the compact rows
+        are ever held in memory.
+
+        Args:
+            path: File to load
+
+        Returns:
+            ViolationStore; ``metadata`` holds the report metadata if present
+        """
+        with open(path, "rb") as f:
+            lead = f.read(2)
+            f.seek(0)
+            if lead == b"\x1f\x8b":
+                return cls.read(f)
+
+        store = cls()
+        with open(path, "r", encoding="utf-8") as f:
+            first_line = f.readline()
+            f.seek(0)
+            try:
+                first_record = json.loads(first_line)
+            except ValueError:
+                first_record = None
+
+            if isinstance(first_record, dict) and first_record.get("type") in ("violation", "summary"):
+                for line in f:
+                    if not line.strip():
+                        continue
+                    record = json.loads(line)
+                    if record.get("type") == "violation":
+                        store.append_dict(record)
+                    elif record.get("type") == "summary":
+                        store.metadata = record.get("metadata") or {}
+                store.files_analyzed = store.metadata.get("files_analyzed")
+                return store
+
+            report = json.load(f)
+        for data in report.get("violations", []):
+            store.append_dict(data)
+        store.metadata = report.get("metadata") or {}
+        store.files_analyzed = store.metadata.get("files_analyzed")
+        return store
@@ -0,0 +1,38 @@
+"""Shared test doubles."""
+
+from static_analyzer.models import Confidence, Severity, SourceLocation, Standard, Violation
+
+
+def make_violation(rule_id="CERT-EXP34-C", file_path="src/main.c", line=1, column=1, **overrides):
+    """Build a violation; keyword overrides replace any other Violation field."""
+    fields = {
+        "standard": Standard.MISRA if rule_id.startswith("MISRA") else Standard.CERT,
+        "message": f"Violation at line {line}",
+        "severity": Severity.MAJOR,
+        "confidence": Confidence.HIGH
+    }
+    fields.update(overrides)
+    return Violation(rule_id=rule_id, location=SourceLocation(file_path, line, column), **fields)
+
+
+class FakeCursor:
+    """Minimal stand-in for a libclang cursor."""
+
+    def __init__(self, kind, spelling="", children=None, referenced=None, usr="", line=1):
+        self.kind = kind
+        self.spelling = spelling
+        self.referenced = referenced
+        self.line = line
+        self._usr = usr
+        self._children = children or []
+
+    def get_children(self):
+        return iter(self._children)
+
+    def get_usr(self):
+        return self._usr
+
+
+class FakeTranslationUnit:
+    def __init__(self, cursor):
+        self.cursor = cursor
@@ -0,0 +1,138 @@
+"""Test batched AI enrichment."""
+
+import asyncio
+import json
+from types import SimpleNamespace
+
+from static_analyzer.ai_assistant import AIAssistant
+from static_analyzer.cache import ResponseCache
+
+from conftest import make_violation
+
+NULL_DEREF = "p = NULL;  *p = 1;"
+
+
+class RateLimited(Exception):
+    status_code = 429
+
+    def __init__(self):
+        super().__init__("rate limited")
+        self.response = SimpleNamespace(headers={"retry-after": "0"})
+
+
+class FakeCompletions:
+    """Async chat completions stand-in that can fail the first calls."""
+
+    def __init__(self, failures=0):
+        self.failures = failures
+        self.calls = 0
+        self.in_flight = 0
+        self.max_in_flight = 0
+
+    async def create(self, **kwargs):
+        self.calls += 1
+        if self.failures:
+            self.failures -= 1
+            raise RateLimited()
+        self.in_flight += 1
+        self.max_in_flight = max(self.max_in_flight, self.in_flight)
+        await asyncio.sleep(0.01)
+        self.in_flight -= 1
+        content = json.dumps({
+            "explanation": "Dereferencing NULL is undefined behavior.",
+            "risk_summary": "Crash.",
+            "suggested_fix": "Check p before use."
+        })
+        return SimpleNamespace(choices=[SimpleNamespace(message=SimpleNamespace(content=content))])
+
+
+class FakeClient:
+    """AsyncOpenAI stand-in that, like httpx, only works on the loop it was opened on."""
+
+    def __init__(self, completions, clients):
+        self.chat = SimpleNamespace(completions=completions)
+        self.loop = None
+        self.closed = False
+        clients.append(self)
+
+    async def __aenter__(self):
+        self.loop = asyncio.get_running_loop()
+        return self
+
+    async def __aexit__(self, *exc_info):
+        assert asyncio.get_running_loop() is self.loop
+        self.closed = True
+
+
+def make_assistant(completions, clients=None, **config):
+    assistant = AIAssistant(dict({"enabled": False, "retry_base_delay": 0}, **config))
+    assistant.enabled = True
+    clients = [] if clients is None else clients
+    assistant._create_client = lambda: FakeClient(completions, clients)
+    return assistant
+
+
+class TestAIAssistant:
+    def test_identical_violations_share_one_request(self):
+        """Test grouping by rule and normalized snippet."""
+        completions = FakeCompletions()
+        assistant = make_assistant(completions)
+        violations = [
+            make_violation(line=4, source_context=NULL_DEREF),
+            make_violation(line=9, source_context="p = NULL;\n    *p = 1;"),
+            make_violation(line=12, source_context="q = NULL; *q = 2;"),
+        ]
+
+        enhanced = assistant.enhance_violations(violations)
+
+        assert completions.calls == 2
+        assert [v.location.line for v in enhanced] == [4, 9, 12]
+        assert all(v.ai_suggested_fix == "Check p before use." for v in enhanced)
+        assert enhanced[0].ai_risk_summary == "Crash."
+
+    def test_concurrency_limit_and_rate_limit_retry(self):
+        """Test that requests are bounded and 429s are retried."""
+        completions = FakeCompletions(failures=2)
+        assistant = make_assistant(completions, concurrency=2)
+        violations = [make_violation(line=i, source_context=f"x{i} = 1;") for i in range(6)]
+
+        enhanced = assistant.enhance_violations(violations)
+
+        assert completions.calls == 8
+        assert completions.max_in_flight <= 2
+        assert all(v.ai_explanation for v in enhanced)
+
+    def test_unstructured_reply_becomes_explanation(self):
+        """Test the fallback for replies that aren't JSON."""
+        assistant = make_assistant(FakeCompletions())
+        fields = assistant._parse_response("Plain text answer")
+        assert fields == {"explanation": "Plain text answer",
+                          "risk_summary": None, "suggested_fix": None}
+        fenced = assistant._parse_response('```json\n{"explanation": "E", "suggested_fix": "F"}\n```')
+        assert fenced == {"explanation": "E", "risk_summary": None, "suggested_fix": "F"}
+
+    def test_response_cache_skips_repeat_requests(self, tmp_path):
+        """Test that a second run on the same code is served from the cache."""
+        completions = FakeCompletions()
+        assistant = make_assistant(completions)
+        assistant.response_cache = ResponseCache(str(tmp_path / "ai"))
+
+        first = assistant.enhance_violations([make_violation(line=4, source_context=NULL_DEREF)])
+        moved = make_violation(line=30, source_context="p = NULL;   *p = 1;")
+        second = assistant.enhance_violations([moved])
+
+        assert completions.calls == 1
+        assert second[0].ai_suggested_fix == first[0].ai_suggested_fix
+        assert assistant.response_cache.get_stats()["hits"] == 1
+
+    def test_each_batch_gets_its_own_client(self):
+        """Test that a client is never reused on a later batch's event loop."""
+        clients = []
+        assistant = make_assistant(FakeCompletions(), clients)
+
+        assistant.enhance_violations([make_violation(line=4, source_context=NULL_DEREF)])
+        assistant.enhance_violations([make_violation(line=8, source_context="q = NULL; *q = 2;")])
+
+        assert len(clients) == 2
+        assert all(client.closed for client in clients)
+        assert clients[0].loop is not clients[1].loop
@@ -0,0 +1,347 @@
+"""Test AST layer helpers."""
+
+import os
+import threading
+
+import pytest
+from clang.cindex import CursorKind
+
+from static_analyzer.ast import (
+    ASTParser,
+    CompileCommandsDatabase,
+    SymbolIndex,
+    ASTTraverser,
+    SourceBufferCache,
+    WalkScope
+)
+
+from conftest import FakeCursor, FakeTranslationUnit
+
+
+@pytest.fixture
+def translation_unit():
+    global_var = FakeCursor(CursorKind.VAR_DECL, "counter", usr="c:@counter")
+    local_var = FakeCursor(CursorKind.VAR_DECL, "counter", usr="c:f.c@F@reset@counter")
+
+    def ref(target):
+        return FakeCursor(CursorKind.DECL_REF_EXPR, target.spelling, referenced=target)
+
+    root = FakeCursor(CursorKind.TRANSLATION_UNIT, children=[
+        global_var,
+        FakeCursor(CursorKind.FUNCTION_DECL, "tick", children=[
+            FakeCursor(CursorKind.COMPOUND_STMT, children=[ref(global_var)])
+        ]),
+        FakeCursor(CursorKind.FUNCTION_DECL, "reset", children=[
+            FakeCursor(CursorKind.COMPOUND_STMT, children=[local_var, ref(local_var)])
+        ]),
+    ])
+    return FakeTranslationUnit(root)
+
+
+class TestSymbolIndex:
+    def test_references_keyed_by_usr(self, translation_unit):
+        """Test that a shadowing local is not counted as a use of the global."""
+        index = SymbolIndex.build(translation_unit)
+
+        assert index.get_referencing_functions("c:@counter") == ["tick"]
+        assert index.get_referencing_functions("c:f.c@F@reset@counter") == ["reset"]
+        assert index.get_references("c:@unused") == []
+
+    def test_shared_per_translation_unit(self, translation_unit):
+        """Test that the index is built once and can be released."""
+        first = SymbolIndex.for_translation_unit(translation_unit)
+        assert SymbolIndex.for_translation_unit(translation_unit) is first
+
+        SymbolIndex.release(translation_unit)
+        assert SymbolIndex.for_translation_unit(translation_unit) is not first
+        SymbolIndex.release(translation_unit)
+
+    def test_walk_tracks_enclosing_function(self, translation_unit):
+        """Test that the walk reports the function around each node."""
+        walk = ASTTraverser.walk_with_enclosing_function(translation_unit.cursor)
+        functions = [
+            (node.spelling, function.spelling if function else None)
+            for node, function in walk
+            if node.kind in (CursorKind.DECL_REF_EXPR, CursorKind.FUNCTION_DECL)
+        ]
+
+        assert functions == [
+            ("tick", None),
+            ("counter", "tick"),
+            ("reset", None),
+            ("counter", "reset")
+        ]
+
+
+class FakeFile:
+    def __init__(self, name):
+        self.name = name
+
+
+class FakeLocation:
+    def __init__(self, file_name, system=False):
+        self.file = FakeFile(file_name)
+        self.is_in_system_header = system
+
+
+class FakeCursorAt:
+    def __init__(self, location):
+        self.location = location
+
+
+class TestASTTraverser:
+    def test_walk_order_and_depth(self, translation_unit):
+        """Test that the walk is pre-order and honours max_depth."""
+        names = [node.spelling for node in ASTTraverser.walk_ast(translation_unit.cursor)]
+        assert names == ["", "counter", "tick", "", "counter", "reset", "", "counter", "counter"]
+
+        shallow = list(ASTTraverser.walk_ast(translation_unit.cursor, max_depth=1))
+        assert [node.spelling for node in shallow] == ["", "counter", "tick", "reset"]
+
+    def test_deep_nesting_does_not_recurse(self):
+        """Test that nesting far beyond the recursion limit is walked."""
+        node = FakeCursor(CursorKind.INTEGER_LITERAL)
+        for _ in range(5000):
+            node = FakeCursor(CursorKind.PAREN_EXPR, children=[node])
+
+        assert sum(1 for _ in ASTTraverser.walk_ast(node)) == 5001
+
+    def test_prune_skips_subtree(self, translation_unit):
+        """Test that a pruned node's descendants are not visited."""
+        def prune(cursor, depth):
+            return cursor.spelling == "tick"
+
+        walk = ASTTraverser.walk_with_enclosing_function(translation_unit.cursor, prune)
+        assert [node.spelling for node, _ in walk] == ["", "counter", "reset", "", "counter", "counter"]
+
+    def test_walk_scope_prunes_other_files(self, tmp_path):
+        """Test that the project scope drops system and excluded headers only."""
+        main_file = str(tmp_path / "main.c")
+        decls = {
+            "main": FakeLocation(main_file),
+            "local": FakeLocation(str(tmp_path / "local.h")),
+            "vendor": FakeLocation(str(tmp_path / "vendor" / "lib.h")),
+            "system": FakeLocation("/usr/include/stdio.h", system=True),
+        }
+
+        def kept(scope):
+            walk_scope = WalkScope(scope, main_file, ["*/vendor/*"])
+            return [name for name, location in decls.items()
+                    if not walk_scope(FakeCursorAt(location), 1)]
+
+        assert kept(WalkScope.PROJECT) == ["main", "local"]
+        assert kept(WalkScope.MAIN_FILE) == ["main"]
+
+
+class TestCompileCommandsDatabase:
+    def test_sanitize_drops_driver_only_options(self):
+        """Test that compiler, source, output and dependency options are removed."""
+        args = CompileCommandsDatabase.sanitize_arguments(
+            ["arm-none-eabi-gcc", "-std=gnu11", "-Iinc", "-DBOARD=2",
+             "-c", "src/uart.c", "-o", "build/uart.o", "-MD", "-MF", "build/uart.d"],
+            "/work/src/uart.c",
+            "/work"
+        )
+
+        assert args == ["-working-directory", "/work", "-std=gnu11", "-Iinc", "-DBOARD=2"]
+
+    def test_sanitize_keeps_other_inputs(self):
+        """Test that only the compiled file itself is removed."""
+        args = CompileCommandsDatabase.sanitize_arguments(
+            ["clang++", "-std=c++17", "main.cpp", "-include", "config.h", "-omain.o"],
+            "/work/main.cpp",
+            "/work"
+        )
+
+        assert args == ["-working-directory", "/work", "-std=c++17", "-include", "config.h"]
+
+    def test_missing_database(self, tmp_path):
+        """Test that a missing database raises FileNotFoundError."""
+        with pytest.raises(FileNotFoundError):
+            CompileCommandsDatabase(str(tmp_path))
+
+
+class TestSourceBufferCache:
+    def test_text_and_lines(self, tmp_path):
+        """Test snippet extraction across lines."""
+        source = tmp_path / "main.c"
+        source.write_text("int a;\nint main(void) {\n    return a;\n}\n")
+        cache = SourceBufferCache()
+
+        assert cache.get_text(str(source), 1, 5, 1, 6) == "a"
+        assert cache.get_text(str(source), 2, 5, 3, 11) == "main(void) {\n    return"
+        assert cache.get_lines(str(source), 3, 10) == ["    return a;", "}"]
+        assert cache.get_text(str(source), 9, 1, 9, 2) is None
+        assert cache.get_stats()["misses"] == 1
+        assert cache.get_stats()["hits"] == 3
+
+    def test_stale_entry_reloaded(self, tmp_path):
+        """Test that edited files are read again."""
+        source = tmp_path / "main.c"
+        source.write_text("int a;\n")
+        cache = SourceBufferCache()
+        assert cache.get_line(str(source), 1) == "int a;"
+
+        source.write_text("long value;\n")
+        assert cache.get_line(str(source), 1) == "long value;"
+
+    def test_lru_bound(self, tmp_path):
+        """Test that least recently used files are evicted."""
+        files = []
+        for name in ("a.c", "b.c", "c.c"):
+            path = tmp_path / name
+            path.write_text("x" * 10 + "\n")
+            files.append(str(path))
+        cache = SourceBufferCache(max_bytes=25)
+
+        cache.get_line(files[0], 1)
+        cache.get_line(files[1], 1)
+        cache.get_line(files[0], 1)
+        cache.get_line(files[2], 1)
+
+        assert cache.get_stats()["files"] == 2
+        assert cache.get_stats()["bytes"] <= 25
+        cache.get_line(files[0], 1)
+        assert cache.get_stats()["hits"] == 2
+
+    def test_concurrent_use(self, tmp_path, monkeypatch):
+        """Test that threads sharing one small cache keep it consistent."""
+        files = []
+        for index in range(8):
+            path = tmp_path / f"f{index}.c"
+            path.write_text(f"int v{index};\n")
+            files.append(str(path))
+        monkeypatch.setattr(SourceBufferCache, "_shared", None)
+        caches = []
+        errors = []
+
+        def worker(offset):
+            try:
+                cache = SourceBufferCache.shared()
+                caches.append(cache)
+                cache.max_bytes = 40
+                for step in range(300):
+                    index = (offset + step) % len(files)
+                    assert cache.get_line(files[index], 1) == f"int v{index};"
+            except Exception as e:
+                errors.append(e)
+
+        threads = [threading.Thread(target=worker, args=(i,)) for i in range(8)]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+
+        assert not errors
+        assert len({id(cache) for cache in caches}) == 1
+        stats = caches[0].get_stats()
+        assert stats["bytes"] == sum(b.size for b in caches[0]._buffers.values())
+        assert stats["hits"] + stats["misses"] == 8 * 300
+
+
+class FakeDiagnostic:
+    def __init__(self, severity):
+        self.severity = severity
+        self.spelling = "error"
+        self.location = FakeLocation("common.h", 1)
+
+
+class FakeParsedUnit:
+    def __init__(self, diagnostics=()):
+        self.diagnostics = list(diagnostics)
+
+    def get_includes(self):
+        return iter(())
+
+    def save(self, path):
+        with open(path, "w") as f:
+            f.write("pch")
+
+
+class FakeIndex:
+    """Records parses; the prefix header parse is the PCH build."""
+
+    def __init__(self, build_errors=False, reject_pch=False):
+        self.build_errors = build_errors
+        self.reject_pch = reject_pch
+        self.builds = 0
+        self.parses = []
+
+    def parse(self, path, args=None, options=0):
+        if os.path.basename(path).startswith("common_"):
+            self.builds += 1
+            return FakeParsedUnit([FakeDiagnostic(3)] if self.build_errors else [])
+        with_pch = "-include-pch" in args
+        self.parses.append(with_pch)
+        if with_pch and self.reject_pch:
+            return FakeParsedUnit([FakeDiagnostic(4)])
+        return FakeParsedUnit()
+
+
+class TestPrecompiledHeaders:
+    def make_parser(self, tmp_path, index, pch_dir=None):
+        header = tmp_path / "common.h"
+        if not header.exists():
+            header.write_text("int shared;\n")
+        (tmp_path / "main.c").write_text('#include "common.h"\n')
+        parser = ASTParser(precompiled_headers=[str(header)], pch_dir=pch_dir)
+        parser.index = index
+        return parser
+
+    def test_built_once_and_reused(self, tmp_path):
+        """Test that the PCH is built once, used by every parse and found by other parsers."""
+        index = FakeIndex()
+        pch_dir = str(tmp_path / "pch")
+        parser = self.make_parser(tmp_path, index, pch_dir)
+        parser.parse_file(str(tmp_path / "main.c"))
+        parser.parse_file(str(tmp_path / "main.c"))
+
+        assert index.builds == 1
+        assert index.parses == [True, True]
+
+        other = self.make_parser(tmp_path, index, pch_dir)
+        other.parse_file(str(tmp_path / "main.c"))
+        assert index.builds == 1
+
+    def test_rebuilt_when_header_changes(self, tmp_path):
+        index = FakeIndex()
+        parser = self.make_parser(tmp_path, index)
+        parser.parse_file(str(tmp_path / "main.c"))
+
+        header = tmp_path / "common.h"
+        stat = os.stat(header)
+        os.utime(header, ns=(stat.st_atime_ns, stat.st_mtime_ns + 1_000_000_000))
+        parser.parse_file(str(tmp_path / "main.c"))
+        assert index.builds == 2
+
+    def test_failed_build_falls_back_without_retrying(self, tmp_path):
+        """Test that headers that do not compile are parsed normally, and only tried once."""
+        index = FakeIndex(build_errors=True)
+        parser = self.make_parser(tmp_path, index)
+        parser.parse_file(str(tmp_path / "main.c"))
+        parser.parse_file(str(tmp_path / "main.c"))
+
+        assert index.builds == 1
+        assert index.parses == [False, False]
+
+    def test_rejected_pch_falls_back(self, tmp_path):
+        """Test that a PCH clang refuses (e.g. stale) is replaced by a plain parse."""
+        index = FakeIndex(reject_pch=True)
+        parser = self.make_parser(tmp_path, index)
+
+        assert parser.parse_file(str(tmp_path / "main.c")) is not None
+        assert index.parses == [True, False]
+
+    def test_temporary_directory_removed_on_close(self, tmp_path):
+        parser = self.make_parser(tmp_path, FakeIndex())
+        parser.parse_file(str(tmp_path / "main.c"))
+        pch_dir = parser.pch_dir
+        assert os.path.isdir(pch_dir)
+
+        parser.close()
+        assert not os.path.exists(pch_dir)
+
+        owned = self.make_parser(tmp_path, FakeIndex(), str(tmp_path / "pch"))
+        owned.parse_file(str(tmp_path / "main.c"))
+        owned.close()
+        assert os.path.isdir(tmp_path / "pch")
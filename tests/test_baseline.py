@@ -0,0 +1,106 @@
+"""Test fingerprint-based baseline comparison."""
+
+import io
+import os
+
+from static_analyzer.baseline import INDEX_SUFFIX, BaselineIndex, compare_with_baseline
+from static_analyzer.models import AnalysisReport
+from static_analyzer.store import ViolationStore
+
+from conftest import make_violation
+
+
+def write_baseline(path, violations):
+    path.write_text(AnalysisReport(list(violations), {}, {}).to_json())
+    return str(path)
+
+
+class TestBaselineIndex:
+    def test_moved_lines_still_match(self):
+        """Test that lines inserted above a violation do not make it new."""
+        baseline = [make_violation(line=10), make_violation(line=20, source_context="q->next = 0;")]
+        current = [make_violation(line=13), make_violation(line=23, source_context="q->next  =  0;"),
+                   make_violation(line=30, source_context="*r = 1;")]
+
+        comparison = BaselineIndex.from_violations(baseline).compare(current)
+        assert comparison.new == [2]
+        assert comparison.fixed == []
+        assert comparison.moved == 2
+
+    def test_function_and_tolerance_bound_matches(self):
+        """Test that the same snippet in another function, or moved too far, is new."""
+        baseline = [make_violation(line=10, enclosing_function="reset")]
+        index = BaselineIndex.from_violations(baseline)
+
+        assert index.compare([make_violation(line=10, enclosing_function="flush")]).new == [0]
+        assert index.compare([make_violation(line=60)], line_tolerance=20).new == [0]
+        assert index.compare([make_violation(line=60)], line_tolerance=20).fixed == [0]
+
+    def test_repeated_snippets_pair_in_order(self):
+        """Test that identical violations in one function keep their count."""
+        baseline = [make_violation(line=10), make_violation(line=12), make_violation(line=14)]
+        current = [make_violation(line=12), make_violation(line=15)]
+
+        comparison = BaselineIndex.from_violations(baseline).compare(current)
+        assert comparison.new == []
+        assert comparison.fixed == [0]
+
+    def test_baseline_without_functions(self):
+        """Test that reports from before enclosing functions were recorded still match."""
+        old = make_violation(line=10).to_dict()
+        del old["enclosing_function"]
+
+        current = make_violation(line=11, enclosing_function="reset")
+        comparison = BaselineIndex.from_violations([old]).compare([current])
+        assert comparison.new == []
+
+
+class TestBaselineSidecar:
+    def test_sidecar_written_and_refreshed(self, tmp_path):
+        """Test that the sidecar is reused and rebuilt once the baseline changes."""
+        path = write_baseline(tmp_path / "baseline.json", [make_violation(line=10)])
+
+        new, _ = compare_with_baseline([make_violation(line=12)], path)
+        assert new == []
+        assert os.path.exists(path + INDEX_SUFFIX)
+        assert len(BaselineIndex.load(path)) == 1
+
+        write_baseline(tmp_path / "baseline.json",
+                       [make_violation(line=10), make_violation(line=40, source_context="*r = 1;")])
+        stat = os.stat(path)
+        os.utime(path, ns=(stat.st_atime_ns, stat.st_mtime_ns + 1_000_000_000))
+        assert len(BaselineIndex.load(path)) == 2
+
+    def test_failed_write_leaves_no_temp_file(self, tmp_path, monkeypatch):
+        path = write_baseline(tmp_path / "baseline.json", [make_violation(line=10)])
+
+        def fail(*args):
+            raise OSError("disk full")
+
+        monkeypatch.setattr(os, "replace", fail)
+        assert len(BaselineIndex.load(path)) == 1
+        assert os.listdir(tmp_path) == ["baseline.json"]
+
+    def test_store_baseline(self, tmp_path):
+        """Test that a saved binary store is a baseline like a JSON report."""
+        path = str(tmp_path / "baseline.store")
+        ViolationStore.from_violations([make_violation(line=10),
+                                        make_violation(line=20, source_context="*q = 0;")]).save(path)
+
+        current = [make_violation(line=11), make_violation(line=50, source_context="*z = 0;")]
+        new, comparison = compare_with_baseline(current, path)
+        assert [v.location.line for v in new] == [50]
+        assert comparison.fixed == [1]
+
+    def test_store_without_function_column_loads(self):
+        """Test that a store written before the enclosing_function column reads back."""
+        store = ViolationStore.from_violations([make_violation(line=10, enclosing_function="reset")])
+        del store.columns["enclosing_function"]
+        stream = io.BytesIO()
+        store.write(stream)
+        stream.seek(0)
+
+        loaded = ViolationStore.read(stream)
+        assert loaded.violation(0).enclosing_function is None
+        current = make_violation(line=12, enclosing_function="reset")
+        assert BaselineIndex.from_store(loaded).compare([current]).new == []
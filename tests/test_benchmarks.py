@@ -0,0 +1,52 @@
+"""Test benchmark helpers that don't need libclang."""
+
+from benchmarks import compare_results
+from benchmarks.synthetic import generate_source
+
+
+def make_results(**metrics):
+    result = {
+        "files": 3,
+        "total_seconds": 2.0,
+        "parse_seconds": 1.0,
+        "rule_seconds": {"CERT-EXP34-C": 0.5},
+        "rule_seconds_total": 0.5,
+        "nodes_visited": 1000,
+        "violations": 10,
+        "peak_rss_mb": 100.0
+    }
+    result.update(metrics)
+    return {"results": {"samples": result}}
+
+
+class TestCompareResults:
+    def test_regressions_beyond_tolerance_and_noise(self):
+        """Test that only slowdowns past tolerance and noise floor are reported."""
+        baseline = make_results()
+        current = make_results(total_seconds=3.0, parse_seconds=1.1, peak_rss_mb=103.0)
+
+        findings = compare_results(current, baseline, tolerance=0.2)
+
+        assert [(f["metric"], f["kind"]) for f in findings] == [("total_seconds", "regression")]
+
+    def test_improvements_and_changed_counts(self):
+        """Test that speedups and changed analysis output are reported."""
+        baseline = make_results()
+        current = make_results(rule_seconds={"CERT-EXP34-C": 0.1}, rule_seconds_total=0.1,
+                               violations=12)
+
+        findings = {(f["metric"], f["kind"]) for f in compare_results(current, baseline)}
+
+        assert findings == {("rule_seconds_total", "improvement"),
+                            ("rule_seconds.CERT-EXP34-C", "improvement"),
+                            ("violations", "changed")}
+
+
+class TestSyntheticCorpus:
+    def test_generation_is_deterministic(self):
+        """Test that the same seed yields the same source."""
+        source = generate_source(globals_count=30, switch_depth=4, pointer_functions=3, seed=7)
+        assert source == generate_source(globals_count=30, switch_depth=4,
+                                         pointer_functions=3, seed=7)
+        assert source.count("switch (") == 4 * (30 // 20)
+        assert "pointer_walk_2" in source
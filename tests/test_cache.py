@@ -0,0 +1,126 @@
+"""Test persistent result and AI response caches."""
+
+import os
+import time
+
+import pytest
+
+from static_analyzer.cache import ResultCache, ResponseCache
+
+from conftest import make_violation
+
+
+@pytest.fixture
+def source_tree(tmp_path):
+    header = tmp_path / "sensor.h"
+    header.write_text("extern int sensor_value;\n")
+    source = tmp_path / "sensor.c"
+    source.write_text('#include "sensor.h"\nint sensor_value;\n')
+    return source, header
+
+
+class TestResultCache:
+    def test_miss_then_hit(self, tmp_path, source_tree):
+        """Test that stored results are returned on the next lookup."""
+        source, header = source_tree
+        cache = ResultCache(str(tmp_path / "cache"))
+        fingerprint = ResultCache.compute_fingerprint(["MISRA-C-2012-8.7"], [], "1.0.0")
+
+        assert cache.lookup(str(source), fingerprint) is None
+        violation = make_violation("MISRA-C-2012-8.7", str(source), 2, 5,
+                                   metadata={"variable_name": "sensor_value"})
+        cache.store(str(source), fingerprint, [str(header)], [violation])
+
+        cached = cache.lookup(str(source), fingerprint)
+        assert cached is not None
+        assert cached[0].rule_id == "MISRA-C-2012-8.7"
+        assert cached[0].location.line == 2
+        assert cached[0].metadata == {"variable_name": "sensor_value"}
+        assert cache.get_stats()["hits"] == 1
+        assert cache.get_stats()["misses"] == 1
+
+    def test_source_change_invalidates(self, tmp_path, source_tree):
+        """Test that editing the source file causes a miss."""
+        source, header = source_tree
+        cache = ResultCache(str(tmp_path / "cache"))
+        fingerprint = ResultCache.compute_fingerprint([], [], "1.0.0")
+        cache.store(str(source), fingerprint, [str(header)], [])
+
+        source.write_text('#include "sensor.h"\nstatic int sensor_value;\n')
+        assert cache.lookup(str(source), fingerprint) is None
+
+    def test_include_change_invalidates(self, tmp_path, source_tree):
+        """Test that editing an included header causes a miss."""
+        source, header = source_tree
+        cache = ResultCache(str(tmp_path / "cache"))
+        fingerprint = ResultCache.compute_fingerprint([], [], "1.0.0")
+        cache.store(str(source), fingerprint, [str(header)], [])
+        assert cache.lookup(str(source), fingerprint) == []
+
+        header.write_text("extern long sensor_value;\n")
+        assert cache.lookup(str(source), fingerprint) is None
+
+    def test_fingerprint_isolates_configurations(self, tmp_path, source_tree):
+        """Test that a different rule set does not reuse entries."""
+        source, _ = source_tree
+        cache = ResultCache(str(tmp_path / "cache"))
+        first = ResultCache.compute_fingerprint(["CERT-EXP34-C"], [], "1.0.0")
+        second = ResultCache.compute_fingerprint(["CERT-ARR30-C"], [], "1.0.0")
+        assert first != second
+        assert first == ResultCache.compute_fingerprint(["CERT-EXP34-C"], [], "1.0.0")
+
+        cache.store(str(source), first, [], [])
+        assert cache.lookup(str(source), second) is None
+
+    def test_clear(self, tmp_path, source_tree):
+        """Test that clearing the cache removes entries."""
+        source, _ = source_tree
+        cache = ResultCache(str(tmp_path / "cache"))
+        fingerprint = ResultCache.compute_fingerprint([], [], "1.0.0")
+        cache.store(str(source), fingerprint, [], [])
+
+        cache.clear()
+        assert not (tmp_path / "cache").exists()
+        assert cache.lookup(str(source), fingerprint) is None
+
+
+class TestResponseCache:
+    FIELDS = {"explanation": "E", "risk_summary": "R", "suggested_fix": "F"}
+
+    def test_key_ignores_whitespace_only(self):
+        """Test that the key normalizes context but separates rule, model and prompt."""
+        key = ResponseCache.compute_key("MISRA-C-2012-10.1", "gpt-4", 1, "x = a  +\n b;")
+        assert key == ResponseCache.compute_key("MISRA-C-2012-10.1", "gpt-4", 1, "x = a + b;")
+        assert key != ResponseCache.compute_key("MISRA-C-2012-10.1", "gpt-4o", 1, "x = a + b;")
+        assert key != ResponseCache.compute_key("MISRA-C-2012-10.1", "gpt-4", 2, "x = a + b;")
+        assert key != ResponseCache.compute_key("CERT-EXP34-C", "gpt-4", 1, "x = a + b;")
+
+    def test_hit_miss_and_ttl(self, tmp_path):
+        """Test lookups, expiry and hit ratio."""
+        cache = ResponseCache(str(tmp_path / "ai"), ttl_seconds=60)
+        key = ResponseCache.compute_key("CERT-EXP34-C", "gpt-4", 1, "*p = 1;")
+        assert cache.get(key) is None
+
+        cache.put(key, self.FIELDS)
+        assert cache.get(key) == self.FIELDS
+        assert cache.get_stats()["hit_ratio"] == 0.5
+
+        cache.ttl_seconds = 0.001
+        time.sleep(0.01)
+        assert cache.get(key) is None
+
+    def test_prune_keeps_most_recently_used(self, tmp_path):
+        """Test that pruning evicts the least recently used entries."""
+        cache = ResponseCache(str(tmp_path / "ai"), max_entries=2)
+        keys = [ResponseCache.compute_key("R", "m", 1, f"line {i}") for i in range(3)]
+        for age, key in zip((300, 200, 100), keys):
+            cache.put(key, self.FIELDS)
+            stamp = time.time() - age
+            os.utime(cache._entry_path(key), (stamp, stamp))
+
+        cache.get(keys[0])
+        cache.prune()
+
+        assert cache.get(keys[0]) == self.FIELDS
+        assert cache.get(keys[1]) is None
+        assert cache.get(keys[2]) == self.FIELDS
@@ -5,8 +5,15 @@ import tempfile
 import os
 from pathlib import Path
 
-from static_analyzer.config import AnalyzerConfig, DeviationManager, create_default_config_file
-from static_analyzer.models import Standard
+from datetime import date
+
+from static_analyzer.config import (
+    AnalyzerConfig,
+    DeviationManager,
+    DeviationIndex,
+    create_default_config_file
+)
+from static_analyzer.models import Standard, Deviation
 
 
 class TestAnalyzerConfig:
@@ -71,6 +78,21 @@ ai_assistant:
         finally:
             os.unlink(config_file)
     
+    def test_parallelism(self):
+        """Test worker count configuration."""
+        assert AnalyzerConfig.create_default().get_parallelism() == 1
+        
+        config = AnalyzerConfig({"analysis": {"parallelism": 4}})
+        assert config.get_parallelism() == 4
+        
+        config = AnalyzerConfig({"analysis": {"parallelism": 0}})
+        assert config.get_parallelism() == (os.cpu_count() or 1)
+    
+    def test_native_backend_is_opt_in(self):
+        """Test that the compiled walk is only used when enabled."""
+        assert not AnalyzerConfig.create_default().is_native_backend_enabled()
+        assert AnalyzerConfig({"analysis": {"native_backend": True}}).is_native_backend_enabled()
+    
     def test_save_config_to_file(self):
         """Test saving configuration to file."""
         config = AnalyzerConfig.create_default()
@@ -179,6 +201,68 @@ deviations:
                 os.unlink(sample_file)
 
 
+def make_deviation(rule_id, file_pattern, line_ranges=None, expiry_date=None):
+    return Deviation(
+        rule_id=rule_id,
+        file_pattern=file_pattern,
+        justification="Test",
+        approved_by="Reviewer",
+        approval_date="2024-01-15",
+        expiry_date=expiry_date,
+        line_ranges=line_ranges
+    )
+
+
+class TestDeviationIndex:
+    def test_first_matching_deviation_wins(self):
+        """Test rule, path and line matching in file order."""
+        first = make_deviation("CERT-EXP34-C", "drivers/", [[100, 150]])
+        second = make_deviation("CERT-EXP34-C", "uart", [[120, 300]])
+        whole_file = make_deviation("CERT-EXP34-C", "src/drivers/uart.c")
+        index = DeviationIndex([first, second, whole_file])
+
+        assert index.match("CERT-EXP34-C", "src/drivers/uart.c", 125) is first
+        assert index.match("CERT-EXP34-C", "src/drivers/uart.c", 200) is second
+        assert index.match("CERT-EXP34-C", "src/drivers/uart.c", 10) is whole_file
+        assert index.match("CERT-EXP34-C", "src/drivers/spi.c", 200) is None
+        assert index.match("CERT-EXP34-C", "src/drivers/spi.c", 110) is first
+        assert index.match("MISRA-C-2012-8.7", "src/drivers/uart.c", 125) is None
+
+    def test_glob_patterns(self):
+        """Test that glob patterns match whole path components."""
+        deviation = make_deviation("MISRA-C-2012-10.1", "third_party/*.c")
+        index = DeviationIndex([deviation])
+
+        assert index.match("MISRA-C-2012-10.1", "/repo/third_party/lib.c", 1) is deviation
+        assert index.match("MISRA-C-2012-10.1", "/repo/third_party/lib.h", 1) is None
+
+    def test_expired_deviations_ignored(self):
+        """Test that expiry is applied when the index is built."""
+        expired = make_deviation("MISRA-C-2012-8.7", "legacy/", expiry_date="2024-12-31")
+        active = make_deviation("MISRA-C-2012-8.7", "legacy/", expiry_date="2030-01-01")
+        index = DeviationIndex([expired, active], today=date(2026, 1, 1))
+
+        assert index.expired == [expired]
+        assert index.match("MISRA-C-2012-8.7", "legacy/old.c", 5) is active
+
+    def test_manager_reindexes_on_change(self):
+        """Test that added deviations are picked up."""
+        manager = DeviationManager()
+
+        class MockLocation:
+            file_path = "legacy/old.c"
+            line = 3
+
+        class MockViolation:
+            rule_id = "MISRA-C-2012-8.7"
+            location = MockLocation()
+
+        assert manager.is_violation_suppressed(MockViolation()) == (False, None)
+        deviation = make_deviation("MISRA-C-2012-8.7", "legacy/")
+        manager.add_deviation(deviation)
+        assert manager.is_violation_suppressed(MockViolation()) == (True, deviation)
+
+
 def test_create_default_config_file():
     """Test creation of default configuration file."""
     with tempfile.NamedTemporaryFile(mode='w', suffix='.yaml', delete=False) as f:
@@ -0,0 +1,255 @@
+"""Test the analysis daemon and the parser's translation unit cache."""
+
+import os
+import threading
+import time
+
+import pytest
+
+import static_analyzer
+import static_analyzer.daemon as daemon
+from static_analyzer import AnalyzerConfig, StaticAnalyzer
+from static_analyzer.ast import ASTParser
+from static_analyzer.daemon import AnalysisService, DaemonClient, DaemonError, WarmAnalyzer
+from static_analyzer.models import AnalysisReport
+
+
+class FakeTranslationUnit:
+    def __init__(self):
+        self.diagnostics = []
+        self.reparses = 0
+
+    def get_includes(self):
+        return iter([])
+
+    def reparse(self, unsaved_files=None, options=0):
+        self.reparses += 1
+
+
+class FakeIndex:
+    def __init__(self):
+        self.parses = []
+
+    def parse(self, path, args=None, options=0):
+        self.parses.append(path)
+        return FakeTranslationUnit()
+
+
+class FakeParser:
+    def get_tu_cache_stats(self):
+        return {"entries": 0}
+
+
+class FakeAnalyzer:
+    """Stands in for StaticAnalyzer so the service can be tested without libclang."""
+
+    def __init__(self, config, deviations_file=None):
+        self.config = config
+        self.ast_parser = FakeParser()
+        self.closed = False
+
+    def close(self):
+        self.closed = True
+
+    def analyze_files(self, file_paths, enabled_rules=None):
+        return AnalysisReport([], {"total_violations": 0},
+                              {"files": file_paths, "rules": enabled_rules,
+                               "tu_cache_size": self.config.get_tu_cache_size()})
+
+    def iter_violations(self, file_paths, enabled_rules=None, deadline=None):
+        for file_path in file_paths:
+            if deadline is not None and time.monotonic() >= deadline:
+                return
+            yield file_path, []
+
+
+def _init_no_worker(config_dict):
+    pass
+
+
+def _analyze_slowly(file_path, enabled_rules, whole_program=False):
+    time.sleep(5 if "slow" in file_path else 0.01)
+    return [], {}
+
+
+@pytest.fixture
+def parser():
+    parser = ASTParser(tu_cache_size=2)
+    parser.index = FakeIndex()
+    return parser
+
+
+class TestTranslationUnitCache:
+    def test_unchanged_file_reuses_unit(self, parser, tmp_path):
+        """Test that a second parse of an unchanged file is served from the cache."""
+        source = tmp_path / "main.c"
+        source.write_text("int main(void) { return 0; }\n")
+
+        first = parser.parse_file(str(source))
+        assert parser.parse_file(str(source)) is first
+        assert parser.index.parses == [str(source)]
+        assert parser.get_tu_cache_stats()["hits"] == 1
+
+    def test_changed_file_is_reparsed(self, parser, tmp_path):
+        """Test that an edited file reparses the cached unit instead of parsing again."""
+        source = tmp_path / "main.c"
+        source.write_text("int main(void) { return 0; }\n")
+        first = parser.parse_file(str(source))
+
+        source.write_text("int main(void) { return 1 + 1; }\n")
+        assert parser.parse_file(str(source)) is first
+        assert first.reparses == 1
+        assert len(parser.index.parses) == 1
+
+    def test_least_recently_used_unit_evicted(self, parser, tmp_path):
+        """Test that the cache holds at most tu_cache_size units."""
+        paths = []
+        for name in ("a.c", "b.c", "c.c"):
+            path = tmp_path / name
+            path.write_text("int x;\n")
+            paths.append(str(path))
+            parser.parse_file(str(path))
+
+        assert parser.get_tu_cache_stats()["entries"] == 2
+        parser.parse_file(paths[0])
+        assert parser.index.parses.count(paths[0]) == 2
+
+
+class TestDeadline:
+    def test_parallel_run_abandons_files_at_the_deadline(self, monkeypatch):
+        """Test that one slow unit doesn't hold the run past its deadline."""
+        monkeypatch.setattr(static_analyzer, "_init_worker", _init_no_worker)
+        monkeypatch.setattr(static_analyzer, "_analyze_file_in_worker", _analyze_slowly)
+        analyzer = StaticAnalyzer(AnalyzerConfig({"analysis": {"parallelism": 2}}))
+        monkeypatch.setattr(analyzer.ast_parser, "get_precompiled_header", lambda: None)
+
+        started = time.monotonic()
+        results = analyzer.iter_file_results(["a.c", "slow.c", "b.c"], [], ordered=False,
+                                             deadline=started + 1)
+        assert sorted(path for path, _, _ in results) == ["a.c", "b.c"]
+        assert time.monotonic() - started < 3
+
+
+class TestAnalysisService:
+    def test_analyzers_reused_per_config(self, monkeypatch):
+        """Test that equal configurations share one warm analyzer."""
+        monkeypatch.setattr(daemon, "StaticAnalyzer", FakeAnalyzer)
+        service = AnalysisService(max_analyzers=1, tu_cache_size=8)
+
+        first = service.get({"standards": ["MISRA"]})
+        assert service.get({"standards": ["MISRA"]}) is first
+        assert first.analyzer.config.get_tu_cache_size() == 8
+
+        other = service.get({"standards": ["CERT"]})
+        assert other is not first
+        assert service.get({"standards": ["MISRA"]}) is not first
+
+    def test_runs_of_one_config_proceed_concurrently(self, monkeypatch):
+        """Test that a long run doesn't hold up a second one with the same config."""
+        monkeypatch.setattr(daemon, "StaticAnalyzer", FakeAnalyzer)
+        warm = AnalysisService(instances=2).get({"standards": ["MISRA"]})
+
+        with warm.session() as first:
+            with warm.session() as second:
+                assert second is not first
+                assert warm.get_stats()["busy"] == 2
+
+            other_run = threading.Thread(target=lambda: warm.analyze_files(["b.c"]))
+            other_run.start()
+            other_run.join(5)
+            assert not other_run.is_alive()
+
+        assert warm.get_stats()["instances"] == 2
+        with warm.session() as again:
+            assert again is first or again is second
+
+    def test_runs_beyond_the_pool_wait(self, monkeypatch):
+        monkeypatch.setattr(daemon, "StaticAnalyzer", FakeAnalyzer)
+        warm = AnalysisService(instances=1).get(None)
+        waited = threading.Event()
+
+        def run():
+            with warm.session():
+                waited.set()
+
+        with warm.session():
+            waiter = threading.Thread(target=run)
+            waiter.start()
+            assert not waited.wait(0.1)
+        waiter.join(5)
+        assert waited.is_set()
+
+    def test_stream_gives_up_waiting_at_the_deadline(self, monkeypatch):
+        """Test that a stream queued behind busy instances ends at its deadline."""
+        monkeypatch.setattr(daemon, "StaticAnalyzer", FakeAnalyzer)
+        service = AnalysisService(instances=1)
+        warm = service.get(None)
+
+        with warm.session():
+            started = time.monotonic()
+            results = list(service.iter_violations({"files": ["a.c"], "time_budget": 0.1}))
+        assert results == []
+        assert time.monotonic() - started < 2
+        assert [path for path, _ in service.iter_violations({"files": ["a.c"],
+                                                             "time_budget": 5})] == ["a.c"]
+
+    def test_evicted_analyzers_are_closed(self, monkeypatch):
+        """Test that dropping a configuration closes its analyzers once idle."""
+        monkeypatch.setattr(daemon, "StaticAnalyzer", FakeAnalyzer)
+        service = AnalysisService(max_analyzers=1)
+        first = service.get({"standards": ["MISRA"]})
+
+        with first.session() as busy:
+            service.get({"standards": ["CERT"]})
+            assert not busy.closed
+        assert busy.closed
+
+    def test_unknown_method(self):
+        with pytest.raises(DaemonError):
+            AnalysisService().handle("reboot", {})
+
+
+class TestDaemonServer:
+    def test_round_trip_over_socket(self, monkeypatch, tmp_path):
+        """Test analyze, status and shutdown through a real Unix socket."""
+        monkeypatch.setattr(daemon, "StaticAnalyzer", FakeAnalyzer)
+        socket_path = str(tmp_path / "daemon.sock")
+        ready = threading.Event()
+        server = threading.Thread(target=daemon.serve,
+                                  args=(socket_path, AnalysisService(), ready))
+        server.start()
+        assert ready.wait(5)
+
+        client = DaemonClient(socket_path)
+        assert client.is_available()
+        assert os.stat(socket_path).st_mode & 0o777 == 0o600
+        report = client.remote_analyzer().analyze_files(["main.c"], ["CERT-EXP34-C"])
+        assert report.metadata["files"] == [os.path.abspath("main.c")]
+        assert report.metadata["rules"] == ["CERT-EXP34-C"]
+        assert client.status()["requests"] == 3
+
+        with pytest.raises(DaemonError):
+            client.request("analyze")
+
+        streamed = client.remote_analyzer().iter_violations(["a.c", "b.c"])
+        assert [path for path, _ in streamed] == [os.path.abspath("a.c"), os.path.abspath("b.c")]
+        streamed = client.remote_analyzer().iter_violations(["a.c", "b.c"])
+        assert next(streamed)[0] == os.path.abspath("a.c")
+        streamed.close()
+
+        client.shutdown()
+        server.join(5)
+        assert not server.is_alive()
+        assert not os.path.exists(socket_path)
+        assert not client.is_available()
+
+    def test_falls_back_to_local_analyzer(self, monkeypatch, tmp_path):
+        """Test that get_analyzer uses the in-process pool when no daemon runs."""
+        monkeypatch.setattr(daemon, "StaticAnalyzer", FakeAnalyzer)
+        monkeypatch.setattr(daemon, "_local_service", None)
+        monkeypatch.setenv(daemon.SOCKET_ENV, str(tmp_path / "missing.sock"))
+
+        analyzer = daemon.get_analyzer()
+        assert isinstance(analyzer, WarmAnalyzer)
+        assert daemon.get_analyzer() is analyzer
+        assert analyzer.analyze_files(["a.c"]).metadata["files"] == ["a.c"]
@@ -0,0 +1,53 @@
+"""Test incremental analysis helpers."""
+
+import json
+
+from static_analyzer import AnalyzerConfig, StaticAnalyzer
+from static_analyzer.incremental import IncludeGraph
+
+
+class TestIncludeGraph:
+    def test_header_change_impacts_includers(self):
+        """Test that TUs including a changed header are re-analyzed."""
+        graph = IncludeGraph()
+        graph.set_includes("sensor.cpp", ["sensor.h"])
+        graph.set_includes("device.cpp", ["device.h", "sensor.h"])
+        graph.set_includes("main.cpp", ["device.h"])
+
+        assert graph.get_impacted(["sensor.h"]) == {"sensor.cpp", "device.cpp"}
+        assert graph.get_impacted(["main.cpp"]) == {"main.cpp"}
+        assert graph.get_impacted(["README.md"]) == set()
+
+    def test_update_and_round_trip(self):
+        """Test that replacing includes refreshes the reverse index."""
+        graph = IncludeGraph({"main.cpp": ["device.h"]})
+        assert graph.get_impacted(["device.h"]) == {"main.cpp"}
+
+        graph.set_includes("main.cpp", ["sensor.h"])
+        assert graph.get_impacted(["device.h"]) == set()
+
+        restored = IncludeGraph.from_dict(graph.to_dict())
+        assert restored.get_includes("main.cpp") == ["sensor.h"]
+        restored.remove("main.cpp")
+        assert restored.get_translation_units() == []
+
+
+class TestCollectSourceFiles:
+    def test_compile_commands_and_excludes(self, tmp_path):
+        """Test that a compilation database limits the files to its TUs under the path."""
+        for name in ("src/a.c", "src/b.c", "src/a.h", "vendor/v.c"):
+            (tmp_path / name).parent.mkdir(exist_ok=True)
+            (tmp_path / name).write_text("int x;\n")
+        (tmp_path / "compile_commands.json").write_text(json.dumps([
+            {"directory": str(tmp_path), "file": name, "arguments": ["cc", "-c", name]}
+            for name in ("src/a.c", "vendor/v.c")
+        ]))
+        analyzer = StaticAnalyzer(AnalyzerConfig({"analysis": {"exclude_paths": ["*/vendor/*"]}}))
+
+        assert analyzer.collect_source_files(str(tmp_path)) == [
+            str(tmp_path / name) for name in ("src/a.c", "src/a.h", "src/b.c")]
+
+        analyzer.set_compile_commands(str(tmp_path))
+        assert analyzer.collect_source_files(str(tmp_path)) == [str(tmp_path / "src/a.c")]
+        assert analyzer.collect_source_files(str(tmp_path / "src")) == [str(tmp_path / "src/a.c")]
+        assert analyzer.collect_source_files(str(tmp_path / "src/b.c")) == []
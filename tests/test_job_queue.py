@@ -0,0 +1,97 @@
+"""Test the webhook analysis job queue."""
+
+import threading
+import time
+
+import pytest
+
+from mcp_server.job_queue import Job, JobQueue, QueueFullError
+
+
+def wait_for(predicate, timeout=5.0):
+    deadline = time.time() + timeout
+    while not predicate():
+        if time.time() > deadline:
+            raise AssertionError("Timed out waiting for job queue")
+        time.sleep(0.01)
+
+
+class BlockingRunner:
+    """Job function that holds the worker until released."""
+
+    def __init__(self):
+        self.release = threading.Event()
+        self.started = threading.Event()
+        self.calls = []
+
+    def __call__(self, **kwargs):
+        self.calls.append(kwargs)
+        self.started.set()
+        self.release.wait(5)
+        return kwargs.get("sha")
+
+
+class TestJobQueue:
+    def test_runs_jobs_and_reports_timings(self):
+        """Test that jobs run on a worker and record their timings."""
+        queue = JobQueue(workers=1)
+        job, created = queue.submit(("repo", "a1"), lambda sha: sha.upper(), {"sha": "a1"})
+        assert created
+
+        wait_for(lambda: job.status == Job.DONE)
+        assert job.result == "A1"
+        assert job.run_seconds is not None
+        status = queue.get_status()
+        assert status["completed"] == 1
+        assert status["queue_depth"] == 0
+        queue.shutdown()
+
+    def test_duplicate_and_coalesced_submissions(self):
+        """Test dedup by key and replacement of queued jobs by coalesce key."""
+        runner = BlockingRunner()
+        queue = JobQueue(workers=1)
+        first, _ = queue.submit(("repo", "a1"), runner, {"sha": "a1"})
+        runner.started.wait(5)
+
+        again, created = queue.submit(("repo", "a1"), runner, {"sha": "a1"})
+        assert again is first and not created
+
+        merge = lambda old, new: {"sha": new["sha"], "carried": old["sha"]}
+        older, _ = queue.submit(("repo", "b2"), runner, {"sha": "b2"},
+                                coalesce_key=("repo", "main"), merge=merge)
+        newer, _ = queue.submit(("repo", "c3"), runner, {"sha": "c3"},
+                                coalesce_key=("repo", "main"), merge=merge)
+        assert older.status == Job.SUPERSEDED
+        assert older.superseded_by == newer.id
+        assert newer.kwargs == {"sha": "c3", "carried": "b2"}
+        # A redelivery of the superseded push maps to the job that absorbed it
+        assert queue.submit(("repo", "b2"), runner, {"sha": "b2"})[0] is newer
+
+        runner.release.set()
+        wait_for(lambda: newer.status == Job.DONE)
+        assert [call["sha"] for call in runner.calls] == ["a1", "c3"]
+        queue.shutdown()
+
+    def test_backpressure_and_failed_jobs(self):
+        """Test that a full queue rejects work and failed jobs can be retried."""
+        runner = BlockingRunner()
+        queue = JobQueue(workers=1, max_pending=1)
+        queue.submit(("repo", "a1"), runner, {"sha": "a1"})
+        runner.started.wait(5)
+        queue.submit(("repo", "b2"), runner, {"sha": "b2"})
+
+        with pytest.raises(QueueFullError):
+            queue.submit(("repo", "c3"), runner, {"sha": "c3"})
+        assert queue.get_status()["rejected"] == 1
+        runner.release.set()
+        wait_for(lambda: queue.get_status()["completed"] == 2)
+
+        def fail():
+            raise RuntimeError("boom")
+        failed, _ = queue.submit(("repo", "d4"), fail)
+        wait_for(lambda: failed.status == Job.FAILED)
+        assert failed.error == "boom"
+
+        retried, created = queue.submit(("repo", "d4"), lambda: "ok")
+        assert created and retried is not failed
+        queue.shutdown()
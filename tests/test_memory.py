@@ -0,0 +1,122 @@
+"""Test memory-bounding helpers."""
+
+import gc
+import json
+import os
+
+import pytest
+from clang.cindex import CursorKind
+
+from static_analyzer import StaticAnalyzer
+from static_analyzer.config import AnalyzerConfig
+from static_analyzer.memory import MemoryCeiling, ViolationLimiter, current_rss_bytes
+from static_analyzer.models import RuleMetadata, Severity, Standard
+from static_analyzer.reports import SpilledViolations
+from static_analyzer.rules import Rule, RuleEngine, RuleRegistry
+from static_analyzer.store import ViolationStore
+
+from conftest import FakeCursor, FakeTranslationUnit, make_violation
+
+
+class CursorKeepingRule(Rule):
+    cursor_kinds = (CursorKind.VAR_DECL,)
+
+    def get_metadata(self):
+        return RuleMetadata(
+            id="TEST-KEEP",
+            standard=Standard.MISRA,
+            title="Test",
+            description="Test",
+            rationale="Test",
+            severity=Severity.MINOR,
+            category="Test",
+            references=[]
+        )
+
+    def begin_translation_unit(self, translation_unit):
+        self.cursors = []
+
+    def check_cursor(self, cursor):
+        self.cursors.append(cursor)
+        return []
+
+    def release_translation_unit(self):
+        self.cursors = []
+
+
+class TestViolationLimiter:
+    def test_cap_per_rule_and_counts(self):
+        """Test that each rule keeps its first violations and counts the rest."""
+        limiter = ViolationLimiter(2)
+        first = limiter.admit([make_violation(rule_id, line=line)
+                               for rule_id, line in (("A", 1), ("A", 2), ("B", 3))])
+        second = limiter.admit([make_violation(rule_id, line=line)
+                                for rule_id, line in (("A", 4), ("B", 5), ("B", 6))])
+
+        assert [v.location.line for v in first + second] == [1, 2, 3, 5]
+        assert limiter.to_dict() == {"max_per_rule": 2, "total": 2, "by_rule": {"A": 1, "B": 1}}
+
+    def test_zero_keeps_everything(self):
+        limiter = ViolationLimiter(0)
+        violations = [make_violation("A", line=line) for line in range(5)]
+        assert limiter.admit(violations) == violations
+        assert limiter.total_dropped == 0
+
+
+class TestMemoryCeiling:
+    def test_disabled_and_exceeded(self):
+        assert not MemoryCeiling(0).exceeded()
+        if current_rss_bytes() is not None:
+            ceiling = MemoryCeiling(1)
+            assert ceiling.exceeded()
+            assert ceiling.peak_bytes > 1
+
+    @pytest.mark.skipif(current_rss_bytes() is None, reason="RSS cannot be measured")
+    def test_violations_past_the_ceiling_stay_in_the_spill_file(self, monkeypatch):
+        """Test that a spilled report reads violations from its file instead of holding them."""
+        decoded = []
+        decode = SpilledViolations._decode
+        monkeypatch.setattr(SpilledViolations, "_decode",
+                            staticmethod(lambda line: decoded.append(1) or decode(line)))
+        config = AnalyzerConfig.create_default()
+        config.config["analysis"]["memory_ceiling_mb"] = 1
+        results = [("main.c", [make_violation("A", line=1), make_violation("B", line=2)], {}),
+                   ("util.c", [make_violation("A", line=3)], {})]
+
+        report = StaticAnalyzer(config).build_report(results, ["A", "B"], 2)
+        assert isinstance(report.violations, SpilledViolations)
+        assert decoded == []
+        path = report.metadata["memory"]["spilled_to"]
+        assert report.metadata["memory"]["spilled_violations"] == 3
+
+        assert len(report.violations) == 3
+        assert [v.location.line for v in report.violations] == [1, 2, 3]
+        assert report.violations[-1].rule_id == "A"
+        assert len(json.loads(report.to_json())["violations"]) == 3
+        assert ViolationStore.load(path).files_analyzed == 2
+        del report
+        gc.collect()
+        assert not os.path.exists(path)
+
+    def test_memory_bounded_disables_tu_cache(self):
+        config = AnalyzerConfig.create_default()
+        config.config["analysis"]["tu_cache_size"] = 16
+        assert config.get_tu_cache_size() == 16
+
+        config.config["analysis"]["memory_bounded"] = True
+        assert config.get_tu_cache_size() == 0
+        assert config.get_max_violations_per_rule() == 1000
+
+
+class TestRuleStateRelease:
+    def test_engine_releases_rule_state_after_walk(self):
+        """Test that cursors a rule kept during the walk are dropped afterwards."""
+        registry = RuleRegistry()
+        registry.register_rule(CursorKeepingRule)
+        rule = registry.get_all_rules()[0]
+        unit = FakeTranslationUnit(FakeCursor(CursorKind.TRANSLATION_UNIT, children=[
+            FakeCursor(CursorKind.VAR_DECL), FakeCursor(CursorKind.VAR_DECL)
+        ]))
+
+        RuleEngine(registry).analyze_translation_unit(unit)
+        assert rule.cursors == []
@@ -0,0 +1,99 @@
+"""Test the bare-mirror clone cache."""
+
+import os
+import shutil
+import subprocess
+
+import pytest
+
+from static_analyzer.mirrors import MirrorCache, GitError
+
+pytestmark = pytest.mark.skipif(shutil.which("git") is None, reason="git not installed")
+
+
+def git(cwd, *args):
+    return subprocess.run(
+        ["git", "-c", "user.name=Test", "-c", "user.email=test@example.com"] + list(args),
+        cwd=cwd, check=True, capture_output=True, text=True
+    ).stdout.strip()
+
+
+@pytest.fixture
+def remote(tmp_path):
+    repo = tmp_path / "remote"
+    (repo / "src").mkdir(parents=True)
+    git(repo, "init", "-q", "-b", "main")
+    (repo / "src" / "sensor.c").write_text("int sensor;\n")
+    (repo / "README.md").write_text("docs\n")
+    git(repo, "add", ".")
+    git(repo, "commit", "-q", "-m", "first")
+    (repo / "src" / "device.c").write_text("int device;\n")
+    git(repo, "add", ".")
+    git(repo, "commit", "-q", "-m", "second")
+    return repo
+
+
+def list_files(path):
+    return sorted(
+        os.path.relpath(os.path.join(root, name), path)
+        for root, _, files in os.walk(path) for name in files if name != ".git"
+    )
+
+
+class TestMirrorCache:
+    def test_sparse_checkout_of_commits(self, tmp_path, remote):
+        """Test checkouts of the default branch and an older commit."""
+        cache = MirrorCache(str(tmp_path / "mirrors"))
+        first = git(remote, "rev-parse", "HEAD^")
+
+        with cache.checkout(str(remote)) as head, cache.checkout(str(remote), first) as old:
+            assert head.ref == "main"
+            assert head.parent_sha == first
+            assert list_files(head.path) == ["src/device.c", "src/sensor.c"]
+            assert list_files(old.path) == ["src/sensor.c"]
+            worktree = head.path
+
+        assert not os.path.exists(worktree)
+
+    def test_fetch_picks_up_new_commits(self, tmp_path, remote):
+        """Test that an existing mirror is updated with git fetch."""
+        cache = MirrorCache(str(tmp_path / "mirrors"))
+        with cache.checkout(str(remote)):
+            pass
+
+        (remote / "src" / "main.c").write_text("int main(void) { return 0; }\n")
+        git(remote, "add", ".")
+        git(remote, "commit", "-q", "-m", "third")
+
+        with cache.checkout(str(remote), "main") as checkout:
+            assert checkout.commit_sha == git(remote, "rev-parse", "HEAD")
+            assert "src/main.c" in list_files(checkout.path)
+
+    def test_unknown_ref(self, tmp_path, remote):
+        """Test that a missing ref raises GitError."""
+        cache = MirrorCache(str(tmp_path / "mirrors"))
+        with pytest.raises(GitError):
+            with cache.checkout(str(remote), "no-such-branch"):
+                pass
+
+    def test_eviction(self, tmp_path, remote):
+        """Test that unused mirrors are evicted past the size bound."""
+        cache = MirrorCache(str(tmp_path / "mirrors"), max_bytes=1)
+        with cache.checkout(str(remote)):
+            assert len(list((tmp_path / "mirrors").glob("*.git"))) == 1
+
+        assert list((tmp_path / "mirrors").glob("*.git")) == []
+
+    def test_resolve_remote_without_cloning(self, tmp_path, remote):
+        """Test that ls-remote resolves HEAD, branches and annotated tags."""
+        cache = MirrorCache(str(tmp_path / "mirrors"))
+        head = git(remote, "rev-parse", "HEAD")
+        git(remote, "tag", "-a", "v1", "-m", "release", "HEAD^")
+
+        assert cache.resolve_remote(str(remote)) == (head, "main")
+        assert cache.resolve_remote(str(remote), "main") == (head, "main")
+        assert cache.resolve_remote(str(remote), "v1") == (git(remote, "rev-parse", "HEAD^"), "v1")
+        assert cache.resolve_remote(str(remote), head) == (head, head)
+        with pytest.raises(GitError):
+            cache.resolve_remote(str(remote), "no-such-branch")
+        assert not (tmp_path / "mirrors").exists()
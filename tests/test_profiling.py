@@ -0,0 +1,55 @@
+"""Test analysis timing instrumentation."""
+
+from static_analyzer.profiling import AnalysisProfiler, AnalysisMetrics, format_profile
+
+
+def file_profile(seconds, parse_seconds, rules, nodes=100, cached=False):
+    return {"seconds": seconds, "parse_seconds": parse_seconds, "cached": cached,
+            "nodes_visited": nodes, "rules": rules}
+
+
+class TestAnalysisProfiler:
+    def test_merges_file_profiles(self):
+        """Test that per-file profiles add up per rule and phase."""
+        profiler = AnalysisProfiler()
+        profiler.add_file("a.c", file_profile(1.0, 0.6, {"R1": [0.3, 2], "R2": [0.1, 0]}))
+        profiler.add_file("b.c", file_profile(3.0, 2.0, {"R1": [0.5, 1]}))
+        profiler.add_file("c.c", {"seconds": 0.01, "cached": True})
+        with profiler.phase("deviations"):
+            pass
+
+        profile = profiler.to_dict()
+
+        assert profile["phases"]["parse"] == 2.6
+        assert profile["phases"]["rules"] == 0.9
+        assert "deviations" in profile["phases"]
+        assert profile["rules"]["R1"] == {"seconds": 0.8, "violations": 3}
+        assert profile["nodes_visited"] == 200
+        assert profile["cached_files"] == 1
+        assert [f["file"] for f in profile["slowest_files"]] == ["b.c", "a.c", "c.c"]
+
+    def test_format_lists_slowest_first(self):
+        """Test the --profile text output."""
+        profiler = AnalysisProfiler()
+        profiler.add_file("a.c", file_profile(1.0, 0.6, {"R1": [0.1, 2], "R2": [0.4, 0]}))
+        text = format_profile(profiler.to_dict(), top_n=1)
+
+        assert "R2" in text and "R1" not in text
+        assert "a.c" in text
+
+
+class TestAnalysisMetrics:
+    def test_prometheus_rendering(self):
+        """Test counters accumulate across reports and render with labels."""
+        profiler = AnalysisProfiler()
+        profiler.add_file("a.c", file_profile(1.0, 0.5, {"CERT-EXP34-C": [0.25, 2]}))
+        metrics = AnalysisMetrics()
+        metrics.record(profiler.to_dict())
+        metrics.record(profiler.to_dict())
+
+        text = metrics.render()
+
+        assert "static_analyzer_analyses_total 2" in text
+        assert 'static_analyzer_rule_violations_total{rule="CERT-EXP34-C"} 4' in text
+        assert 'static_analyzer_phase_seconds_total{phase="parse"} 1.0' in text
+        assert "# TYPE static_analyzer_files_total counter" in text
@@ -0,0 +1,212 @@
+"""Test whole-program summaries and the link step."""
+
+import json
+
+from clang.cindex import CursorKind, LinkageKind
+
+from static_analyzer.models import RuleMetadata, Severity, Standard
+from static_analyzer.program import (
+    ProgramSummary,
+    ProgramSymbol,
+    TranslationUnitSummary,
+    load_summaries,
+    save_summary
+)
+from static_analyzer.rules import Rule, RuleEngine, RuleRegistry
+from static_analyzer.rules.misra import MISRA_C_2012_8_7
+
+from conftest import FakeCursor, FakeTranslationUnit
+
+
+class FakeFunction:
+    def __init__(self, name, usr=None):
+        self.spelling = name
+        self._usr = usr if usr is not None else f"c:@F@{name}"
+
+    def get_usr(self):
+        return self._usr
+
+
+class FakeLocation:
+    def __init__(self, file_path, line):
+        self.file = type("File", (), {"name": file_path})() if file_path else None
+        self.line = line
+        self.column = 5
+
+
+class FakeVarCursor:
+    """A file-scope variable as ProgramSymbol.from_cursor reads it."""
+
+    def __init__(self, name, file_path, line, linkage=LinkageKind.EXTERNAL):
+        self.kind = CursorKind.VAR_DECL
+        self.spelling = name
+        self.linkage = linkage
+        self.location = FakeLocation(file_path, line)
+        self.extent = type("Extent", (), {"start": FakeLocation(None, line)})()
+        self._usr = f"c:{file_path}@{name}" if linkage == LinkageKind.INTERNAL else f"c:@{name}"
+
+    def get_usr(self):
+        return self._usr
+
+    def is_definition(self):
+        return True
+
+
+def make_symbol(name, file_path, is_definition=True, internal_linkage=False, line=1):
+    return ProgramSymbol(
+        usr=f"c:@{name}",
+        name=name,
+        kind=CursorKind.VAR_DECL.name,
+        file_path=file_path,
+        line=line,
+        column=5,
+        is_definition=is_definition,
+        internal_linkage=internal_linkage,
+        source_context=f"int {name}"
+    )
+
+
+def make_summary(file_path, symbols, references):
+    summary = TranslationUnitSummary(file_path)
+    for symbol in symbols:
+        summary.symbols[symbol.usr] = symbol
+    for usr, functions in references.items():
+        for function in functions:
+            summary.add_reference(usr, function)
+    return summary
+
+
+class SummarizingRule(Rule):
+    cursor_kinds = (CursorKind.VAR_DECL,)
+    whole_program = True
+
+    def get_metadata(self):
+        return RuleMetadata(
+            id="TEST-PROGRAM",
+            standard=Standard.MISRA,
+            title="Test",
+            description="Test",
+            rationale="Test",
+            severity=Severity.MINOR,
+            category="Test",
+            references=[]
+        )
+
+    def begin_translation_unit(self, translation_unit):
+        self.seen = 0
+
+    def check_cursor(self, cursor):
+        self.seen += 1
+        return []
+
+    def end_translation_unit(self, translation_unit):
+        return [self.create_violation_at(make_symbol("x", "a.c").location, "per unit")]
+
+    def summarize_translation_unit(self, translation_unit, summary):
+        summary.functions["seen"] = str(self.seen)
+
+    def check_program(self, program):
+        return [self.create_violation_at(make_symbol("x", "a.c").location, "linked")]
+
+
+class TestTranslationUnitSummary:
+    def test_round_trip(self, tmp_path):
+        """Test that a saved summary loads back unchanged."""
+        summary = make_summary("a.c", [make_symbol("counter", "a.c")],
+                               {"c:@counter": [FakeFunction("tick")]})
+        summary.includes = ["b.h", "a.h"]
+
+        loaded = TranslationUnitSummary.load_file(save_summary(summary, str(tmp_path)))
+        assert loaded.to_dict() == summary.to_dict()
+        assert loaded.includes == ["a.h", "b.h"]
+        assert loaded.references == {"c:@counter": {"c:@F@tick"}}
+
+    def test_load_summaries_skips_unreadable_files(self, tmp_path, capsys):
+        """Test that one bad summary does not hide the rest of a directory."""
+        save_summary(make_summary("a.c", [], {}), str(tmp_path))
+        (tmp_path / "bad.summary.json").write_text(json.dumps({"version": 99}))
+
+        summaries = load_summaries([str(tmp_path)])
+        assert [summary.file_path for summary in summaries] == ["a.c"]
+        assert "Warning: Could not load summary" in capsys.readouterr().out
+
+
+class TestProgramLink:
+    def test_definition_preferred_and_references_merged(self):
+        """Test that linking keeps the definition and unions references across units."""
+        a = make_summary("a.c", [make_symbol("shared", "a.c")],
+                         {"c:@shared": [FakeFunction("reader")]})
+        b = make_summary("b.c", [make_symbol("shared", "shared.h", is_definition=False)],
+                         {"c:@shared": [FakeFunction("writer")]})
+
+        program = ProgramSummary.link([b, a])
+        assert program.translation_units == ["a.c", "b.c"]
+        assert program.symbols["c:@shared"].file_path == "a.c"
+        assert program.get_referencing_functions("c:@shared") == [
+            ("c:@F@reader", "reader"), ("c:@F@writer", "writer")
+        ]
+
+    def test_misra_8_7_decided_over_all_units(self):
+        """Test that 8.7 only reports objects used by one function in the whole program."""
+        only_main = make_symbol("only_main", "a.c", line=1)
+        shared = make_symbol("shared", "a.c", line=2)
+        private = make_symbol("private_count", "a.c", internal_linkage=True, line=3)
+        external = make_symbol("external", "a.c", is_definition=False, line=4)
+        a = make_summary("a.c", [only_main, shared, private, external], {
+            "c:@only_main": [FakeFunction("main")],
+            "c:@shared": [FakeFunction("main")],
+            "c:@private_count": [FakeFunction("main")],
+            "c:@external": [FakeFunction("main")]
+        })
+        b = make_summary("b.c", [make_symbol("shared", "a.h", is_definition=False)], {
+            "c:@shared": [FakeFunction("helper", "c:b.c@F@helper")]
+        })
+
+        violations = MISRA_C_2012_8_7().check_program(ProgramSummary.link([a, b]))
+        assert [v.metadata["variable_name"] for v in violations] == ["only_main"]
+        assert violations[0].location.file_path == "a.c"
+        assert violations[0].metadata["used_in_function"] == "main"
+        assert violations[0].source_context == "int only_main"
+
+    def test_misra_8_7_skips_static_globals_after_link(self):
+        """Test that a TU-local static global recorded from its cursor is not reported."""
+        summary = TranslationUnitSummary("a.c")
+        for cursor in (FakeVarCursor("private_count", "a.c", 1, LinkageKind.INTERNAL),
+                       FakeVarCursor("only_main", "a.c", 2)):
+            summary.add_symbol(cursor)
+            summary.add_reference(cursor.get_usr(), FakeFunction("main"))
+
+        assert summary.symbols["c:a.c@private_count"].internal_linkage
+        violations = MISRA_C_2012_8_7().check_program(ProgramSummary.link([summary]))
+        assert [v.metadata["variable_name"] for v in violations] == ["only_main"]
+
+    def test_static_functions_with_same_name_are_distinct(self):
+        """Test that references are counted per function USR, not per name."""
+        a = make_summary("a.c", [make_symbol("state", "a.c")],
+                         {"c:@state": [FakeFunction("init", "c:a.c@F@init")]})
+        b = make_summary("b.c", [], {"c:@state": [FakeFunction("init", "c:b.c@F@init")]})
+
+        assert MISRA_C_2012_8_7().check_program(ProgramSummary.link([a, b])) == []
+
+
+class TestEngineSummaryMode:
+    def make_engine(self):
+        registry = RuleRegistry()
+        registry.register_rule(SummarizingRule)
+        return RuleEngine(registry)
+
+    def test_whole_program_rule_summarizes_instead_of_reporting(self):
+        """Test that a summary replaces end_translation_unit for whole-program rules."""
+        unit = FakeTranslationUnit(FakeCursor(CursorKind.TRANSLATION_UNIT, children=[
+            FakeCursor(CursorKind.VAR_DECL), FakeCursor(CursorKind.VAR_DECL)
+        ]))
+        engine = self.make_engine()
+
+        assert [v.message for v in engine.analyze_translation_unit(unit)] == ["per unit"]
+
+        summary = TranslationUnitSummary("a.c")
+        assert engine.analyze_translation_unit(unit, summary=summary) == []
+        assert summary.functions["seen"] == "2"
+
+        violations = engine.check_program(ProgramSummary.link([summary]))
+        assert [v.message for v in violations] == ["linked"]
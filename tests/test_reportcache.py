@@ -0,0 +1,110 @@
+"""Test the web report cache."""
+
+import threading
+import time
+
+import pytest
+
+from static_analyzer.reportcache import CachedReport, ReportCache, config_fingerprint, report_key
+
+
+SHA = "0123456789abcdef0123456789abcdef01234567"
+
+
+class TestReportKey:
+    def test_url_spelling_and_config_change_key(self):
+        fingerprint = config_fingerprint({"analysis": {"parallelism": 0}}, 60.0)
+        key = report_key("https://github.com/Owner/Repo", SHA, fingerprint)
+
+        assert report_key("https://github.com/owner/repo.git", SHA, fingerprint) == key
+        assert report_key("https://github.com/owner/repo/", SHA, fingerprint) == key
+        assert report_key("https://github.com/owner/repo", "f" * 40, fingerprint) != key
+        assert report_key("https://github.com/owner/repo", SHA,
+                          config_fingerprint({"analysis": {"parallelism": 0}}, 30.0)) != key
+
+
+class TestCachedReport:
+    def test_etag_follows_content(self):
+        entry = CachedReport({"b": 1, "a": [1, 2]})
+
+        assert CachedReport({"a": [1, 2], "b": 1}).etag == entry.etag
+        assert CachedReport({"a": [1], "b": 1}).etag != entry.etag
+        assert entry.matches(entry.etag)
+        assert entry.matches(f'"other", W/{entry.etag}')
+        assert not entry.matches('"other"')
+        assert not entry.matches(None)
+
+
+class TestReportCache:
+    def test_concurrent_requests_share_one_analysis(self):
+        """Test that requests arriving during an analysis wait for it."""
+        cache = ReportCache()
+        release = threading.Event()
+        calls = []
+
+        def compute():
+            calls.append(1)
+            release.wait(5)
+            return {"violations": []}
+
+        results = []
+        threads = [threading.Thread(target=lambda: results.append(cache.get_or_compute("k", compute)))
+                   for _ in range(4)]
+        for thread in threads:
+            thread.start()
+        deadline = time.monotonic() + 5
+        while cache.get_stats()["shared"] < 3 and time.monotonic() < deadline:
+            time.sleep(0.01)
+        release.set()
+        for thread in threads:
+            thread.join()
+
+        assert len(calls) == 1
+        assert sorted(status for _, status in results) == ["miss", "shared", "shared", "shared"]
+        assert len({entry.etag for entry, _ in results}) == 1
+        assert cache.get_or_compute("k", compute)[1] == "hit"
+
+    def test_failures_reach_waiters_and_are_not_cached(self):
+        cache = ReportCache()
+        leader = cache.begin("k")
+        waiter = cache.begin("k")
+        leader.abandon(RuntimeError("clone failed"))
+
+        with pytest.raises(RuntimeError):
+            waiter.wait(1)
+        assert cache.lookup("k") is None
+        assert cache.begin("k").leader
+
+    def test_waiter_takes_over_an_abandoned_analysis(self):
+        cache = ReportCache()
+        first = cache.begin("k")
+        waiter = cache.begin("k")
+        first.abandon()
+
+        assert waiter.wait(1) is None
+        second = cache.begin("k")
+        assert second.leader
+        second.complete({"n": 1})
+        assert cache.lookup("k").report == {"n": 1}
+
+    def test_ttl(self):
+        """Test that failed reports are handed out but not kept, and expired ones drop out."""
+        cache = ReportCache()
+        entry, _ = cache.get_or_compute("failed", lambda: {"success": False}, lambda report: 0)
+        assert entry.report == {"success": False}
+        assert cache.lookup("failed") is None
+
+        cache.begin("partial").complete({"partial": True}, ttl=-1)
+        assert cache.lookup("partial") is None
+
+    def test_lru_and_disk(self, tmp_path):
+        """Test that evicted reports are read back from the cache directory."""
+        cache = ReportCache(max_entries=1, cache_dir=str(tmp_path))
+        first = cache.begin("a").complete({"n": 1})
+        cache.begin("b").complete({"n": 2})
+        cache.begin("partial").complete({"n": 3}, ttl=60)
+
+        assert len(cache._entries) == 1
+        assert cache.lookup("a").etag == first.etag
+        assert ReportCache(cache_dir=str(tmp_path)).lookup("b").report == {"n": 2}
+        assert ReportCache(cache_dir=str(tmp_path)).lookup("partial") is None
@@ -0,0 +1,65 @@
+"""Test streaming report writers."""
+
+import io
+import json
+
+from static_analyzer.reports import NDJSONReportWriter, SARIFReportWriter
+from static_analyzer.models import AnalysisReport, Severity
+
+from conftest import make_violation
+
+
+VIOLATIONS = [
+    make_violation("CERT-EXP34-C", line=4),
+    make_violation("MISRA-C-2012-10.1", line=9, severity=Severity.MINOR),
+    make_violation("CERT-EXP34-C", line=12),
+]
+
+
+class TestReportWriters:
+    def test_ndjson_records(self):
+        """Test one line per violation followed by the summary."""
+        stream = io.StringIO()
+        writer = NDJSONReportWriter(stream)
+        writer.write_violations(VIOLATIONS[:2])
+        writer.write_violations(VIOLATIONS[2:])
+        summary = writer.close({"analyzer_version": "1.0.0"})
+
+        records = [json.loads(line) for line in stream.getvalue().splitlines()]
+        assert [r["type"] for r in records] == ["violation"] * 3 + ["summary"]
+        assert records[0]["rule_id"] == "CERT-EXP34-C"
+        assert records[0]["severity"] == "major"
+        assert records[-1]["summary"] == summary
+        assert summary["by_rule"] == {"CERT-EXP34-C": 2, "MISRA-C-2012-10.1": 1}
+
+    def test_sarif_is_valid_json(self):
+        """Test that a streamed SARIF log parses and lists fired rules."""
+        stream = io.StringIO()
+        writer = SARIFReportWriter(stream)
+        writer.write_violations(VIOLATIONS)
+        writer.close()
+
+        log = json.loads(stream.getvalue())
+        run = log["runs"][0]
+        assert log["version"] == "2.1.0"
+        assert [r["ruleId"] for r in run["results"]] == [v.rule_id for v in VIOLATIONS]
+        assert run["results"][1]["level"] == "warning"
+        assert [r["id"] for r in run["tool"]["driver"]["rules"]] == [
+            "CERT-EXP34-C", "MISRA-C-2012-10.1"
+        ]
+
+    def test_empty_sarif(self):
+        """Test a SARIF log with no results."""
+        stream = io.StringIO()
+        SARIFReportWriter(stream).close()
+
+        assert json.loads(stream.getvalue())["runs"][0]["results"] == []
+
+    def test_summary_matches_report(self):
+        """Test that incremental counters match the in-memory summary."""
+        writer = NDJSONReportWriter(io.StringIO())
+        writer.write_violations(VIOLATIONS)
+
+        report = AnalysisReport(list(VIOLATIONS), {}, {})
+        report.generate_summary()
+        assert writer.close() == report.summary
@@ -0,0 +1,375 @@
+"""Test rule engine dispatch."""
+
+from types import SimpleNamespace
+
+import pytest
+from clang.cindex import CursorKind
+
+import static_analyzer.rules as rules_module
+from static_analyzer.ast import ASTTraverser
+from static_analyzer.native import NativeWalk
+from static_analyzer.rules import LexicalPrefilter, Rule, RuleEngine, RulePack, RuleRegistry
+from static_analyzer.models import RuleMetadata, Standard, Severity
+
+from conftest import FakeCursor, FakeTranslationUnit, make_violation
+
+
+def make_metadata(rule_id):
+    return RuleMetadata(
+        id=rule_id,
+        standard=Standard.MISRA,
+        title="Test rule",
+        description="Test description",
+        rationale="Test rationale",
+        severity=Severity.MINOR,
+        category="Test",
+        references=[]
+    )
+
+
+class SwitchRule(Rule):
+    cursor_kinds = (CursorKind.SWITCH_STMT,)
+
+    def get_metadata(self):
+        return make_metadata("TEST-SWITCH")
+
+    def check_cursor(self, cursor):
+        return [make_violation("TEST-SWITCH", "test.c", cursor.line)]
+
+
+class LexicalSwitchRule(SwitchRule):
+    lexical_prerequisite = r"\bswitch\b"
+
+
+class NativeSwitchRule(SwitchRule):
+    native_check = "switch_without_default"
+
+    def check_cursor(self, cursor):
+        raise AssertionError("evaluated natively")
+
+    def report_native_match(self, cursor):
+        return [make_violation("TEST-SWITCH", "test.c", cursor.line)]
+
+
+class FakeNativeWalker:
+    """Stands in for the compiled walker by filtering a Python walk."""
+
+    checks = frozenset(["switch_without_default"])
+
+    def walk(self, translation_unit, kinds, function_kinds, checks, roots=None):
+        nodes = list(ASTTraverser.walk_with_enclosing_function(translation_unit.cursor))
+        kinds = set(kinds)
+        switches = [cursor for cursor, _ in nodes if cursor.kind == CursorKind.SWITCH_STMT]
+        return NativeWalk([(cursor, function) for cursor, function in nodes
+                           if cursor.kind.value in kinds],
+                          {check: switches for check in checks}, len(nodes))
+
+
+class CountingRule(Rule):
+    cursor_kinds = (CursorKind.VAR_DECL, CursorKind.SWITCH_STMT)
+
+    def get_metadata(self):
+        return make_metadata("TEST-COUNT")
+
+    def begin_translation_unit(self, translation_unit):
+        self.seen = []
+
+    def check_cursor(self, cursor):
+        self.seen.append(cursor.kind)
+        return []
+
+    def end_translation_unit(self, translation_unit):
+        cursor = translation_unit.cursor
+        return [make_violation("TEST-COUNT", "test.c", cursor.line)] if self.seen else []
+
+
+class FailingRule(Rule):
+    cursor_kinds = (CursorKind.VAR_DECL,)
+
+    def get_metadata(self):
+        return make_metadata("TEST-FAIL")
+
+    def check_cursor(self, cursor):
+        raise RuntimeError("boom")
+
+
+class LegacyRule(Rule):
+    def get_metadata(self):
+        return make_metadata("TEST-LEGACY")
+
+    def check_translation_unit(self, translation_unit):
+        return [make_violation("TEST-LEGACY", "test.c", translation_unit.cursor.line)]
+
+
+class InstanceCountingRule(SwitchRule):
+    instances = 0
+
+    def __init__(self):
+        super().__init__()
+        InstanceCountingRule.instances += 1
+
+
+TEST_PACK = RulePack("test-pack", "MISRA", {
+    "TEST-SWITCH": f"{__name__}:InstanceCountingRule",
+    "TEST-LEGACY": f"{__name__}:LegacyRule"
+})
+
+
+class FakeEntryPoint:
+    def __init__(self, name, value):
+        self.name = name
+        self.value = value
+
+    def load(self):
+        return self.value
+
+
+@pytest.fixture
+def translation_unit():
+    root = FakeCursor(CursorKind.TRANSLATION_UNIT, children=[
+        FakeCursor(CursorKind.VAR_DECL, "g", line=1),
+        FakeCursor(CursorKind.FUNCTION_DECL, "f", line=2, children=[
+            FakeCursor(CursorKind.SWITCH_STMT, line=3),
+            FakeCursor(CursorKind.SWITCH_STMT, line=7),
+        ]),
+    ])
+    return FakeTranslationUnit(root)
+
+
+def make_engine(*rule_classes):
+    registry = RuleRegistry()
+    for rule_class in rule_classes:
+        registry.register_rule(rule_class)
+    return RuleEngine(registry)
+
+
+class TestRuleEngine:
+    def test_visitor_rule_receives_declared_kinds_only(self, translation_unit):
+        """Test that visitor rules only see the kinds they declare."""
+        engine = make_engine(CountingRule)
+        engine.analyze_translation_unit(translation_unit)
+
+        rule = engine.registry.get_rule("TEST-COUNT")
+        assert rule.seen == [
+            CursorKind.VAR_DECL,
+            CursorKind.SWITCH_STMT,
+            CursorKind.SWITCH_STMT
+        ]
+
+    def test_results_grouped_in_rule_order(self, translation_unit):
+        """Test that output order follows rule order, not walk order."""
+        engine = make_engine(LegacyRule, SwitchRule, CountingRule)
+        violations = engine.analyze_translation_unit(translation_unit)
+
+        assert [v.rule_id for v in violations] == [
+            "TEST-LEGACY",
+            "TEST-SWITCH",
+            "TEST-SWITCH",
+            "TEST-COUNT"
+        ]
+        assert [v.location.line for v in violations[1:3]] == [3, 7]
+
+    def test_failing_rule_is_isolated(self, translation_unit):
+        """Test that a failing visitor rule does not affect the others."""
+        engine = make_engine(FailingRule, SwitchRule)
+        violations = engine.analyze_translation_unit(translation_unit)
+
+        assert [v.rule_id for v in violations] == ["TEST-SWITCH", "TEST-SWITCH"]
+
+    def test_visitor_rule_standalone(self, translation_unit):
+        """Test that a visitor rule can still run without the engine."""
+        rule = SwitchRule()
+        violations = rule.check_translation_unit(translation_unit)
+
+        assert len(violations) == 2
+
+    def test_enabled_rules_filter(self, translation_unit):
+        """Test that only enabled rules are dispatched."""
+        engine = make_engine(SwitchRule, LegacyRule)
+        violations = engine.analyze_translation_unit(
+            translation_unit, ["TEST-LEGACY"]
+        )
+
+        assert [v.rule_id for v in violations] == ["TEST-LEGACY"]
+
+
+    def test_native_walk_matches_python_walk(self, translation_unit, monkeypatch):
+        """Test that the native backend hands rules the same nodes and native checks report."""
+        monkeypatch.setattr(rules_module, "get_native_walker", lambda: FakeNativeWalker())
+        engine = make_engine(NativeSwitchRule, CountingRule)
+        engine.use_native = True
+        profile = {}
+        violations = engine.analyze_translation_unit(translation_unit, profile=profile)
+
+        assert [(v.rule_id, v.location.line) for v in violations] == [
+            ("TEST-SWITCH", 3), ("TEST-SWITCH", 7), ("TEST-COUNT", 1)
+        ]
+        assert engine.registry.get_rule("TEST-COUNT").seen == [
+            CursorKind.VAR_DECL, CursorKind.SWITCH_STMT, CursorKind.SWITCH_STMT
+        ]
+        assert profile["nodes_visited"] == 5
+
+
+class TestRulePacks:
+    def test_pack_rules_load_when_enabled(self, translation_unit):
+        """Test that registering a pack imports and instantiates nothing."""
+        InstanceCountingRule.instances = 0
+        registry = RuleRegistry()
+        registry.register_pack(TEST_PACK)
+
+        assert registry.list_rule_ids() == ["TEST-SWITCH", "TEST-LEGACY"]
+        assert registry.get_rule_standard("TEST-SWITCH") == "MISRA"
+        assert InstanceCountingRule.instances == 0
+
+        violations = RuleEngine(registry).analyze_translation_unit(translation_unit, ["TEST-SWITCH"])
+        assert len(violations) == 2
+        assert InstanceCountingRule.instances == 1
+        assert not registry.is_loaded("TEST-LEGACY")
+
+    def test_builtin_packs_cover_every_builtin_rule(self):
+        engine = RuleEngine()
+        engine.register_builtin_rules(discover=False)
+
+        assert engine.registry.list_rule_ids() == [
+            "MISRA-C-2012-8.7", "MISRA-C-2012-10.1", "MISRA-C-2012-16.4",
+            "CERT-EXP34-C", "CERT-ARR30-C"
+        ]
+        assert not any(engine.registry.is_loaded(rule_id) for rule_id in engine.registry.list_rule_ids())
+        assert [rule.metadata.id for rule in engine.registry.get_rules_by_standard("CERT")] == [
+            "CERT-EXP34-C", "CERT-ARR30-C"
+        ]
+        assert not engine.registry.is_loaded("MISRA-C-2012-8.7")
+
+    def test_expand_pack_names_and_standards(self):
+        registry = RuleRegistry()
+        registry.register_pack(TEST_PACK)
+
+        assert registry.expand_rule_ids(["test-pack"]) == ["TEST-SWITCH", "TEST-LEGACY"]
+        assert registry.expand_rule_ids(["TEST-LEGACY", "MISRA", "UNKNOWN"]) == [
+            "TEST-LEGACY", "TEST-SWITCH", "UNKNOWN"
+        ]
+
+    def test_entry_point_discovery(self, monkeypatch):
+        """Test that installed packs are found and broken entry points skipped."""
+        import importlib.metadata
+
+        def entry_points(group):
+            assert group == rules_module.RULE_PACK_ENTRY_POINT_GROUP
+            return [FakeEntryPoint("test", TEST_PACK), FakeEntryPoint("broken", object())]
+
+        monkeypatch.setattr(importlib.metadata, "entry_points", entry_points)
+        engine = RuleEngine()
+        engine.register_builtin_rules()
+
+        assert "TEST-SWITCH" in engine.registry.list_rule_ids()
+        assert "CERT-ARR30-C" in engine.registry.list_rule_ids()
+
+    def test_dispatch_table_built_once_per_rule_set(self, translation_unit):
+        engine = make_engine(SwitchRule, CountingRule)
+        rules = engine.registry.get_all_rules()
+        table = engine._get_dispatch_table(rules)
+
+        engine.analyze_translation_unit(translation_unit)
+        assert engine._get_dispatch_table(list(rules)) is table
+        assert engine._get_dispatch_table(rules[:1]) is not table
+        assert table[CursorKind.SWITCH_STMT] == rules
+
+
+class TestLexicalPrefilter:
+    def test_rule_skipped_without_prerequisite(self, tmp_path):
+        """Test that comments don't count and rules without a prerequisite always run."""
+        source = tmp_path / "main.c"
+        source.write_text("/* switch */\nint f(void) { return 0; }\n")
+        rules = [LexicalSwitchRule(), CountingRule()]
+
+        runnable, skipped, scanned = LexicalPrefilter().select(str(source), rules)
+        assert [type(rule) for rule in runnable] == [CountingRule]
+        assert [type(rule) for rule in skipped] == [LexicalSwitchRule]
+        assert scanned == [str(source)]
+
+    def test_included_header_is_scanned(self, tmp_path):
+        """Test that a prerequisite in a header found on the include path counts."""
+        include_dir = tmp_path / "include"
+        include_dir.mkdir()
+        (include_dir / "dispatch.h").write_text(
+            "static int g(int x) { switch (x) { case 1: return 1; } return 0; }\n"
+        )
+        source = tmp_path / "main.c"
+        source.write_text('#include "dispatch.h"\n#include <stdio.h>\n')
+        prefilter = LexicalPrefilter()
+
+        runnable, skipped, _ = prefilter.select(str(source), [LexicalSwitchRule()])
+        assert runnable == [] and len(skipped) == 1
+
+        runnable, skipped, _ = prefilter.select(str(source), [LexicalSwitchRule()],
+                                                ["-I", str(include_dir)])
+        assert len(runnable) == 1 and skipped == []
+        assert prefilter.files_scanned == 2
+
+    def test_builtin_prerequisites(self):
+        """Test that only rules a typical file can lack a token for declare a prerequisite."""
+        engine = RuleEngine()
+        engine.register_builtin_rules(discover=False)
+        prerequisites = {rule_id: engine.registry.get_rule(rule_id).lexical_prerequisite
+                         for rule_id in engine.registry.list_rule_ids()}
+
+        assert prerequisites["MISRA-C-2012-16.4"] == r"\bswitch\b"
+        assert prerequisites["CERT-EXP34-C"] is None
+        assert prerequisites["CERT-ARR30-C"] is None
+
+
+class TestNullFactsCache:
+    @staticmethod
+    def make_function(name, hash_value, offset, children):
+        function = FakeCursor(CursorKind.FUNCTION_DECL, name, children=children)
+        function.hash = hash_value
+        function.semantic_parent = None
+        function.get_usr = lambda: f"c:@F@{name}"
+        function.extent = SimpleNamespace(start=SimpleNamespace(offset=offset))
+        return function
+
+    @staticmethod
+    def make_use(function, name):
+        cursor = FakeCursor(CursorKind.DECL_REF_EXPR, name)
+        cursor.semantic_parent = function
+        return cursor
+
+    def test_function_facts_computed_once(self, monkeypatch):
+        """Test that CERT-EXP34-C walks each function body only once."""
+        from static_analyzer.rules.cert import CERT_EXP34_C
+
+        function = self.make_function("f", 1, 0, [
+            FakeCursor(CursorKind.IF_STMT, children=[
+                FakeCursor(CursorKind.DECL_REF_EXPR, "ptr")
+            ]),
+        ])
+        uses = [self.make_use(function, name) for name in ("ptr", "other", "ptr", "other")]
+
+        walked = []
+        walk_ast = ASTTraverser.walk_ast
+        monkeypatch.setattr(ASTTraverser, "walk_ast",
+                            staticmethod(lambda root: walked.append(root) or walk_ast(root)))
+
+        rule = CERT_EXP34_C()
+        rule.begin_translation_unit(FakeTranslationUnit(function))
+        for use in uses:
+            rule._has_null_check_before_use(use, use.spelling)
+            rule._has_null_assignment(use, use.spelling)
+
+        assert walked.count(function) == 1
+        assert rule._has_null_check_before_use(uses[0], "ptr")
+        assert not rule._has_null_check_before_use(uses[1], "other")
+
+    def test_colliding_hashes_keep_separate_facts(self):
+        from static_analyzer.rules.cert import CERT_EXP34_C
+
+        checks_ptr = self.make_function("f", 7, 0, [
+            FakeCursor(CursorKind.IF_STMT, children=[FakeCursor(CursorKind.DECL_REF_EXPR, "ptr")])
+        ])
+        checks_nothing = self.make_function("g", 7, 120, [])
+
+        rule = CERT_EXP34_C()
+        rule.begin_translation_unit(FakeTranslationUnit(checks_ptr))
+        assert rule._has_null_check_before_use(self.make_use(checks_ptr, "ptr"), "ptr")
+        assert not rule._has_null_check_before_use(self.make_use(checks_nothing, "ptr"), "ptr")
+        assert len(rule._function_facts) == 2
@@ -0,0 +1,157 @@
+"""Test shard assignment and shard report merging helpers."""
+
+import json
+
+import pytest
+
+from static_analyzer import AnalyzerConfig, StaticAnalyzer
+from static_analyzer.models import AnalysisReport
+from static_analyzer.shard import (
+    ShardSpec,
+    assign_shards,
+    check_shard_coverage,
+    load_file_timings,
+    load_shard_reports,
+    merge_shard_metadata
+)
+
+from conftest import make_violation
+
+
+def write_shard_report(path, index, count, file_seconds, violations=()):
+    report = AnalysisReport(list(violations), {}, {
+        "analyzer_version": "1.0.0",
+        "files_analyzed": len(file_seconds),
+        "total_files_provided": 6,
+        "shard": {"index": index, "count": count, "file_seconds": file_seconds}
+    })
+    path.write_text(report.to_json())
+    return str(path)
+
+
+class TestShardAssignment:
+    def test_parse(self):
+        shard = ShardSpec.parse("2/4")
+        assert (shard.index, shard.count) == (2, 4)
+        for text in ("0/4", "5/4", "2", "a/b"):
+            with pytest.raises(ValueError):
+                ShardSpec.parse(text)
+
+    def test_every_file_in_exactly_one_shard(self):
+        """Test that shards partition the files whatever order they are listed in."""
+        files = [f"src/f{i}.c" for i in range(23)]
+        selected = [ShardSpec(index, 4).select(files) for index in range(1, 5)]
+
+        assert sorted(sum(selected, [])) == sorted(files)
+        assert all(5 <= len(shard_files) <= 6 for shard_files in selected)
+        assert ShardSpec(3, 4).select(list(reversed(files))) == list(reversed(selected[2]))
+
+    def test_balanced_by_prior_timings(self):
+        """Test that one slow file gets a shard to itself and unknown files count as the median."""
+        timings = {"slow.c": 10.0, "a.c": 1.0, "b.c": 1.0, "c.c": 1.0}
+        assignment = assign_shards(["a.c", "b.c", "c.c", "new.c", "slow.c"], 2, timings)
+
+        assert assignment["slow.c"] == 0
+        assert {assignment[name] for name in ("a.c", "b.c", "c.c", "new.c")} == {1}
+
+    def test_timings_from_report_or_mapping(self, tmp_path):
+        merged = tmp_path / "merged.json"
+        merged.write_text(json.dumps({"violations": [], "metadata": {"file_seconds": {"a.c": 2.0}}}))
+        plain = tmp_path / "timings.json"
+        plain.write_text(json.dumps({"b.c": 3.5}))
+
+        assert load_file_timings(str(merged)) == {"a.c": 2.0}
+        assert load_file_timings(str(plain)) == {"b.c": 3.5}
+        assert load_file_timings(str(tmp_path / "missing.json")) == {}
+
+
+class TestShardReports:
+    def test_coverage_problems_reported(self, tmp_path):
+        """Test that missing and duplicated shards are found."""
+        reports = load_shard_reports([
+            write_shard_report(tmp_path / "s3.json", 3, 3, {}),
+            write_shard_report(tmp_path / "s1.json", 1, 3, {}),
+            write_shard_report(tmp_path / "s1b.json", 1, 3, {})
+        ])
+
+        assert [report[1].metadata["shard"]["index"] for report in reports] == [1, 1, 3]
+        issues = check_shard_coverage(reports)
+        assert any("given twice" in issue for issue in issues)
+        assert "Missing shards: 2/3" in issues
+
+    def test_metadata_merged(self, tmp_path):
+        """Test that merged metadata sums files and keeps every shard's timings."""
+        reports = load_shard_reports([
+            write_shard_report(tmp_path / "s1.json", 1, 2, {"a.c": 1.5, "b.c": 0.5},
+                               [make_violation(file_path="common.h", line=3)]),
+            write_shard_report(tmp_path / "s2.json", 2, 2, {"c.c": 2.0},
+                               [make_violation(file_path="common.h", line=3)])
+        ])
+
+        assert check_shard_coverage(reports) == []
+        metadata = merge_shard_metadata(reports)
+        assert metadata["files_analyzed"] == 3
+        assert metadata["total_files_provided"] == 6
+        assert metadata["file_seconds"] == {"a.c": 1.5, "b.c": 0.5, "c.c": 2.0}
+        assert [shard["violations"] for shard in metadata["shards"]] == [1, 1]
+
+
+class TestShardDeviations:
+    def test_deviations_applied_once_after_merge(self, tmp_path):
+        """Test that shards keep deviated violations and the merge drops them once."""
+        deviations = tmp_path / "deviations.yaml"
+        deviations.write_text(
+            "deviations:\n"
+            "  - rule_id: \"CERT-EXP34-C\"\n"
+            "    file_pattern: \"legacy/\"\n"
+            "    justification: \"Reviewed\"\n"
+            "    approved_by: \"Safety Manager\"\n"
+            "    approval_date: \"2024-01-20\"\n"
+        )
+        analyzer = StaticAnalyzer(AnalyzerConfig.create_default(), str(deviations))
+        checked = []
+        apply_deviations = analyzer._apply_deviations
+        analyzer._apply_deviations = lambda violations: (checked.extend(violations)
+                                                         or apply_deviations(violations))
+
+        violations = [make_violation(file_path="legacy/io.c", line=3),
+                      make_violation(file_path="src/main.c", line=8)]
+        shard = analyzer.build_report([("legacy/io.c", violations, {})], ["CERT-EXP34-C"], 1,
+                                      shard=ShardSpec(1, 1))
+        assert len(shard.violations) == 2
+        assert shard.metadata["deviations_applied"] == 0
+        path = tmp_path / "s1.json"
+        path.write_text(shard.to_json())
+
+        merged = analyzer.merge_shard_reports([str(path)])
+        assert [v.location.file_path for v in merged.violations] == ["src/main.c"]
+        assert len(checked) == 2
+
+    def test_rule_cap_applies_after_deviations(self, tmp_path):
+        """Test that a deviated violation among a shard's first N does not cost a kept one."""
+        deviations = tmp_path / "deviations.yaml"
+        deviations.write_text(
+            "deviations:\n"
+            "  - rule_id: \"CERT-EXP34-C\"\n"
+            "    file_pattern: \"legacy/\"\n"
+            "    justification: \"Reviewed\"\n"
+            "    approved_by: \"Safety Manager\"\n"
+            "    approval_date: \"2024-01-20\"\n"
+        )
+        config = AnalyzerConfig.create_default()
+        config.config["analysis"]["max_violations_per_rule"] = 2
+        analyzer = StaticAnalyzer(config, str(deviations))
+
+        violations = [make_violation(file_path="legacy/io.c", line=3),
+                      make_violation(file_path="src/main.c", line=8),
+                      make_violation(file_path="src/main.c", line=9)]
+        shard = analyzer.build_report([("legacy/io.c", violations, {})], ["CERT-EXP34-C"], 1,
+                                      shard=ShardSpec(1, 1))
+        assert len(shard.violations) == 3
+        assert "dropped_violations" not in shard.metadata
+        path = tmp_path / "s1.json"
+        path.write_text(shard.to_json())
+
+        merged = analyzer.merge_shard_reports([str(path)])
+        assert [v.location.line for v in merged.violations] == [8, 9]
+        assert "dropped_violations" not in merged.metadata
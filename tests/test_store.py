@@ -0,0 +1,108 @@
+"""Test the columnar violation store."""
+
+import io
+import json
+
+from static_analyzer.models import AnalysisReport, ReportSummary, Severity
+from static_analyzer.reports import NDJSONReportWriter, StoreReportWriter
+from static_analyzer.store import ViolationStore
+
+from conftest import make_violation
+
+
+VIOLATIONS = [
+    make_violation("CERT-EXP34-C", "src/main.c", 4, source_context="*p = 0;"),
+    make_violation("MISRA-C-2012-10.1", "src/main.c", 9, severity=Severity.MINOR,
+                   metadata={"operator": "+"}),
+    make_violation("CERT-EXP34-C", "src/io.c", 12, ai_explanation="p may be NULL"),
+]
+
+
+class TestViolationStore:
+    def test_rows_round_trip(self):
+        """Test that stored rows materialize back to equal violations."""
+        store = ViolationStore.from_violations(VIOLATIONS)
+
+        assert len(store) == 3
+        assert list(store) == VIOLATIONS
+        # Repeated paths and rule IDs are stored once
+        assert store.strings.count("src/main.c") == 1
+        assert store.strings.count("CERT-EXP34-C") == 1
+
+    def test_save_and_load(self, tmp_path):
+        """Test the binary format, including metadata and sparse fields."""
+        store = ViolationStore.from_violations(VIOLATIONS)
+        store.metadata = {"analyzer_version": "1.0.0"}
+        path = str(tmp_path / "report.vstore")
+        store.save(path)
+
+        loaded = ViolationStore.load(path)
+        assert list(loaded) == VIOLATIONS
+        assert loaded.metadata == {"analyzer_version": "1.0.0"}
+
+    def test_load_reports(self, tmp_path):
+        """Test loading JSON and NDJSON reports without the store format."""
+        json_path = tmp_path / "report.json"
+        report = AnalysisReport(list(VIOLATIONS), {}, {"files_analyzed": 2})
+        json_path.write_text(json.dumps(report.to_dict(encode_json=True)))
+
+        ndjson_path = tmp_path / "report.ndjson"
+        with open(ndjson_path, "w", encoding="utf-8") as f:
+            writer = NDJSONReportWriter(f)
+            writer.write_violations(VIOLATIONS)
+            writer.close({"files_analyzed": 2})
+
+        for path in (json_path, ndjson_path):
+            loaded = ViolationStore.load(str(path))
+            assert list(loaded) == VIOLATIONS
+            assert loaded.metadata == {"files_analyzed": 2}
+
+    def test_read_store_without_newer_columns(self):
+        """Test that columns missing from an older store are filled, signed or not."""
+        store = ViolationStore.from_violations(VIOLATIONS)
+        del store.columns["column"]
+        del store.columns["end_line"]
+        stream = io.BytesIO()
+        store.write(stream)
+
+        stream.seek(0)
+        loaded = ViolationStore.read(stream)
+        assert list(loaded.columns["column"]) == [0, 0, 0]
+        assert loaded.violation(0).location.end_line is None
+        assert loaded.violation(0).rule_id == "CERT-EXP34-C"
+
+    def test_summary_matches_report_summary(self):
+        summary = ReportSummary()
+        summary.add_violations(VIOLATIONS)
+        assert ViolationStore.from_violations(VIOLATIONS).summary() == summary.to_dict()
+
+    def test_summary_counts_files_without_violations(self):
+        """Test that the run's file count survives a save, not just files with violations."""
+        stream = io.BytesIO()
+        writer = StoreReportWriter(stream)
+        writer.write_violations(VIOLATIONS)
+        writer.close({"files_analyzed": 7})
+
+        stream.seek(0)
+        assert ViolationStore.read(stream).summary()["files_analyzed"] == 7
+
+    def test_diff_against_baseline(self):
+        """Test new and fixed rows between two runs."""
+        baseline = ViolationStore.from_violations(VIOLATIONS[:2])
+        current = ViolationStore.from_violations(VIOLATIONS[1:])
+
+        new_rows, fixed_rows = current.diff(baseline)
+        assert [current.violation(row) for row in new_rows] == [VIOLATIONS[2]]
+        assert [baseline.violation(row) for row in fixed_rows] == [VIOLATIONS[0]]
+
+    def test_store_report_writer(self):
+        """Test streaming a run into a store."""
+        stream = io.BytesIO()
+        writer = StoreReportWriter(stream)
+        writer.write_violations(VIOLATIONS)
+        summary = writer.close({"files_analyzed": 2})
+
+        stream.seek(0)
+        loaded = ViolationStore.read(stream)
+        assert list(loaded) == VIOLATIONS
+        assert loaded.metadata["summary"] == summary
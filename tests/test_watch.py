@@ -0,0 +1,105 @@
+"""Test watch-mode re-analysis."""
+
+import os
+
+from static_analyzer.models import AnalysisReport, Confidence, Severity, SourceLocation, Standard, Violation
+from static_analyzer.watch import WatchSession
+
+
+class FakeParser:
+    tu_cache_size = 0
+
+
+class FakeAnalyzer:
+    """Reports one violation per "BAD" line and records quoted includes."""
+
+    def __init__(self):
+        self.ast_parser = FakeParser()
+        self.analyzed = []
+
+    def resolve_enabled_rules(self, enabled_rules=None):
+        return ["TEST"]
+
+    def iter_file_results(self, file_paths, enabled_rules):
+        for file_path in file_paths:
+            self.analyzed.append(os.path.basename(file_path))
+            with open(file_path) as f:
+                lines = f.read().splitlines()
+            includes = [os.path.join(os.path.dirname(file_path), line.split('"')[1])
+                        for line in lines if line.startswith("#include")]
+            violations = [Violation(
+                rule_id="TEST", standard=Standard.MISRA,
+                location=SourceLocation(file_path, number, 1), message="bad",
+                severity=Severity.MINOR, confidence=Confidence.HIGH
+            ) for number, line in enumerate(lines, 1) if "BAD" in line]
+            yield file_path, violations, {"includes": includes}
+
+    def build_report(self, file_results, enabled_rules, files_analyzed, total_files_provided=None):
+        violations = [v for _, file_violations, _ in file_results for v in file_violations]
+        return AnalysisReport(violations, {}, {"files_analyzed": files_analyzed})
+
+
+def write(path, text):
+    path.write_text(text)
+    stat = os.stat(path)
+    os.utime(path, ns=(stat.st_atime_ns, stat.st_mtime_ns + 1_000_000_000))
+
+
+class TestWatchSession:
+    def make_session(self, tmp_path):
+        write(tmp_path / "io.h", "int io;\n")
+        write(tmp_path / "io.c", '#include "io.h"\nBAD\n')
+        write(tmp_path / "main.c", "int main;\n")
+        analyzer = FakeAnalyzer()
+        session = WatchSession(analyzer, lambda: [str(p) for p in sorted(tmp_path.glob("*.c"))])
+        return analyzer, session
+
+    def test_only_impacted_units_rerun(self, tmp_path):
+        """Test that a header change re-analyzes its includers and nothing else."""
+        analyzer, session = self.make_session(tmp_path)
+        first = session.start()
+        assert len(first.report.violations) == 1
+        assert analyzer.ast_parser.tu_cache_size == 2
+
+        analyzer.analyzed.clear()
+        assert session.poll() is None
+
+        write(tmp_path / "io.h", "int io; /* changed */\n")
+        update = session.poll()
+        assert analyzer.analyzed == ["io.c"]
+        assert update.changed == [str(tmp_path / "io.h")]
+
+        write(tmp_path / "main.c", "BAD\nBAD\n")
+        update = session.poll()
+        assert analyzer.analyzed == ["io.c", "main.c"]
+        assert len(update.report.violations) == 3
+
+    def test_rescan_picks_up_added_and_removed_sources(self, tmp_path):
+        analyzer, session = self.make_session(tmp_path)
+        session.start()
+        analyzer.analyzed.clear()
+
+        write(tmp_path / "extra.c", "BAD\n")
+        os.remove(tmp_path / "main.c")
+        update = session.poll()
+        assert update.removed == [str(tmp_path / "main.c")]
+        assert analyzer.analyzed == []
+
+        update = session.poll(rescan=True)
+        assert analyzer.analyzed == ["extra.c"]
+        assert sorted(os.path.basename(f) for f in session.files) == ["extra.c", "io.c"]
+        assert len(update.report.violations) == 2
+
+    def test_failed_unit_retried_when_saved(self, tmp_path):
+        """Test that a unit without results is analyzed again once it changes."""
+        analyzer, session = self.make_session(tmp_path)
+        session.start()
+        main = str(tmp_path / "main.c")
+        del session.results[main]
+        session.graph.remove(main)
+        analyzer.analyzed.clear()
+
+        write(tmp_path / "main.c", "BAD\n")
+        update = session.poll()
+        assert analyzer.analyzed == ["main.c"]
+        assert update.reanalyzed == [main]
@@ -8,12 +8,11 @@ import os
 import sys
 import json
 import re
-import tempfile
-import shutil
-import subprocess
+import time
+from contextlib import closing
 from datetime import datetime
 from pathlib import Path
-from flask import Flask, render_template, request, jsonify, redirect, url_for
+from flask import Flask, render_template, request, jsonify, redirect, url_for, Response, stream_with_context
 import requests
 from urllib.parse import urlparse
 
@@ -24,8 +23,22 @@ app = Flask(__name__)
 
 # Configuration
 GITHUB_TOKEN = os.getenv('GITHUB_TOKEN', '')
-MAX_FILES_TO_ANALYZE = 20
-SUPPORTED_EXTENSIONS = ['.c', '.cpp', '.cc', '.cxx', '.h', '.hpp', '.hh', '.hxx']
+# Wall-clock seconds per request; files not finished by then are reported as skipped
+ANALYSIS_TIME_BUDGET = float(os.getenv('ANALYSIS_TIME_BUDGET', '60'))
+# Worker processes per analysis (0 = the CPUs shared among the analyses that may run at once)
+ANALYSIS_WORKERS = int(os.getenv('ANALYSIS_WORKERS', '0'))
+# Finished reports kept per (repository, commit, configuration)
+REPORT_CACHE_SIZE = int(os.getenv('REPORT_CACHE_SIZE', '64'))
+# Directory where reports are also kept on disk, shared by server processes (unset = memory only)
+REPORT_CACHE_DIR = os.getenv('REPORT_CACHE_DIR', '')
+# Seconds a report cut short by the time budget stays cached
+PARTIAL_REPORT_TTL = float(os.getenv('PARTIAL_REPORT_TTL', '300'))
+ANALYZER_VERSION = '1.0.0'
+SOURCE_EXTENSIONS = ['.c', '.cpp', '.cc', '.cxx']
+HEADER_EXTENSIONS = ['.h', '.hpp', '.hh', '.hxx']
+SUPPORTED_EXTENSIONS = SOURCE_EXTENSIONS + HEADER_EXTENSIONS
+
+_report_cache = None
 
 def is_valid_github_url(url):
     """Validate GitHub repository URL"""
@@ -47,37 +60,13 @@ def extract_repo_info(github_url):
         return path_parts[0], path_parts[1]
     return None, None
 
-def clone_repository(repo_url, temp_dir, branch='main'):
-    """Clone GitHub repository"""
-    try:
-        # Try main branch first, then master
-        for default_branch in ['main', 'master']:
-            try:
-                cmd = ['git', 'clone', '--depth', '1', '--branch', default_branch, repo_url, temp_dir]
-                result = subprocess.run(cmd, capture_output=True, text=True, timeout=60)
-                if result.returncode == 0:
-                    return True, default_branch
-            except subprocess.TimeoutExpired:
-                return False, "Timeout during clone"
-            except Exception as e:
-                continue
-        
-        # If both fail, try without specifying branch
-        try:
-            cmd = ['git', 'clone', '--depth', '1', repo_url, temp_dir]
-            result = subprocess.run(cmd, capture_output=True, text=True, timeout=60)
-            if result.returncode == 0:
-                return True, "default"
-        except Exception as e:
-            return False, f"Clone failed: {str(e)}"
-            
-        return False, "Unable to clone repository"
-        
-    except Exception as e:
-        return False, f"Clone error: {str(e)}"
-
 def find_source_files(directory):
-    """Find C/C++ source files in directory"""
+    """Find C/C++ source files in directory, in the order they should be analyzed
+    
+    Translation units come first since analyzing them also covers the headers
+    they include; standalone headers follow. Smaller files go first within each
+    group so results start arriving quickly.
+    """
     source_files = []
     
     for root, dirs, files in os.walk(directory):
@@ -92,88 +81,183 @@ def find_source_files(directory):
                 source_files.append({
                     'full_path': file_path,
                     'relative_path': rel_path,
-                    'size': os.path.getsize(file_path)
+                    'size': os.path.getsize(file_path),
+                    'header': any(file.endswith(ext) for ext in HEADER_EXTENSIONS)
                 })
     
-    # Sort by size (analyze smaller files first) and limit count
-    source_files.sort(key=lambda x: x['size'])
-    return source_files[:MAX_FILES_TO_ANALYZE]
+    source_files.sort(key=lambda x: (x['header'], x['size']))
+    return source_files
+
+def get_report_cache():
+    """Get the process-wide cache of finished reports"""
+    global _report_cache
+    if _report_cache is None:
+        from static_analyzer.reportcache import ReportCache
+        _report_cache = ReportCache(REPORT_CACHE_SIZE, REPORT_CACHE_DIR or None)
+    return _report_cache
 
-def analyze_repository_web(repo_path):
+def analysis_workers():
+    """Worker processes per analysis
+    
+    Concurrent requests don't each get a pool of one process per CPU: at
+    most DEFAULT_INSTANCES analyses of the web configuration run at once
+    (further requests wait for one, see WarmAnalyzer), and they split the
+    CPUs between them.
+    """
+    from static_analyzer.daemon import DEFAULT_INSTANCES
+    if ANALYSIS_WORKERS > 0:
+        return ANALYSIS_WORKERS
+    return max(1, (os.cpu_count() or 1) // DEFAULT_INSTANCES)
+
+def analysis_config():
+    """Configuration every web analysis runs with"""
+    from static_analyzer import AnalyzerConfig
+    return AnalyzerConfig({"analysis": {"parallelism": analysis_workers()}})
+
+def resolve_report(github_url):
+    """Resolve the default branch of a repository and the cache key of its report
+    
+    Uses git ls-remote, so nothing is cloned or fetched until the report
+    turns out not to be cached.
+    
+    Returns:
+        (key, commit_sha, branch)
+    """
+    from static_analyzer.mirrors import MirrorCache
+    from static_analyzer.reportcache import config_fingerprint, report_key
+    
+    commit_sha, branch = MirrorCache.shared().resolve_remote(github_url)
+    fingerprint = config_fingerprint(analysis_config().config, ANALYSIS_TIME_BUDGET, ANALYZER_VERSION)
+    return report_key(github_url, commit_sha, fingerprint), commit_sha, branch
+
+def report_ttl(report):
+    """Seconds to cache a report: failures not at all, partial reports briefly"""
+    if not report.get('success'):
+        return 0
+    if report.get('summary', {}).get('budget_exhausted'):
+        return PARTIAL_REPORT_TTL
+    return None
+
+def report_response(entry, status):
+    """Send a cached report, or 304 to a GET whose client already has this version"""
+    headers = {
+        'ETag': entry.etag,
+        # Clients may store the report but must revalidate it on every use
+        'Cache-Control': 'no-cache',
+        'X-Analysis-Cache': status
+    }
+    if request.method == 'GET' and entry.matches(request.headers.get('If-None-Match')):
+        return Response(status=304, headers=headers)
+    return Response(entry.body, mimetype='application/json', headers=headers)
+
+def violation_to_dict(violation, repo_path, source_buffers):
+    """Convert a violation to the JSON shape the web interface renders"""
+    severity = violation.severity.value if hasattr(violation.severity, 'value') else str(violation.severity)
+    
+    # Convert absolute path to relative path
+    abs_path = violation.location.file_path
+    rel_path = os.path.relpath(abs_path, repo_path) if abs_path.startswith(repo_path) else abs_path
+    
+    return {
+        "rule_id": violation.rule_id,
+        "severity": severity.upper(),
+        "message": violation.message,
+        "file": rel_path,
+        "line": violation.location.line,
+        "column": violation.location.column,
+        "code": (source_buffers.get_line(abs_path, violation.location.line) or "").strip(),
+        "standard": "MISRA" if "MISRA" in violation.rule_id else "CERT" if "CERT" in violation.rule_id else "OTHER"
+    }
+
+def iter_analysis_events(repo_path, time_budget=None):
+    """Analyze a repository within a time budget, yielding progress events
+    
+    Events are dictionaries with a "type" of:
+    - "start": files_found and time_budget
+    - "file": one finished file, its violations and the progress so far
+    - "done": the summary, the files analyzed and any left unanalyzed
+    
+    Files finish in parallel and in completion order. The budget is a
+    deadline: waiting for a free analyzer counts against it, and once it
+    passes, files still running are abandoned and those not started are
+    skipped, all reported in the summary.
+    """
+    from static_analyzer.ast import SourceBufferCache
+    from static_analyzer.daemon import get_analyzer
+    
+    time_budget = ANALYSIS_TIME_BUDGET if time_budget is None else time_budget
+    start = time.monotonic()
+    deadline = start + time_budget
+    repo_path = os.path.abspath(repo_path)
+    source_files = find_source_files(repo_path)
+    yield {"type": "start", "files_found": len(source_files), "time_budget": time_budget}
+    
+    source_buffers = SourceBufferCache.shared()
+    counts = {"ERROR": 0, "WARNING": 0, "INFO": 0}
+    files_analyzed = []
+    total_violations = 0
+    
+    if source_files:
+        # Run in the analysis daemon if one is running, else on a warm local analyzer
+        results = get_analyzer(analysis_config()).iter_violations(
+            [f['full_path'] for f in source_files], deadline=deadline
+        )
+        with closing(results):
+            for file_path, file_violations in results:
+                violations = [violation_to_dict(v, repo_path, source_buffers) for v in file_violations]
+                for violation in violations:
+                    severity = violation["severity"]
+                    counts[severity if severity in counts else "INFO"] += 1
+                total_violations += len(violations)
+                files_analyzed.append(os.path.relpath(file_path, repo_path))
+                
+                yield {
+                    "type": "file",
+                    "file": files_analyzed[-1],
+                    "violations": violations,
+                    "files_analyzed": len(files_analyzed),
+                    "files_found": len(source_files),
+                    "elapsed_seconds": round(time.monotonic() - start, 2)
+                }
+    
+    analyzed = set(files_analyzed)
+    files_skipped = [f['relative_path'] for f in source_files if f['relative_path'] not in analyzed]
+    yield {
+        "type": "done",
+        "summary": {
+            "total_violations": total_violations,
+            "error_count": counts["ERROR"],
+            "warning_count": counts["WARNING"],
+            "info_count": counts["INFO"],
+            "files_analyzed": len(files_analyzed),
+            "files_found": len(source_files),
+            "files_skipped": len(files_skipped),
+            "budget_exhausted": bool(files_skipped),
+            "elapsed_seconds": round(time.monotonic() - start, 2)
+        },
+        "files_analyzed": files_analyzed,
+        "files_skipped": files_skipped
+    }
+
+def analysis_result(violations, done_event):
+    """Build the report of a finished analysis from its "done" event"""
+    return {
+        "success": True,
+        "violations": violations,
+        "summary": done_event["summary"],
+        "files_analyzed": done_event["files_analyzed"],
+        "files_skipped": done_event["files_skipped"]
+    }
+
+def analyze_repository_web(repo_path, time_budget=None):
     """Run static analysis optimized for web interface"""
     try:
-        # Import static analyzer
-        from static_analyzer import StaticAnalyzer
-        
-        # Find source files
-        source_files = find_source_files(repo_path)
-        
-        if not source_files:
-            return {
-                "success": True,
-                "violations": [],
-                "summary": {
-                    "total_violations": 0,
-                    "error_count": 0,
-                    "warning_count": 0,
-                    "info_count": 0,
-                    "files_analyzed": 0,
-                    "files_found": 0
-                },
-                "files_analyzed": []
-            }
-        
-        # Get file paths for analysis
-        file_paths = [f['full_path'] for f in source_files]
-        
-        # Run static analyzer
-        analyzer = StaticAnalyzer()
-        report = analyzer.analyze_files(file_paths)
-        
-        # Process violations
         violations = []
-        error_count = warning_count = info_count = 0
-        
-        for violation in report.violations:
-            severity = violation.severity.value if hasattr(violation.severity, 'value') else str(violation.severity)
-            
-            # Convert absolute path to relative path
-            abs_path = violation.location.file_path
-            rel_path = os.path.relpath(abs_path, repo_path) if abs_path.startswith(repo_path) else abs_path
-            
-            violation_dict = {
-                "rule_id": violation.rule_id,
-                "severity": severity.upper(),
-                "message": violation.message,
-                "file": rel_path,
-                "line": violation.location.line,
-                "column": violation.location.column,
-                "standard": "MISRA" if "MISRA" in violation.rule_id else "CERT" if "CERT" in violation.rule_id else "OTHER"
-            }
-            violations.append(violation_dict)
-            
-            # Count by severity
-            if severity.upper() == "ERROR":
-                error_count += 1
-            elif severity.upper() == "WARNING":
-                warning_count += 1
-            else:
-                info_count += 1
-        
-        return {
-            "success": True,
-            "violations": violations,
-            "summary": {
-                "total_violations": len(violations),
-                "error_count": error_count,
-                "warning_count": warning_count,
-                "info_count": info_count,
-                "files_analyzed": len(file_paths),
-                "files_found": len(source_files)
-            },
-            "files_analyzed": [f['relative_path'] for f in source_files]
-        }
-        
+        for event in iter_analysis_events(repo_path, time_budget):
+            if event["type"] == "file":
+                violations.extend(event["violations"])
+            elif event["type"] == "done":
+                return analysis_result(violations, event)
     except Exception as e:
         return {
             "success": False,
@@ -189,6 +273,16 @@ def analyze_repository_web(repo_path):
             }
         }
 
+def repository_info(owner, repo, github_url, branch, commit_sha):
+    """Describe the analyzed repository and commit"""
+    return {
+        'owner': owner,
+        'name': repo,
+        'url': github_url,
+        'branch': branch,
+        'commit': commit_sha
+    }
+
 @app.route('/')
 def index():
     """Main page"""
@@ -196,7 +290,13 @@ def index():
 
 @app.route('/analyze', methods=['POST'])
 def analyze():
-    """Analyze GitHub repository"""
+    """Analyze GitHub repository
+    
+    Reports are cached per commit: a repository whose default branch has
+    not moved is answered from the cache, and identical requests arriving
+    during an analysis share it. The X-Analysis-Cache header tells which
+    ("hit", "shared" or "miss").
+    """
     data = request.get_json()
     
     if not data or 'github_url' not in data:
@@ -213,34 +313,137 @@ def analyze():
     if not owner or not repo:
         return jsonify({'error': 'Could not parse repository information from URL'}), 400
     
-    # Create temporary directory for cloning
-    with tempfile.TemporaryDirectory() as temp_dir:
-        try:
-            # Clone repository
-            clone_success, branch_or_error = clone_repository(github_url, temp_dir)
-            
-            if not clone_success:
-                return jsonify({'error': f'Failed to clone repository: {branch_or_error}'}), 400
-            
-            # Analyze repository
-            analysis_result = analyze_repository_web(temp_dir)
+    from static_analyzer.mirrors import MirrorCache, GitError
+    
+    try:
+        key, commit_sha, branch = resolve_report(github_url)
+        
+        def compute():
+            # Check out the resolved commit, not the branch, so the report matches its key
+            with MirrorCache.shared().checkout(github_url, commit_sha) as checkout:
+                # Analyze repository
+                analysis_result = analyze_repository_web(checkout.path)
+                
+                # Add metadata
+                analysis_result.update({
+                    'repository': repository_info(owner, repo, github_url, branch, checkout.commit_sha),
+                    'timestamp': datetime.now().isoformat(),
+                    'analyzer_version': ANALYZER_VERSION
+                })
+                return analysis_result
+        
+        entry, status = get_report_cache().get_or_compute(key, compute, report_ttl)
+        return report_response(entry, status)
             
-            # Add metadata
-            analysis_result.update({
-                'repository': {
-                    'owner': owner,
-                    'name': repo,
-                    'url': github_url,
-                    'branch': branch_or_error
-                },
+    except GitError as e:
+        return jsonify({'error': f'Failed to clone repository: {str(e)}'}), 400
+    except Exception as e:
+        return jsonify({'error': f'Analysis failed: {str(e)}'}), 500
+
+@app.route('/report')
+def cached_report():
+    """Cached report of a repository's current default branch
+    
+    Costs one git ls-remote. Answers 304 when If-None-Match holds the
+    report's ETag, and 404 when the current commit has not been analyzed
+    yet (analyze it with /analyze or /analyze/stream).
+    """
+    github_url = request.args.get('github_url', '').strip()
+    if not is_valid_github_url(github_url):
+        return jsonify({'error': 'Invalid GitHub URL. Please provide a valid GitHub repository URL.'}), 400
+    
+    from static_analyzer.mirrors import GitError
+    
+    try:
+        key, _, _ = resolve_report(github_url)
+    except GitError as e:
+        return jsonify({'error': f'Failed to resolve repository: {str(e)}'}), 400
+    
+    entry = get_report_cache().lookup(key)
+    if entry is None:
+        return jsonify({'error': 'This commit has not been analyzed yet'}), 404
+    return report_response(entry, 'hit')
+
+@app.route('/analyze/stream')
+def analyze_stream():
+    """Analyze GitHub repository, streaming progress as server-sent events
+    
+    Sends "repository" once the commit is resolved, then "start", one
+    "file" per finished file and "done" (see iter_analysis_events), whose
+    "etag" is the ETag /report will serve the result under. A commit that
+    is cached, or being analyzed for another request, gets a single
+    "report" event with the finished report and its "etag" instead.
+    "error" is sent if the analysis fails.
+    """
+    github_url = request.args.get('github_url', '').strip()
+    if not is_valid_github_url(github_url):
+        return jsonify({'error': 'Invalid GitHub URL. Please provide a valid GitHub repository URL.'}), 400
+    
+    owner, repo = extract_repo_info(github_url)
+    if not owner or not repo:
+        return jsonify({'error': 'Could not parse repository information from URL'}), 400
+    
+    from static_analyzer.mirrors import MirrorCache, GitError
+    
+    def sse(event):
+        return f"event: {event['type']}\ndata: {json.dumps(event)}\n\n"
+    
+    def generate():
+        flight = None
+        try:
+            key, commit_sha, branch = resolve_report(github_url)
+            repository = {
+                'type': 'repository',
+                'repository': repository_info(owner, repo, github_url, branch, commit_sha),
                 'timestamp': datetime.now().isoformat(),
-                'analyzer_version': '1.0.0'
-            })
+                'analyzer_version': ANALYZER_VERSION
+            }
+            yield sse(repository)
             
-            return jsonify(analysis_result)
+            while True:
+                flight = get_report_cache().begin(key)
+                if flight.leader:
+                    break
+                entry = flight.wait()
+                if entry is not None:
+                    yield sse({'type': 'report', 'report': entry.report, 'etag': entry.etag})
+                    return
+                # The analysis we waited on was abandoned, so run it here
             
+            with MirrorCache.shared().checkout(github_url, commit_sha) as checkout:
+                violations = []
+                for event in iter_analysis_events(checkout.path):
+                    if event['type'] == 'file':
+                        violations.extend(event['violations'])
+                    elif event['type'] == 'done':
+                        report = analysis_result(violations, event)
+                        report.update({field: repository[field]
+                                       for field in ('repository', 'timestamp', 'analyzer_version')})
+                        entry = flight.complete(report, report_ttl(report))
+                        event = dict(event, etag=entry.etag)
+                    yield sse(event)
+        except GitError as e:
+            if flight is not None and flight.leader:
+                flight.abandon(e)
+            yield sse({'type': 'error', 'error': f'Failed to clone repository: {str(e)}'})
         except Exception as e:
-            return jsonify({'error': f'Analysis failed: {str(e)}'}), 500
+            if flight is not None and flight.leader:
+                flight.abandon(e)
+            yield sse({'type': 'error', 'error': f'Analysis failed: {str(e)}'})
+        finally:
+            # A client that disconnects mid-analysis leaves waiters to take over
+            if flight is not None and flight.leader:
+                flight.abandon()
+    
+    # Disable proxy buffering so events reach the browser as they are sent
+    return Response(stream_with_context(generate()), mimetype='text/event-stream',
+                    headers={'Cache-Control': 'no-cache', 'X-Accel-Buffering': 'no'})
+
+@app.route('/metrics')
+def metrics():
+    """Prometheus metrics: analyses, phase and rule timings"""
+    from static_analyzer.profiling import get_metrics
+    return get_metrics().render(), 200, {'Content-Type': 'text/plain; version=0.0.4'}
 
 @app.route('/health')
 def health():